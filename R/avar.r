@@ -2,7 +2,8 @@
 #' 
 #' Computes the Allan Variance
 #' @param x     A \code{vec} containing the time series under observation.
-#' @param type  A \code{string} containing either \code{"mo"} for Maximal Overlap or \code{"to"} for Tau Overlap
+#' @param type  A \code{string} containing either \code{"mo"} for Maximal Overlap, \code{"to"} for Tau Overlap,
+#' \code{"mod"} for the Modified Allan Variance or \code{"tot"} for the Total Variance
 #' @return av   A \code{list} that contains:
 #' \itemize{
 #'  \item{"clusters"}{The size of the cluster}
@@ -32,6 +33,19 @@
 #' 
 #' where \eqn{ {{\bar y}_t}\left( \tau  \right) = \frac{1}{\tau }\sum\limits_{i = 0}^{\tau  - 1} {{{\bar y}_{t - i}}} }{See PDF Manual}.
 #' 
+#' @section Modified Allan Variance:
+#' The series is integrated into the phase \eqn{x_k}{x_k} and, for a cluster of size \eqn{m}, the estimator is given by:
+#' \deqn{\frac{1}{{2{m^4}\left( {N - 3m + 2} \right)}}\sum\limits_{j = 0}^{N - 3m + 1} {{{\left[ {\sum\limits_{i = j}^{j + m - 1} {\left( {{x_{i + 2m}} - 2{x_{i + m}} + {x_i}} \right)} } \right]}^2}} }{See PDF Manual}
+#' 
+#' The inner moving sum is obtained from a cumulative sum of the phase, so each cluster costs \eqn{O(N)}{O(N)}.
+#' 
+#' @section Total Variance:
+#' The phase \eqn{x_k}{x_k} is extended by reflection about both of its endpoints and the maximal overlap
+#' Allan variance is computed on the extended sequence, i.e.
+#' \deqn{\frac{1}{{2{m^2}\left( {N - 1} \right)}}\sum\limits_{k = 1}^{N - 1} {{{\left( {{x_{k - m}} - 2{x_k} + {x_{k + m}}} \right)}^2}} }{See PDF Manual}
+#' 
+#' This improves the confidence of the estimates at long cluster sizes.
+#' 
 #' @author JJB
 #' @references Long-Memory Processes, the Allan Variance and Wavelets, D. B. Percival and P. Guttorp
 #' @examples
@@ -47,11 +61,21 @@
 #' 
 #' # Tau overlap
 #' av_mat_tau = avar(ts, type = "to")
+#' 
+#' # Modified Allan Variance
+#' av_mat_mod = avar(ts, type = "mod")
+#' 
+#' # Total Variance
+#' av_mat_tot = avar(ts, type = "tot")
 avar = function(x, type = "mo") {
   x = as.vector(x)
   
   if(type == "mo"){
     av = .Call('_gmwm_avar_mo_cpp', PACKAGE = 'gmwm', x)
+  }else if(type == "mod"){
+    av = .Call('_gmwm_mavar_mo_cpp', PACKAGE = 'gmwm', x)
+  }else if(type == "tot"){
+    av = .Call('_gmwm_totvar_cpp', PACKAGE = 'gmwm', x)
   }else{
     av = .Call('_gmwm_avar_to_cpp', PACKAGE = 'gmwm', x)
   }
@@ -216,13 +240,17 @@ autoplot.avar = function(object, CI = F, transparence = 0.1, background = 'white
   if(is.null(title)){
     
     if (object$type == "mo"){
-      type = "Maximal Overlap"
+      type = "Allan Variance (Maximal Overlap)"
+    }else if(object$type == "mod"){
+      type = "Modified Allan Variance"
+    }else if(object$type == "tot"){
+      type = "Total Variance"
     }else{
-      type = "Tau Overlap"
+      type = "Allan Variance (Tau Overlap)"
     }
       
     p = p +
-      ggtitle(paste0("Allan Variance (",type, ")"))
+      ggtitle(type)
     
   }
   
@@ -0,0 +1,134 @@
+#ifndef GMWM_H
+#define GMWM_H
+
+// C++ interface to the estimation core of the gmwm package, for hosts that do not run R.
+//
+// Build and link the gmwm library with the CMakeLists.txt at the root of the package. The functions below
+// mirror the R functions of the same purpose and throw std::exception on invalid input. Random numbers,
+// messages and minimisers come from the gmwm_context of the calling thread (see gmwm_context.h), so fits
+// on different threads do not interact. Each result carries the profile of the call that made it (see
+// gmwm_profile.h), memory peaks included, and gmwm_trace.h records timelines across threads. Set a budget
+// with memory_set_budget() (see gmwm_memory.h) to have calls that would exceed it throw
+// memory_budget_error before allocating.
+
+#include <armadillo>
+#include <string>
+#include <vector>
+
+#include "gmwm_context.h"
+#include "gmwm_memory.h"
+#include "gmwm_profile.h"
+#include "gmwm_trace.h"
+
+namespace gmwm{
+
+/* ------------------------- Wavelet Variance ------------------------- */
+
+// Settings of the wavelet variance, as in wvar()
+struct wv_options{
+  wv_options() : nlevels(0), robust(false), eff(0.6), alpha(0.05) {}
+
+  unsigned int nlevels;   // Levels of the decomposition, 0 for floor(log2(n))
+  bool robust;            // Robust (bisquare) instead of classical estimator
+  double eff;             // Efficiency of the robust estimator
+  double alpha;           // Level of the confidence intervals
+};
+
+struct wv_result{
+  arma::vec scales;
+  arma::vec variance;
+  arma::vec ci_low;
+  arma::vec ci_high;
+  gmwm_profile profile;
+};
+
+// Haar MODWT wavelet variance of a series
+wv_result wvar(const arma::vec& x, const wv_options& opt = wv_options());
+
+/* ------------------------- Allan and Hadamard Variances ------------------------- */
+
+// Cluster variance of a series, one row per dyadic cluster size
+struct cluster_variance{
+  arma::vec tau;
+  arma::vec variance;
+  arma::vec error;
+};
+
+// Allan variance, maximal overlap (default) or tau overlap as in avar()
+cluster_variance avar(const arma::vec& x, bool overlap = true);
+
+// Hadamard variance, maximal overlap (default) or tau overlap as in hadam()
+cluster_variance hadamard(const arma::vec& x, bool overlap = true);
+
+/* ------------------------- GMWM ------------------------- */
+
+// Settings of a GMWM fit, as the arguments of gmwm()
+struct fit_options{
+  fit_options() : model_type("imu"), compute_v("fast"), robust(false), eff(0.6), alpha(0.05),
+                  G(0), K(1), H(100), seed(1337) {}
+
+  std::string model_type; // "imu" or "ssm"
+  std::string compute_v;  // "fast", "diag", "full" or "bootstrap"
+  bool robust;
+  double eff;
+  double alpha;
+  unsigned int G;         // Guesses of the starting values, 0 for the default of gmwm()
+  unsigned int K;
+  unsigned int H;
+  unsigned int seed;      // Seeds the RNG of the context before the fit
+};
+
+struct fit_result{
+  std::vector<std::string> model;
+  arma::vec theta;        // Estimates, in the order of the processes of the model
+  arma::vec starting;     // Starting values of the optimisation
+  arma::vec ci_low;       // Confidence intervals of the WV
+  arma::vec ci_high;
+  arma::vec wv_empir;     // Empirical WV
+  arma::vec wv_theo;      // WV implied by theta
+  arma::mat decomp_theo;  // WV implied by each process, one column per process
+  arma::mat omega;        // Weighting matrix
+  arma::mat V;            // Covariance of the WV
+  double objective;
+  gmwm_profile profile;
+};
+
+// GMWM estimates of a model given as process names (e.g. {"AR1", "WN", "RW"}) on a series
+fit_result fit(const arma::vec& x, const std::vector<std::string>& model, const fit_options& opt = fit_options());
+
+/* ------------------------- Model Selection ------------------------- */
+
+struct selection_result{
+  std::vector< std::vector<std::string> > models;   // Candidates fitted, best first
+  arma::mat scores;                                 // Objective, optimism, criterion and GoF p-value of each
+  fit_result best;         // Its profile is left empty
+  gmwm_profile profile;     // The whole selection
+};
+
+// Ranks candidate models by the criterion of rank.models(). Without candidates, every non empty
+// combination of the processes of the full model is a candidate, as in auto.imu().
+selection_result select_model(const arma::vec& x, const std::vector<std::string>& full_model,
+                              std::vector< std::vector<std::string> > candidates = std::vector< std::vector<std::string> >(),
+                              const fit_options& opt = fit_options(),
+                              const std::string& search = "exhaustive", bool warm_start = true,
+                              bool bootstrap = false);
+
+/* ------------------------- Data ------------------------- */
+
+struct imu_data{
+  arma::mat data;         // Time, then the gyroscope and accelerometer axes
+  double freq;
+  double scale_gyro;
+  double scale_acc;
+  gmwm_profile profile;   // Only the memory of the decoded records
+};
+
+// Binary file of a supported IMU type (see read.imu())
+imu_data read_imu(const std::string& path, const std::string& imu_type, unsigned int decimate = 1);
+
+// Simulates n observations of a model at the parameters theta
+arma::vec simulate(unsigned int n, const arma::vec& theta, const std::vector<std::string>& model);
+
+}
+
+#endif
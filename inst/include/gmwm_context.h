@@ -0,0 +1,140 @@
+#ifndef GMWM_CONTEXT
+#define GMWM_CONTEXT
+
+#include <sstream>
+#include <string>
+
+#include "optimizers.h"
+
+// Random numbers drawn by the estimation core
+class gmwm_rng{
+public:
+  virtual ~gmwm_rng() {}
+  virtual void seed(unsigned int s) = 0;
+  virtual double unif(double a, double b) = 0;
+  virtual double norm(double mu, double sd) = 0;
+};
+
+// Progress and warning messages of the estimation core, one line per call
+class gmwm_logger{
+public:
+  virtual ~gmwm_logger() {}
+  virtual void message(const std::string& line) = 0;
+};
+
+// Minimisers used by the estimation core
+class gmwm_solver{
+public:
+  virtual ~gmwm_solver() {}
+
+  // Unconstrained minimum, with the semantics of optim(method = "CG")
+  virtual arma::vec minimize(objective_function& f, const arma::vec& start) = 0;
+
+  // Minimum on [lower, upper], with the semantics of optimize
+  virtual double minimize_1d(scalar_function& f, double lower, double upper) = 0;
+};
+
+// Timings and counters of the stages of the core, see gmwm_profile.h
+struct gmwm_profile;
+
+// Everything the estimation core takes from its host. None of it is shared between contexts, so fits
+// under different contexts can run at the same time.
+struct gmwm_context{
+  gmwm_rng* rng;
+  gmwm_logger* logger;
+  gmwm_solver* solver;
+  gmwm_profile* profile;  // Where to record the profile, NULL to record nothing
+};
+
+// Context of the calling thread. On R's thread it defaults to R's RNG and console; on any other thread it
+// defaults to a thread local generator and no messages.
+gmwm_context& current_context();
+
+// Installs a context on the calling thread for the lifetime of the scope
+class gmwm_context_scope{
+public:
+  explicit gmwm_context_scope(gmwm_context& ctx);
+  ~gmwm_context_scope();
+
+private:
+  gmwm_context* previous;
+
+  gmwm_context_scope(const gmwm_context_scope&);
+  gmwm_context_scope& operator=(const gmwm_context_scope&);
+};
+
+/* ------------------------- Native Implementations ------------------------- */
+
+// Mersenne twister generator, independent of R's RNG state
+class native_rng : public gmwm_rng{
+public:
+  explicit native_rng(unsigned int s = 5489u);
+  ~native_rng();
+  void seed(unsigned int s);
+  double unif(double a, double b);
+  double norm(double mu, double sd);
+
+private:
+  struct state;
+  state* st;
+
+  native_rng(const native_rng&);
+  native_rng& operator=(const native_rng&);
+};
+
+// Writes each message as a line of a stream
+class ostream_logger : public gmwm_logger{
+public:
+  explicit ostream_logger(std::ostream& out) : out(out) {}
+  void message(const std::string& line);
+
+private:
+  std::ostream& out;
+};
+
+// Drops every message
+class null_logger : public gmwm_logger{
+public:
+  void message(const std::string&) {}
+};
+
+// Native ports of optim's CG and of optimize
+class native_solver : public gmwm_solver{
+public:
+  arma::vec minimize(objective_function& f, const arma::vec& start);
+  double minimize_1d(scalar_function& f, double lower, double upper);
+};
+
+/* ------------------------- Helpers ------------------------- */
+
+inline double rng_unif(double a, double b){
+  return current_context().rng->unif(a, b);
+}
+
+inline double rng_norm(double mu, double sd){
+  return current_context().rng->norm(mu, sd);
+}
+
+// Collects a message with operator<< and hands it to the logger of the context when destroyed, e.g.
+// log_line() << "Fitted " << n << " models.";
+class log_line{
+public:
+  log_line() {}
+  ~log_line(){
+    current_context().logger->message(buf.str());
+  }
+
+  template <typename T>
+  log_line& operator<<(const T& v){
+    buf << v;
+    return *this;
+  }
+
+private:
+  std::ostringstream buf;
+
+  log_line(const log_line&);
+  log_line& operator=(const log_line&);
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef GMWM_MEMORY
+#define GMWM_MEMORY
+
+// Memory held by the large structures of the estimation core: the MODWT coefficients, the bootstrap
+// workspaces, the decoded IMU records and the simulated processes. Each structure is charged by a
+// memory_charge from the point it is sized to the end of the function that holds it, so what is handed
+// back to R or to the caller of the C++ interface stops being counted once returned.
+//
+// The ledger covers the whole process. With a budget set, a charge that would take the memory held
+// beyond it fails up front, before anything is allocated, with a memory_budget_error that names the
+// operation and the alternative that streams its input. The peaks seen during a call are also recorded
+// into the profile of the calling thread's context, per structure and per stage (see gmwm_profile.h).
+
+#include <stdexcept>
+#include <string>
+
+enum memory_structure{
+  MEMORY_MODWT,         // Wavelet coefficients of each level
+  MEMORY_BOOTSTRAP,     // Replicate series and the statistics kept over the replicates
+  MEMORY_IMU,           // Records decoded from an IMU file
+  MEMORY_SIMULATION,    // Processes simulated by gen_lts_cpp
+  MEMORY_STRUCTURES
+};
+
+const char* memory_structure_name(memory_structure structure);
+
+// Bytes held by the structures, now and at their highest since the last memory_reset_peaks()
+struct memory_usage{
+  double current[MEMORY_STRUCTURES];
+  double peak[MEMORY_STRUCTURES];
+  double total;
+  double peak_total;
+  double budget;        // 0 when there is none
+};
+
+memory_usage memory_snapshot();
+
+void memory_reset_peaks();
+
+// Sets the most bytes the structures may hold at once, 0 for no limit, and returns the previous budget
+double memory_set_budget(double bytes);
+
+// Bytes of n doubles
+inline double memory_doubles(double n){
+  return n*sizeof(double);
+}
+
+// "1.5 GB"
+std::string memory_format(double bytes);
+
+class memory_budget_error : public std::runtime_error{
+public:
+  explicit memory_budget_error(const std::string& what) : std::runtime_error(what) {}
+};
+
+// Charges bytes to a structure from construction to destruction. When operation is given, the budget is
+// checked first and memory_budget_error thrown if the charge does not fit; otherwise the bytes, already
+// allocated, are only recorded.
+class memory_charge{
+public:
+  memory_charge(memory_structure structure, double bytes, const char* operation = NULL);
+  ~memory_charge();
+
+private:
+  memory_structure structure;
+  long long bytes;
+
+  memory_charge(const memory_charge&);
+  memory_charge& operator=(const memory_charge&);
+};
+
+#endif
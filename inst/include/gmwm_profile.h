@@ -0,0 +1,133 @@
+#ifndef GMWM_PROFILE
+#define GMWM_PROFILE
+
+// Where the estimation core spends its time. The stages and counters below are recorded into the profile
+// of the calling thread's context, if it has one. Without one they cost a thread local read. Stages nest
+// (a bootstrap replicate runs a MODWT, a model selection runs fits), so the time of a stage includes the
+// time of the stages it runs.
+//
+// The profile also keeps the peaks of the memory ledger of gmwm_memory.h seen during the call: the bytes
+// held by each structure and, for each stage, by all of them while the stage ran. Like the ledger, the
+// peaks count the structures of every thread of the process.
+//
+// Building with GMWM_NO_PROFILE compiles the instrumentation out. The profiles are then all zero.
+
+#include <chrono>
+
+#include "gmwm_context.h"
+#include "gmwm_memory.h"
+
+enum profile_stage{
+  STAGE_MODWT,          // modwt_cpp
+  STAGE_WV,             // Wavelet variance and its confidence intervals
+  STAGE_V,              // Covariance matrix of the WV
+  STAGE_GUESS,          // Random search for starting values
+  STAGE_OPTIM,          // Minimisation of the objective
+  STAGE_BOOTSTRAP,      // Parametric bootstraps
+  STAGE_SELECT,         // Model selection
+  PROFILE_STAGES
+};
+
+enum profile_counter{
+  COUNT_GUESS_DRAWS,          // Candidate starting values drawn
+  COUNT_OBJECTIVE,            // Objective evaluations of the minimiser
+  COUNT_OPTIM_RUNS,           // Minimisations
+  COUNT_OPTIM_ITERATIONS,     // Gradient evaluations over all minimisations
+  COUNT_OPTIM_NOT_CONVERGED,  // Minimisations stopped by the iteration limit
+  COUNT_BOOTSTRAP_REPLICATES,
+  COUNT_CANDIDATES,           // Candidate models fitted by the selection
+  COUNT_WARM_STARTS,          // Candidates fitted from the estimates of a nested model
+  COUNT_WV_CACHE_LOOKUPS,     // Look ups of the theoretical WV of a process in the cache of wv_cache.h
+  COUNT_WV_CACHE_HITS,
+  COUNT_DERIV_CACHE_LOOKUPS,  // Same for its first derivatives
+  COUNT_DERIV_CACHE_HITS,
+  COUNT_DERIV2_CACHE_LOOKUPS, // Same for its second derivatives
+  COUNT_DERIV2_CACHE_HITS,
+  PROFILE_COUNTERS
+};
+
+struct gmwm_profile{
+  gmwm_profile() { reset(); }
+
+  void reset();
+  gmwm_profile& operator+=(const gmwm_profile& other);
+
+  double seconds[PROFILE_STAGES];         // Wall clock time in each stage
+  unsigned long calls[PROFILE_STAGES];    // Times each stage was entered
+  unsigned long counts[PROFILE_COUNTERS];
+  int convergence;                        // Code of the last minimisation, as optim's: 0 or 1 (iteration limit)
+
+  double stage_peak_bytes[PROFILE_STAGES];  // Most bytes held by the structures while in each stage
+  double peak_bytes[MEMORY_STRUCTURES];     // Most bytes held by each structure
+  double peak_total_bytes;                  // Most bytes held by the structures together
+
+  unsigned int depth[PROFILE_STAGES];       // Stages entered and not yet left, which the peaks are recorded into
+};
+
+const char* profile_stage_name(profile_stage stage);
+
+const char* profile_counter_name(profile_counter counter);
+
+#ifndef GMWM_NO_PROFILE
+
+// Adds the time from construction to destruction to a stage
+class profile_timer{
+public:
+  explicit profile_timer(profile_stage stage) : profile(current_context().profile), stage(stage) {
+    if(profile){
+      profile->depth[stage]++;
+      start = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~profile_timer(){
+    if(profile){
+      profile->depth[stage]--;
+      profile->seconds[stage] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      profile->calls[stage]++;
+    }
+  }
+
+private:
+  gmwm_profile* profile;
+  profile_stage stage;
+  std::chrono::steady_clock::time_point start;
+
+  profile_timer(const profile_timer&);
+  profile_timer& operator=(const profile_timer&);
+};
+
+inline void profile_count(profile_counter counter, unsigned long n = 1){
+  gmwm_profile* profile = current_context().profile;
+  if(profile){
+    profile->counts[counter] += n;
+  }
+}
+
+// Records the outcome of a minimisation
+inline void profile_optimizer(unsigned int iterations, int convergence){
+  gmwm_profile* profile = current_context().profile;
+  if(profile){
+    profile->counts[COUNT_OPTIM_RUNS]++;
+    profile->counts[COUNT_OPTIM_ITERATIONS] += iterations;
+    if(convergence != 0){
+      profile->counts[COUNT_OPTIM_NOT_CONVERGED]++;
+    }
+    profile->convergence = convergence;
+  }
+}
+
+#else
+
+class profile_timer{
+public:
+  explicit profile_timer(profile_stage) {}
+};
+
+inline void profile_count(profile_counter, unsigned long = 1) {}
+
+inline void profile_optimizer(unsigned int, int) {}
+
+#endif
+
+#endif
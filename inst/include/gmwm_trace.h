@@ -0,0 +1,69 @@
+#ifndef GMWM_TRACE
+#define GMWM_TRACE
+
+// Timeline of the hot functions of the estimation core, for threads and runs that the totals of
+// gmwm_profile.h do not explain. Between trace_start() and trace_stop(), each trace_scope records an event
+// with its thread into a ring buffer owned by that thread, so tracing takes no lock; when a buffer is full
+// the oldest events are overwritten. trace_write() saves the events in the Chrome Trace Event format,
+// which Perfetto (ui.perfetto.dev) and chrome://tracing open.
+//
+// Unlike the profile, tracing covers the whole process. Start, stop and write it while no traced work is
+// running. Building with GMWM_NO_TRACE compiles the scopes out.
+
+#include <atomic>
+#include <string>
+
+// Starts a new trace, dropping the events of any earlier one. Each thread keeps its last
+// events_per_thread events.
+void trace_start(unsigned int events_per_thread = 65536);
+
+// Stops recording. The events are kept until the next trace_start().
+void trace_stop();
+
+// Writes the events of the trace to a JSON file and returns how many it wrote
+unsigned long trace_write(const std::string& path);
+
+// Whether a trace is being recorded
+extern std::atomic<bool> trace_on;
+
+// Records one event
+void trace_record(const char* name, const char* category, long long id, long long start_ns, long long end_ns);
+
+// Nanoseconds on the clock of the trace
+long long trace_now();
+
+#ifndef GMWM_NO_TRACE
+
+// Event from construction to destruction. name and category must be string literals. id tells apart the
+// events of a loop (a replicate, a candidate); it is left out when negative.
+class trace_scope{
+public:
+  explicit trace_scope(const char* name, const char* category, long long id = -1)
+    : name(name), category(category), id(id), start(trace_on.load(std::memory_order_relaxed) ? trace_now() : -1) {}
+
+  ~trace_scope(){
+    if(start >= 0){
+      trace_record(name, category, id, start, trace_now());
+    }
+  }
+
+private:
+  const char* name;
+  const char* category;
+  long long id;
+  long long start;   // -1 when the trace was off at construction
+
+  trace_scope(const trace_scope&);
+  trace_scope& operator=(const trace_scope&);
+};
+
+#else
+
+class trace_scope{
+public:
+  explicit trace_scope(const char*, const char*, long long = -1) {}
+};
+
+#endif
+
+#endif
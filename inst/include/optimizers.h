@@ -0,0 +1,23 @@
+#ifndef OPTIMIZERS_H
+#define OPTIMIZERS_H
+
+// Function minimised by cg_min
+class objective_function{
+public:
+  virtual ~objective_function() {}
+  virtual double value(const arma::vec& x) = 0;
+};
+
+// Function minimised by brent_min
+class scalar_function{
+public:
+  virtual ~scalar_function() {}
+  virtual double value(double x) = 0;
+};
+
+arma::vec cg_min(objective_function& f, const arma::vec& start,
+                 unsigned int maxit = 100, double reltol = 1.490116119384765625e-8, double ndeps = 1e-3);
+
+double brent_min(scalar_function& f, double lower, double upper, double tol = 1.220703125e-4);
+
+#endif
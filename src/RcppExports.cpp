@@ -43,27 +43,49 @@ BEGIN_RCPP
 END_RCPP
 }
 // avar_to_cpp
-arma::mat avar_to_cpp(arma::vec x);
+arma::mat avar_to_cpp(const arma::vec& x);
 RcppExport SEXP _gmwm_avar_to_cpp(SEXP xSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::vec >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type x(xSEXP);
     rcpp_result_gen = Rcpp::wrap(avar_to_cpp(x));
     return rcpp_result_gen;
 END_RCPP
 }
 // avar_mo_cpp
-arma::mat avar_mo_cpp(arma::vec x);
+arma::mat avar_mo_cpp(const arma::vec& x);
 RcppExport SEXP _gmwm_avar_mo_cpp(SEXP xSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::vec >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type x(xSEXP);
     rcpp_result_gen = Rcpp::wrap(avar_mo_cpp(x));
     return rcpp_result_gen;
 END_RCPP
 }
+// mavar_mo_cpp
+arma::mat mavar_mo_cpp(arma::vec x);
+RcppExport SEXP _gmwm_mavar_mo_cpp(SEXP xSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< arma::vec >::type x(xSEXP);
+    rcpp_result_gen = Rcpp::wrap(mavar_mo_cpp(x));
+    return rcpp_result_gen;
+END_RCPP
+}
+// totvar_cpp
+arma::mat totvar_cpp(const arma::vec& x);
+RcppExport SEXP _gmwm_totvar_cpp(SEXP xSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const arma::vec& >::type x(xSEXP);
+    rcpp_result_gen = Rcpp::wrap(totvar_cpp(x));
+    return rcpp_result_gen;
+END_RCPP
+}
 // arma_adapter
 arma::vec arma_adapter(const arma::vec& theta, unsigned int p, unsigned int q, const arma::vec& tau);
 RcppExport SEXP _gmwm_arma_adapter(SEXP thetaSEXP, SEXP pSEXP, SEXP qSEXP, SEXP tauSEXP) {
@@ -269,6 +291,18 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// arima_css
+arma::vec arima_css(const arma::vec& data, const arma::vec& params);
+RcppExport SEXP _gmwm_arima_css(SEXP dataSEXP, SEXP paramsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const arma::vec& >::type data(dataSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type params(paramsSEXP);
+    rcpp_result_gen = Rcpp::wrap(arima_css(data, params));
+    return rcpp_result_gen;
+END_RCPP
+}
 // sort_mat
 arma::mat sort_mat(arma::mat x, unsigned int col);
 RcppExport SEXP _gmwm_sort_mat(SEXP xSEXP, SEXP colSEXP) {
@@ -308,12 +342,12 @@ BEGIN_RCPP
 END_RCPP
 }
 // reverse_vec
-arma::vec reverse_vec(arma::vec x);
+arma::vec reverse_vec(const arma::vec& x);
 RcppExport SEXP _gmwm_reverse_vec(SEXP xSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::vec >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type x(xSEXP);
     rcpp_result_gen = Rcpp::wrap(reverse_vec(x));
     return rcpp_result_gen;
 END_RCPP
@@ -385,12 +419,12 @@ BEGIN_RCPP
 END_RCPP
 }
 // rank_models_cpp
-arma::field< arma::field<arma::field<arma::mat> > > rank_models_cpp(arma::vec& data, const std::vector<std::vector < std::string > >& model_str, const std::vector< std::string >& full_model, double alpha, std::string compute_v, std::string model_type, unsigned int K, unsigned int H, unsigned int G, bool robust, double eff, bool bs_optimism, unsigned int seed);
-RcppExport SEXP _gmwm_rank_models_cpp(SEXP dataSEXP, SEXP model_strSEXP, SEXP full_modelSEXP, SEXP alphaSEXP, SEXP compute_vSEXP, SEXP model_typeSEXP, SEXP KSEXP, SEXP HSEXP, SEXP GSEXP, SEXP robustSEXP, SEXP effSEXP, SEXP bs_optimismSEXP, SEXP seedSEXP) {
+arma::field< arma::field<arma::field<arma::mat> > > rank_models_cpp(const arma::vec& data, const std::vector<std::vector < std::string > >& model_str, const std::vector< std::string >& full_model, double alpha, std::string compute_v, std::string model_type, unsigned int K, unsigned int H, unsigned int G, bool robust, double eff, bool bs_optimism, unsigned int seed, std::string search, bool warm_start);
+RcppExport SEXP _gmwm_rank_models_cpp(SEXP dataSEXP, SEXP model_strSEXP, SEXP full_modelSEXP, SEXP alphaSEXP, SEXP compute_vSEXP, SEXP model_typeSEXP, SEXP KSEXP, SEXP HSEXP, SEXP GSEXP, SEXP robustSEXP, SEXP effSEXP, SEXP bs_optimismSEXP, SEXP seedSEXP, SEXP searchSEXP, SEXP warm_startSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::vec& >::type data(dataSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type data(dataSEXP);
     Rcpp::traits::input_parameter< const std::vector<std::vector < std::string > >& >::type model_str(model_strSEXP);
     Rcpp::traits::input_parameter< const std::vector< std::string >& >::type full_model(full_modelSEXP);
     Rcpp::traits::input_parameter< double >::type alpha(alphaSEXP);
@@ -403,17 +437,19 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< double >::type eff(effSEXP);
     Rcpp::traits::input_parameter< bool >::type bs_optimism(bs_optimismSEXP);
     Rcpp::traits::input_parameter< unsigned int >::type seed(seedSEXP);
-    rcpp_result_gen = Rcpp::wrap(rank_models_cpp(data, model_str, full_model, alpha, compute_v, model_type, K, H, G, robust, eff, bs_optimism, seed));
+    Rcpp::traits::input_parameter< std::string >::type search(searchSEXP);
+    Rcpp::traits::input_parameter< bool >::type warm_start(warm_startSEXP);
+    rcpp_result_gen = Rcpp::wrap(rank_models_cpp(data, model_str, full_model, alpha, compute_v, model_type, K, H, G, robust, eff, bs_optimism, seed, search, warm_start));
     return rcpp_result_gen;
 END_RCPP
 }
 // auto_imu_cpp
-arma::field< arma::field<arma::field<arma::mat> > > auto_imu_cpp(arma::mat& data, const arma::mat& combs, const std::vector< std::string >& full_model, double alpha, std::string compute_v, std::string model_type, unsigned int K, unsigned int H, unsigned int G, bool robust, double eff, bool bs_optimism, unsigned int seed);
-RcppExport SEXP _gmwm_auto_imu_cpp(SEXP dataSEXP, SEXP combsSEXP, SEXP full_modelSEXP, SEXP alphaSEXP, SEXP compute_vSEXP, SEXP model_typeSEXP, SEXP KSEXP, SEXP HSEXP, SEXP GSEXP, SEXP robustSEXP, SEXP effSEXP, SEXP bs_optimismSEXP, SEXP seedSEXP) {
+arma::field< arma::field<arma::field<arma::mat> > > auto_imu_cpp(const arma::mat& data, const arma::mat& combs, const std::vector< std::string >& full_model, double alpha, std::string compute_v, std::string model_type, unsigned int K, unsigned int H, unsigned int G, bool robust, double eff, bool bs_optimism, unsigned int seed, std::string search, bool warm_start);
+RcppExport SEXP _gmwm_auto_imu_cpp(SEXP dataSEXP, SEXP combsSEXP, SEXP full_modelSEXP, SEXP alphaSEXP, SEXP compute_vSEXP, SEXP model_typeSEXP, SEXP KSEXP, SEXP HSEXP, SEXP GSEXP, SEXP robustSEXP, SEXP effSEXP, SEXP bs_optimismSEXP, SEXP seedSEXP, SEXP searchSEXP, SEXP warm_startSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::mat& >::type data(dataSEXP);
+    Rcpp::traits::input_parameter< const arma::mat& >::type data(dataSEXP);
     Rcpp::traits::input_parameter< const arma::mat& >::type combs(combsSEXP);
     Rcpp::traits::input_parameter< const std::vector< std::string >& >::type full_model(full_modelSEXP);
     Rcpp::traits::input_parameter< double >::type alpha(alphaSEXP);
@@ -426,7 +462,37 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< double >::type eff(effSEXP);
     Rcpp::traits::input_parameter< bool >::type bs_optimism(bs_optimismSEXP);
     Rcpp::traits::input_parameter< unsigned int >::type seed(seedSEXP);
-    rcpp_result_gen = Rcpp::wrap(auto_imu_cpp(data, combs, full_model, alpha, compute_v, model_type, K, H, G, robust, eff, bs_optimism, seed));
+    Rcpp::traits::input_parameter< std::string >::type search(searchSEXP);
+    Rcpp::traits::input_parameter< bool >::type warm_start(warm_startSEXP);
+    rcpp_result_gen = Rcpp::wrap(auto_imu_cpp(data, combs, full_model, alpha, compute_v, model_type, K, H, G, robust, eff, bs_optimism, seed, search, warm_start));
+    return rcpp_result_gen;
+END_RCPP
+}
+// batch_imu_cpp
+Rcpp::List batch_imu_cpp(std::vector<std::string> file_paths, Rcpp::List imu_types, unsigned int nlevels, arma::vec theta, const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, std::string model_type, bool starting, double alpha, std::string compute_v, unsigned int K, unsigned int H, unsigned int G, bool robust, double eff, unsigned int decode_threads, unsigned int wvar_threads, unsigned int queue_size);
+RcppExport SEXP _gmwm_batch_imu_cpp(SEXP file_pathsSEXP, SEXP imu_typesSEXP, SEXP nlevelsSEXP, SEXP thetaSEXP, SEXP descSEXP, SEXP objdescSEXP, SEXP model_typeSEXP, SEXP startingSEXP, SEXP alphaSEXP, SEXP compute_vSEXP, SEXP KSEXP, SEXP HSEXP, SEXP GSEXP, SEXP robustSEXP, SEXP effSEXP, SEXP decode_threadsSEXP, SEXP wvar_threadsSEXP, SEXP queue_sizeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type file_paths(file_pathsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type imu_types(imu_typesSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type nlevels(nlevelsSEXP);
+    Rcpp::traits::input_parameter< arma::vec >::type theta(thetaSEXP);
+    Rcpp::traits::input_parameter< const std::vector<std::string>& >::type desc(descSEXP);
+    Rcpp::traits::input_parameter< const arma::field<arma::vec>& >::type objdesc(objdescSEXP);
+    Rcpp::traits::input_parameter< std::string >::type model_type(model_typeSEXP);
+    Rcpp::traits::input_parameter< bool >::type starting(startingSEXP);
+    Rcpp::traits::input_parameter< double >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< std::string >::type compute_v(compute_vSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type K(KSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type H(HSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type G(GSEXP);
+    Rcpp::traits::input_parameter< bool >::type robust(robustSEXP);
+    Rcpp::traits::input_parameter< double >::type eff(effSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type decode_threads(decode_threadsSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type wvar_threads(wvar_threadsSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type queue_size(queue_sizeSEXP);
+    rcpp_result_gen = Rcpp::wrap(batch_imu_cpp(file_paths, imu_types, nlevels, theta, desc, objdesc, model_type, starting, alpha, compute_v, K, H, G, robust, eff, decode_threads, wvar_threads, queue_size));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -585,12 +651,12 @@ BEGIN_RCPP
 END_RCPP
 }
 // compute_cov_cpp
-arma::field<arma::mat> compute_cov_cpp(arma::field<arma::vec> signal_modwt, unsigned int nb_level, std::string compute_v, bool robust, double eff);
+arma::field<arma::mat> compute_cov_cpp(const arma::field<arma::vec>& signal_modwt, unsigned int nb_level, std::string compute_v, bool robust, double eff);
 RcppExport SEXP _gmwm_compute_cov_cpp(SEXP signal_modwtSEXP, SEXP nb_levelSEXP, SEXP compute_vSEXP, SEXP robustSEXP, SEXP effSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::field<arma::vec> >::type signal_modwt(signal_modwtSEXP);
+    Rcpp::traits::input_parameter< const arma::field<arma::vec>& >::type signal_modwt(signal_modwtSEXP);
     Rcpp::traits::input_parameter< unsigned int >::type nb_level(nb_levelSEXP);
     Rcpp::traits::input_parameter< std::string >::type compute_v(compute_vSEXP);
     Rcpp::traits::input_parameter< bool >::type robust(robustSEXP);
@@ -612,12 +678,12 @@ BEGIN_RCPP
 END_RCPP
 }
 // dwt_cpp
-arma::field<arma::vec> dwt_cpp(arma::vec x, std::string filter_name, unsigned int nlevels, std::string boundary, bool brickwall);
+arma::field<arma::vec> dwt_cpp(const arma::vec& x, std::string filter_name, unsigned int nlevels, std::string boundary, bool brickwall);
 RcppExport SEXP _gmwm_dwt_cpp(SEXP xSEXP, SEXP filter_nameSEXP, SEXP nlevelsSEXP, SEXP boundarySEXP, SEXP brickwallSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::vec >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type x(xSEXP);
     Rcpp::traits::input_parameter< std::string >::type filter_name(filter_nameSEXP);
     Rcpp::traits::input_parameter< unsigned int >::type nlevels(nlevelsSEXP);
     Rcpp::traits::input_parameter< std::string >::type boundary(boundarySEXP);
@@ -627,12 +693,12 @@ BEGIN_RCPP
 END_RCPP
 }
 // modwt_cpp
-arma::field<arma::vec> modwt_cpp(arma::vec x, std::string filter_name, unsigned int nlevels, std::string boundary, bool brickwall);
+arma::field<arma::vec> modwt_cpp(const arma::vec& x, std::string filter_name, unsigned int nlevels, std::string boundary, bool brickwall);
 RcppExport SEXP _gmwm_modwt_cpp(SEXP xSEXP, SEXP filter_nameSEXP, SEXP nlevelsSEXP, SEXP boundarySEXP, SEXP brickwallSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::vec >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type x(xSEXP);
     Rcpp::traits::input_parameter< std::string >::type filter_name(filter_nameSEXP);
     Rcpp::traits::input_parameter< unsigned int >::type nlevels(nlevelsSEXP);
     Rcpp::traits::input_parameter< std::string >::type boundary(boundarySEXP);
@@ -642,13 +708,13 @@ BEGIN_RCPP
 END_RCPP
 }
 // brick_wall
-arma::field<arma::vec> brick_wall(arma::field<arma::vec> x, arma::field<arma::vec> wave_filter, std::string method);
+arma::field<arma::vec> brick_wall(const arma::field<arma::vec>& x, const arma::field<arma::vec>& wave_filter, std::string method);
 RcppExport SEXP _gmwm_brick_wall(SEXP xSEXP, SEXP wave_filterSEXP, SEXP methodSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::field<arma::vec> >::type x(xSEXP);
-    Rcpp::traits::input_parameter< arma::field<arma::vec> >::type wave_filter(wave_filterSEXP);
+    Rcpp::traits::input_parameter< const arma::field<arma::vec>& >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const arma::field<arma::vec>& >::type wave_filter(wave_filterSEXP);
     Rcpp::traits::input_parameter< std::string >::type method(methodSEXP);
     rcpp_result_gen = Rcpp::wrap(brick_wall(x, wave_filter, method));
     return rcpp_result_gen;
@@ -911,12 +977,12 @@ BEGIN_RCPP
 END_RCPP
 }
 // gmwm_master_cpp
-arma::field<arma::mat> gmwm_master_cpp(arma::vec& data, arma::vec theta, const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, std::string model_type, bool starting, double alpha, std::string compute_v, unsigned int K, unsigned int H, unsigned int G, bool robust, double eff);
+arma::field<arma::mat> gmwm_master_cpp(const arma::vec& data, arma::vec theta, const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, std::string model_type, bool starting, double alpha, std::string compute_v, unsigned int K, unsigned int H, unsigned int G, bool robust, double eff);
 RcppExport SEXP _gmwm_gmwm_master_cpp(SEXP dataSEXP, SEXP thetaSEXP, SEXP descSEXP, SEXP objdescSEXP, SEXP model_typeSEXP, SEXP startingSEXP, SEXP alphaSEXP, SEXP compute_vSEXP, SEXP KSEXP, SEXP HSEXP, SEXP GSEXP, SEXP robustSEXP, SEXP effSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::vec& >::type data(dataSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type data(dataSEXP);
     Rcpp::traits::input_parameter< arma::vec >::type theta(thetaSEXP);
     Rcpp::traits::input_parameter< const std::vector<std::string>& >::type desc(descSEXP);
     Rcpp::traits::input_parameter< const arma::field<arma::vec>& >::type objdesc(objdescSEXP);
@@ -960,6 +1026,156 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// memory_budget_cpp
+double memory_budget_cpp(double bytes);
+RcppExport SEXP _gmwm_memory_budget_cpp(SEXP bytesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type bytes(bytesSEXP);
+    rcpp_result_gen = Rcpp::wrap(memory_budget_cpp(bytes));
+    return rcpp_result_gen;
+END_RCPP
+}
+// memory_usage_cpp
+Rcpp::NumericMatrix memory_usage_cpp(bool reset);
+RcppExport SEXP _gmwm_memory_usage_cpp(SEXP resetSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< bool >::type reset(resetSEXP);
+    rcpp_result_gen = Rcpp::wrap(memory_usage_cpp(reset));
+    return rcpp_result_gen;
+END_RCPP
+}
+// profile_start_cpp
+void profile_start_cpp();
+RcppExport SEXP _gmwm_profile_start_cpp() {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    profile_start_cpp();
+    return R_NilValue;
+END_RCPP
+}
+// profile_stop_cpp
+Rcpp::List profile_stop_cpp();
+RcppExport SEXP _gmwm_profile_stop_cpp() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(profile_stop_cpp());
+    return rcpp_result_gen;
+END_RCPP
+}
+// gmwm_session_cpp
+SEXP gmwm_session_cpp(const arma::vec& data, bool robust, double eff, double alpha);
+RcppExport SEXP _gmwm_gmwm_session_cpp(SEXP dataSEXP, SEXP robustSEXP, SEXP effSEXP, SEXP alphaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const arma::vec& >::type data(dataSEXP);
+    Rcpp::traits::input_parameter< bool >::type robust(robustSEXP);
+    Rcpp::traits::input_parameter< double >::type eff(effSEXP);
+    Rcpp::traits::input_parameter< double >::type alpha(alphaSEXP);
+    rcpp_result_gen = Rcpp::wrap(gmwm_session_cpp(data, robust, eff, alpha));
+    return rcpp_result_gen;
+END_RCPP
+}
+// gmwm_session_fit_cpp
+arma::field<arma::mat> gmwm_session_fit_cpp(SEXP session, const arma::vec& theta, const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, std::string model_type, bool starting, std::string compute_v, unsigned int K, unsigned int H, unsigned int G, unsigned int seed);
+RcppExport SEXP _gmwm_gmwm_session_fit_cpp(SEXP sessionSEXP, SEXP thetaSEXP, SEXP descSEXP, SEXP objdescSEXP, SEXP model_typeSEXP, SEXP startingSEXP, SEXP compute_vSEXP, SEXP KSEXP, SEXP HSEXP, SEXP GSEXP, SEXP seedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type session(sessionSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type theta(thetaSEXP);
+    Rcpp::traits::input_parameter< const std::vector<std::string>& >::type desc(descSEXP);
+    Rcpp::traits::input_parameter< const arma::field<arma::vec>& >::type objdesc(objdescSEXP);
+    Rcpp::traits::input_parameter< std::string >::type model_type(model_typeSEXP);
+    Rcpp::traits::input_parameter< bool >::type starting(startingSEXP);
+    Rcpp::traits::input_parameter< std::string >::type compute_v(compute_vSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type K(KSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type H(HSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type G(GSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type seed(seedSEXP);
+    rcpp_result_gen = Rcpp::wrap(gmwm_session_fit_cpp(session, theta, desc, objdesc, model_type, starting, compute_v, K, H, G, seed));
+    return rcpp_result_gen;
+END_RCPP
+}
+// gmwm_session_summary_cpp
+arma::field<arma::mat> gmwm_session_summary_cpp(SEXP session, const arma::vec& theta, const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, std::string model_type, bool inference, bool bs_gof, bool bs_gof_p_ci, bool bs_theta_est, bool bs_ci, unsigned int B);
+RcppExport SEXP _gmwm_gmwm_session_summary_cpp(SEXP sessionSEXP, SEXP thetaSEXP, SEXP descSEXP, SEXP objdescSEXP, SEXP model_typeSEXP, SEXP inferenceSEXP, SEXP bs_gofSEXP, SEXP bs_gof_p_ciSEXP, SEXP bs_theta_estSEXP, SEXP bs_ciSEXP, SEXP BSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type session(sessionSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type theta(thetaSEXP);
+    Rcpp::traits::input_parameter< const std::vector<std::string>& >::type desc(descSEXP);
+    Rcpp::traits::input_parameter< const arma::field<arma::vec>& >::type objdesc(objdescSEXP);
+    Rcpp::traits::input_parameter< std::string >::type model_type(model_typeSEXP);
+    Rcpp::traits::input_parameter< bool >::type inference(inferenceSEXP);
+    Rcpp::traits::input_parameter< bool >::type bs_gof(bs_gofSEXP);
+    Rcpp::traits::input_parameter< bool >::type bs_gof_p_ci(bs_gof_p_ciSEXP);
+    Rcpp::traits::input_parameter< bool >::type bs_theta_est(bs_theta_estSEXP);
+    Rcpp::traits::input_parameter< bool >::type bs_ci(bs_ciSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type B(BSEXP);
+    rcpp_result_gen = Rcpp::wrap(gmwm_session_summary_cpp(session, theta, desc, objdesc, model_type, inference, bs_gof, bs_gof_p_ci, bs_theta_est, bs_ci, B));
+    return rcpp_result_gen;
+END_RCPP
+}
+// gmwm_session_append_cpp
+void gmwm_session_append_cpp(SEXP session, const arma::vec& samples);
+RcppExport SEXP _gmwm_gmwm_session_append_cpp(SEXP sessionSEXP, SEXP samplesSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type session(sessionSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type samples(samplesSEXP);
+    gmwm_session_append_cpp(session, samples);
+    return R_NilValue;
+END_RCPP
+}
+// gmwm_session_info_cpp
+Rcpp::List gmwm_session_info_cpp(SEXP session);
+RcppExport SEXP _gmwm_gmwm_session_info_cpp(SEXP sessionSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type session(sessionSEXP);
+    rcpp_result_gen = Rcpp::wrap(gmwm_session_info_cpp(session));
+    return rcpp_result_gen;
+END_RCPP
+}
+// gmwm_session_release_cpp
+void gmwm_session_release_cpp(SEXP session);
+RcppExport SEXP _gmwm_gmwm_session_release_cpp(SEXP sessionSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type session(sessionSEXP);
+    gmwm_session_release_cpp(session);
+    return R_NilValue;
+END_RCPP
+}
+// trace_start_cpp
+void trace_start_cpp(unsigned int events);
+RcppExport SEXP _gmwm_trace_start_cpp(SEXP eventsSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< unsigned int >::type events(eventsSEXP);
+    trace_start_cpp(events);
+    return R_NilValue;
+END_RCPP
+}
+// trace_stop_cpp
+double trace_stop_cpp(std::string file);
+RcppExport SEXP _gmwm_trace_stop_cpp(SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(trace_stop_cpp(file));
+    return rcpp_result_gen;
+END_RCPP
+}
 // guess_initial
 arma::vec guess_initial(const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, std::string model_type, unsigned int num_param, double expect_diff, unsigned int N, const arma::mat& wv, const arma::vec& tau, double ranged, unsigned int G);
 RcppExport SEXP _gmwm_guess_initial(SEXP descSEXP, SEXP objdescSEXP, SEXP model_typeSEXP, SEXP num_paramSEXP, SEXP expect_diffSEXP, SEXP NSEXP, SEXP wvSEXP, SEXP tauSEXP, SEXP rangedSEXP, SEXP GSEXP) {
@@ -1027,23 +1243,23 @@ BEGIN_RCPP
 END_RCPP
 }
 // hadam_to_cpp
-arma::mat hadam_to_cpp(arma::vec x);
+arma::mat hadam_to_cpp(const arma::vec& x);
 RcppExport SEXP _gmwm_hadam_to_cpp(SEXP xSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::vec >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type x(xSEXP);
     rcpp_result_gen = Rcpp::wrap(hadam_to_cpp(x));
     return rcpp_result_gen;
 END_RCPP
 }
 // hadam_mo_cpp
-arma::mat hadam_mo_cpp(arma::vec x);
+arma::mat hadam_mo_cpp(const arma::vec& x);
 RcppExport SEXP _gmwm_hadam_mo_cpp(SEXP xSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::vec >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type x(xSEXP);
     rcpp_result_gen = Rcpp::wrap(hadam_mo_cpp(x));
     return rcpp_result_gen;
 END_RCPP
@@ -1082,6 +1298,84 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// write_imu_cache_cpp
+void write_imu_cache_cpp(std::string file_path, const arma::mat& data, const arma::vec& stats, std::vector<unsigned int> num_sensor, std::vector<std::string> axis, std::string stype, std::string unit, std::string encoding);
+RcppExport SEXP _gmwm_write_imu_cache_cpp(SEXP file_pathSEXP, SEXP dataSEXP, SEXP statsSEXP, SEXP num_sensorSEXP, SEXP axisSEXP, SEXP stypeSEXP, SEXP unitSEXP, SEXP encodingSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file_path(file_pathSEXP);
+    Rcpp::traits::input_parameter< const arma::mat& >::type data(dataSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type stats(statsSEXP);
+    Rcpp::traits::input_parameter< std::vector<unsigned int> >::type num_sensor(num_sensorSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type axis(axisSEXP);
+    Rcpp::traits::input_parameter< std::string >::type stype(stypeSEXP);
+    Rcpp::traits::input_parameter< std::string >::type unit(unitSEXP);
+    Rcpp::traits::input_parameter< std::string >::type encoding(encodingSEXP);
+    write_imu_cache_cpp(file_path, data, stats, num_sensor, axis, stype, unit, encoding);
+    return R_NilValue;
+END_RCPP
+}
+// read_imu_cache_cpp
+Rcpp::List read_imu_cache_cpp(std::string file_path, bool data);
+RcppExport SEXP _gmwm_read_imu_cache_cpp(SEXP file_pathSEXP, SEXP dataSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file_path(file_pathSEXP);
+    Rcpp::traits::input_parameter< bool >::type data(dataSEXP);
+    rcpp_result_gen = Rcpp::wrap(read_imu_cache_cpp(file_path, data));
+    return rcpp_result_gen;
+END_RCPP
+}
+// write_wvar_cache_cpp
+void write_wvar_cache_cpp(std::string file_path, const arma::field<arma::mat>& wv, std::string filter, std::string decomp, bool robust, double eff, double alpha);
+RcppExport SEXP _gmwm_write_wvar_cache_cpp(SEXP file_pathSEXP, SEXP wvSEXP, SEXP filterSEXP, SEXP decompSEXP, SEXP robustSEXP, SEXP effSEXP, SEXP alphaSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file_path(file_pathSEXP);
+    Rcpp::traits::input_parameter< const arma::field<arma::mat>& >::type wv(wvSEXP);
+    Rcpp::traits::input_parameter< std::string >::type filter(filterSEXP);
+    Rcpp::traits::input_parameter< std::string >::type decomp(decompSEXP);
+    Rcpp::traits::input_parameter< bool >::type robust(robustSEXP);
+    Rcpp::traits::input_parameter< double >::type eff(effSEXP);
+    Rcpp::traits::input_parameter< double >::type alpha(alphaSEXP);
+    write_wvar_cache_cpp(file_path, wv, filter, decomp, robust, eff, alpha);
+    return R_NilValue;
+END_RCPP
+}
+// read_wvar_cache_cpp
+arma::field<arma::mat> read_wvar_cache_cpp(std::string file_path, std::string filter, std::string decomp, unsigned int nlevels, bool robust, double eff, double alpha);
+RcppExport SEXP _gmwm_read_wvar_cache_cpp(SEXP file_pathSEXP, SEXP filterSEXP, SEXP decompSEXP, SEXP nlevelsSEXP, SEXP robustSEXP, SEXP effSEXP, SEXP alphaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file_path(file_pathSEXP);
+    Rcpp::traits::input_parameter< std::string >::type filter(filterSEXP);
+    Rcpp::traits::input_parameter< std::string >::type decomp(decompSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type nlevels(nlevelsSEXP);
+    Rcpp::traits::input_parameter< bool >::type robust(robustSEXP);
+    Rcpp::traits::input_parameter< double >::type eff(effSEXP);
+    Rcpp::traits::input_parameter< double >::type alpha(alphaSEXP);
+    rcpp_result_gen = Rcpp::wrap(read_wvar_cache_cpp(file_path, filter, decomp, nlevels, robust, eff, alpha));
+    return rcpp_result_gen;
+END_RCPP
+}
+// stream_imu_wvar_cpp
+arma::field<arma::mat> stream_imu_wvar_cpp(std::string file_path, SEXP imu_type, unsigned int nlevels, double alpha, unsigned int block_size, unsigned int history);
+RcppExport SEXP _gmwm_stream_imu_wvar_cpp(SEXP file_pathSEXP, SEXP imu_typeSEXP, SEXP nlevelsSEXP, SEXP alphaSEXP, SEXP block_sizeSEXP, SEXP historySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file_path(file_pathSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type imu_type(imu_typeSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type nlevels(nlevelsSEXP);
+    Rcpp::traits::input_parameter< double >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type block_size(block_sizeSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type history(historySEXP);
+    rcpp_result_gen = Rcpp::wrap(stream_imu_wvar_cpp(file_path, imu_type, nlevels, alpha, block_size, history));
+    return rcpp_result_gen;
+END_RCPP
+}
 // calculate_psi_matrix
 arma::mat calculate_psi_matrix(const arma::mat& A, const arma::mat& v_hat, const arma::mat& omega);
 RcppExport SEXP _gmwm_calculate_psi_matrix(SEXP ASEXP, SEXP v_hatSEXP, SEXP omegaSEXP) {
@@ -1154,6 +1448,29 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// read_imu_lazy
+Rcpp::List read_imu_lazy(std::string file_path, SEXP imu_type);
+RcppExport SEXP _gmwm_read_imu_lazy(SEXP file_pathSEXP, SEXP imu_typeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file_path(file_pathSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type imu_type(imu_typeSEXP);
+    rcpp_result_gen = Rcpp::wrap(read_imu_lazy(file_path, imu_type));
+    return rcpp_result_gen;
+END_RCPP
+}
+// read_imu_cache_lazy
+Rcpp::List read_imu_cache_lazy(std::string file_path);
+RcppExport SEXP _gmwm_read_imu_cache_lazy(SEXP file_pathSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file_path(file_pathSEXP);
+    rcpp_result_gen = Rcpp::wrap(read_imu_cache_lazy(file_path));
+    return rcpp_result_gen;
+END_RCPP
+}
 // lm_arma
 arma::field<arma::vec> lm_arma(const arma::vec& y, const arma::mat& X);
 RcppExport SEXP _gmwm_lm_arma(SEXP ySEXP, SEXP XSEXP) {
@@ -1443,14 +1760,28 @@ BEGIN_RCPP
 END_RCPP
 }
 // read_imu
-arma::field<arma::mat> read_imu(std::string file_path, std::string imu_type);
-RcppExport SEXP _gmwm_read_imu(SEXP file_pathSEXP, SEXP imu_typeSEXP) {
+arma::field<arma::mat> read_imu(std::string file_path, std::string imu_type, unsigned int decimate);
+RcppExport SEXP _gmwm_read_imu(SEXP file_pathSEXP, SEXP imu_typeSEXP, SEXP decimateSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< std::string >::type file_path(file_pathSEXP);
     Rcpp::traits::input_parameter< std::string >::type imu_type(imu_typeSEXP);
-    rcpp_result_gen = Rcpp::wrap(read_imu(file_path, imu_type));
+    Rcpp::traits::input_parameter< unsigned int >::type decimate(decimateSEXP);
+    rcpp_result_gen = Rcpp::wrap(read_imu(file_path, imu_type, decimate));
+    return rcpp_result_gen;
+END_RCPP
+}
+// read_imu_layout
+arma::field<arma::mat> read_imu_layout(std::string file_path, Rcpp::List layout, unsigned int decimate);
+RcppExport SEXP _gmwm_read_imu_layout(SEXP file_pathSEXP, SEXP layoutSEXP, SEXP decimateSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file_path(file_pathSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type layout(layoutSEXP);
+    Rcpp::traits::input_parameter< unsigned int >::type decimate(decimateSEXP);
+    rcpp_result_gen = Rcpp::wrap(read_imu_layout(file_path, layout, decimate));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -1478,24 +1809,24 @@ BEGIN_RCPP
 END_RCPP
 }
 // quantile_cpp
-arma::vec quantile_cpp(arma::vec x, const arma::vec& probs);
+arma::vec quantile_cpp(const arma::vec& x, const arma::vec& probs);
 RcppExport SEXP _gmwm_quantile_cpp(SEXP xSEXP, SEXP probsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::vec >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type x(xSEXP);
     Rcpp::traits::input_parameter< const arma::vec& >::type probs(probsSEXP);
     rcpp_result_gen = Rcpp::wrap(quantile_cpp(x, probs));
     return rcpp_result_gen;
 END_RCPP
 }
 // diff_cpp
-arma::vec diff_cpp(arma::vec x, unsigned int lag, unsigned int differences);
+arma::vec diff_cpp(const arma::vec& x, unsigned int lag, unsigned int differences);
 RcppExport SEXP _gmwm_diff_cpp(SEXP xSEXP, SEXP lagSEXP, SEXP differencesSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::vec >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type x(xSEXP);
     Rcpp::traits::input_parameter< unsigned int >::type lag(lagSEXP);
     Rcpp::traits::input_parameter< unsigned int >::type differences(differencesSEXP);
     rcpp_result_gen = Rcpp::wrap(diff_cpp(x, lag, differences));
@@ -1516,13 +1847,13 @@ BEGIN_RCPP
 END_RCPP
 }
 // cfilter
-arma::vec cfilter(arma::vec x, arma::vec filter, int sides, bool circular);
+arma::vec cfilter(const arma::vec& x, const arma::vec& filter, int sides, bool circular);
 RcppExport SEXP _gmwm_cfilter(SEXP xSEXP, SEXP filterSEXP, SEXP sidesSEXP, SEXP circularSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::vec >::type x(xSEXP);
-    Rcpp::traits::input_parameter< arma::vec >::type filter(filterSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type filter(filterSEXP);
     Rcpp::traits::input_parameter< int >::type sides(sidesSEXP);
     Rcpp::traits::input_parameter< bool >::type circular(circularSEXP);
     rcpp_result_gen = Rcpp::wrap(cfilter(x, filter, sides, circular));
@@ -1530,14 +1861,14 @@ BEGIN_RCPP
 END_RCPP
 }
 // rfilter
-arma::vec rfilter(arma::vec x, arma::vec filter, arma::vec init);
+arma::vec rfilter(const arma::vec& x, const arma::vec& filter, const arma::vec& init);
 RcppExport SEXP _gmwm_rfilter(SEXP xSEXP, SEXP filterSEXP, SEXP initSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::vec >::type x(xSEXP);
-    Rcpp::traits::input_parameter< arma::vec >::type filter(filterSEXP);
-    Rcpp::traits::input_parameter< arma::vec >::type init(initSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type filter(filterSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type init(initSEXP);
     rcpp_result_gen = Rcpp::wrap(rfilter(x, filter, init));
     return rcpp_result_gen;
 END_RCPP
@@ -1630,12 +1961,12 @@ BEGIN_RCPP
 END_RCPP
 }
 // acf
-arma::cube acf(arma::mat& x, int lagmax, bool cor, bool demean);
+arma::cube acf(const arma::mat& x, int lagmax, bool cor, bool demean);
 RcppExport SEXP _gmwm_acf(SEXP xSEXP, SEXP lagmaxSEXP, SEXP corSEXP, SEXP demeanSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::mat& >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const arma::mat& >::type x(xSEXP);
     Rcpp::traits::input_parameter< int >::type lagmax(lagmaxSEXP);
     Rcpp::traits::input_parameter< bool >::type cor(corSEXP);
     Rcpp::traits::input_parameter< bool >::type demean(demeanSEXP);
@@ -1745,6 +2076,40 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// avar_stream_init
+arma::vec avar_stream_init();
+RcppExport SEXP _gmwm_avar_stream_init() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(avar_stream_init());
+    return rcpp_result_gen;
+END_RCPP
+}
+// avar_stream_update
+arma::vec avar_stream_update(const arma::vec& state, const arma::vec& x);
+RcppExport SEXP _gmwm_avar_stream_update(SEXP stateSEXP, SEXP xSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const arma::vec& >::type state(stateSEXP);
+    Rcpp::traits::input_parameter< const arma::vec& >::type x(xSEXP);
+    rcpp_result_gen = Rcpp::wrap(avar_stream_update(state, x));
+    return rcpp_result_gen;
+END_RCPP
+}
+// avar_stream_query
+arma::mat avar_stream_query(const arma::vec& state, std::string type);
+RcppExport SEXP _gmwm_avar_stream_query(SEXP stateSEXP, SEXP typeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const arma::vec& >::type state(stateSEXP);
+    Rcpp::traits::input_parameter< std::string >::type type(typeSEXP);
+    rcpp_result_gen = Rcpp::wrap(avar_stream_query(state, type));
+    return rcpp_result_gen;
+END_RCPP
+}
 // get_summary
 arma::field<arma::mat> get_summary(arma::vec theta, const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, std::string model_type, const arma::vec& wv_empir, const arma::vec& theo, const arma::vec& scales, arma::mat V, const arma::mat& omega, double obj_value, unsigned int N, double alpha, bool robust, double eff, bool inference, bool fullV, bool bs_gof, bool bs_gof_p_ci, bool bs_theta_est, bool bs_ci, unsigned int B);
 RcppExport SEXP _gmwm_get_summary(SEXP thetaSEXP, SEXP descSEXP, SEXP objdescSEXP, SEXP model_typeSEXP, SEXP wv_empirSEXP, SEXP theoSEXP, SEXP scalesSEXP, SEXP VSEXP, SEXP omegaSEXP, SEXP obj_valueSEXP, SEXP NSEXP, SEXP alphaSEXP, SEXP robustSEXP, SEXP effSEXP, SEXP inferenceSEXP, SEXP fullVSEXP, SEXP bs_gofSEXP, SEXP bs_gof_p_ciSEXP, SEXP bs_theta_estSEXP, SEXP bs_ciSEXP, SEXP BSEXP) {
@@ -2321,6 +2686,8 @@ static const R_CallMethodDef CallEntries[] = {
     {"_gmwm_var_drift", (DL_FUNC) &_gmwm_var_drift, 2},
     {"_gmwm_avar_to_cpp", (DL_FUNC) &_gmwm_avar_to_cpp, 1},
     {"_gmwm_avar_mo_cpp", (DL_FUNC) &_gmwm_avar_mo_cpp, 1},
+    {"_gmwm_mavar_mo_cpp", (DL_FUNC) &_gmwm_mavar_mo_cpp, 1},
+    {"_gmwm_totvar_cpp", (DL_FUNC) &_gmwm_totvar_cpp, 1},
     {"_gmwm_arma_adapter", (DL_FUNC) &_gmwm_arma_adapter, 4},
     {"_gmwm_jacobian_arma", (DL_FUNC) &_gmwm_jacobian_arma, 4},
     {"_gmwm_deriv_arma11", (DL_FUNC) &_gmwm_deriv_arma11, 4},
@@ -2337,6 +2704,7 @@ static const R_CallMethodDef CallEntries[] = {
     {"_gmwm_derivative_first_matrix", (DL_FUNC) &_gmwm_derivative_first_matrix, 4},
     {"_gmwm_D_matrix", (DL_FUNC) &_gmwm_D_matrix, 5},
     {"_gmwm_Rcpp_ARIMA", (DL_FUNC) &_gmwm_Rcpp_ARIMA, 2},
+    {"_gmwm_arima_css", (DL_FUNC) &_gmwm_arima_css, 2},
     {"_gmwm_sort_mat", (DL_FUNC) &_gmwm_sort_mat, 2},
     {"_gmwm_rev_col_subset", (DL_FUNC) &_gmwm_rev_col_subset, 3},
     {"_gmwm_rev_row_subset", (DL_FUNC) &_gmwm_rev_row_subset, 3},
@@ -2347,8 +2715,9 @@ static const R_CallMethodDef CallEntries[] = {
     {"_gmwm_set_seed", (DL_FUNC) &_gmwm_set_seed, 1},
     {"_gmwm_vector_to_set", (DL_FUNC) &_gmwm_vector_to_set, 1},
     {"_gmwm_find_full_model", (DL_FUNC) &_gmwm_find_full_model, 1},
-    {"_gmwm_rank_models_cpp", (DL_FUNC) &_gmwm_rank_models_cpp, 13},
-    {"_gmwm_auto_imu_cpp", (DL_FUNC) &_gmwm_auto_imu_cpp, 13},
+    {"_gmwm_rank_models_cpp", (DL_FUNC) &_gmwm_rank_models_cpp, 15},
+    {"_gmwm_auto_imu_cpp", (DL_FUNC) &_gmwm_auto_imu_cpp, 15},
+    {"_gmwm_batch_imu_cpp", (DL_FUNC) &_gmwm_batch_imu_cpp, 18},
     {"_gmwm_cov_bootstrapper", (DL_FUNC) &_gmwm_cov_bootstrapper, 8},
     {"_gmwm_optimism_bootstrapper", (DL_FUNC) &_gmwm_optimism_bootstrapper, 10},
     {"_gmwm_opt_n_gof_bootstrapper", (DL_FUNC) &_gmwm_opt_n_gof_bootstrapper, 10},
@@ -2382,6 +2751,18 @@ static const R_CallMethodDef CallEntries[] = {
     {"_gmwm_gmwm_update_cpp", (DL_FUNC) &_gmwm_gmwm_update_cpp, 17},
     {"_gmwm_gmwm_master_cpp", (DL_FUNC) &_gmwm_gmwm_master_cpp, 13},
     {"_gmwm_gmwm_master_wv_cpp", (DL_FUNC) &_gmwm_gmwm_master_wv_cpp, 17},
+    {"_gmwm_memory_budget_cpp", (DL_FUNC) &_gmwm_memory_budget_cpp, 1},
+    {"_gmwm_memory_usage_cpp", (DL_FUNC) &_gmwm_memory_usage_cpp, 1},
+    {"_gmwm_profile_start_cpp", (DL_FUNC) &_gmwm_profile_start_cpp, 0},
+    {"_gmwm_profile_stop_cpp", (DL_FUNC) &_gmwm_profile_stop_cpp, 0},
+    {"_gmwm_gmwm_session_cpp", (DL_FUNC) &_gmwm_gmwm_session_cpp, 4},
+    {"_gmwm_gmwm_session_fit_cpp", (DL_FUNC) &_gmwm_gmwm_session_fit_cpp, 11},
+    {"_gmwm_gmwm_session_summary_cpp", (DL_FUNC) &_gmwm_gmwm_session_summary_cpp, 11},
+    {"_gmwm_gmwm_session_append_cpp", (DL_FUNC) &_gmwm_gmwm_session_append_cpp, 2},
+    {"_gmwm_gmwm_session_info_cpp", (DL_FUNC) &_gmwm_gmwm_session_info_cpp, 1},
+    {"_gmwm_gmwm_session_release_cpp", (DL_FUNC) &_gmwm_gmwm_session_release_cpp, 1},
+    {"_gmwm_trace_start_cpp", (DL_FUNC) &_gmwm_trace_start_cpp, 1},
+    {"_gmwm_trace_stop_cpp", (DL_FUNC) &_gmwm_trace_stop_cpp, 1},
     {"_gmwm_guess_initial", (DL_FUNC) &_gmwm_guess_initial, 10},
     {"_gmwm_ar1_draw", (DL_FUNC) &_gmwm_ar1_draw, 4},
     {"_gmwm_arma_draws", (DL_FUNC) &_gmwm_arma_draws, 3},
@@ -2390,11 +2771,18 @@ static const R_CallMethodDef CallEntries[] = {
     {"_gmwm_hadam_mo_cpp", (DL_FUNC) &_gmwm_hadam_mo_cpp, 1},
     {"_gmwm_idf_arma", (DL_FUNC) &_gmwm_idf_arma, 7},
     {"_gmwm_idf_arma_total", (DL_FUNC) &_gmwm_idf_arma_total, 7},
+    {"_gmwm_write_imu_cache_cpp", (DL_FUNC) &_gmwm_write_imu_cache_cpp, 8},
+    {"_gmwm_read_imu_cache_cpp", (DL_FUNC) &_gmwm_read_imu_cache_cpp, 2},
+    {"_gmwm_write_wvar_cache_cpp", (DL_FUNC) &_gmwm_write_wvar_cache_cpp, 7},
+    {"_gmwm_read_wvar_cache_cpp", (DL_FUNC) &_gmwm_read_wvar_cache_cpp, 7},
+    {"_gmwm_stream_imu_wvar_cpp", (DL_FUNC) &_gmwm_stream_imu_wvar_cpp, 6},
     {"_gmwm_calculate_psi_matrix", (DL_FUNC) &_gmwm_calculate_psi_matrix, 3},
     {"_gmwm_format_ci", (DL_FUNC) &_gmwm_format_ci, 3},
     {"_gmwm_theta_ci", (DL_FUNC) &_gmwm_theta_ci, 5},
     {"_gmwm_gof_test", (DL_FUNC) &_gmwm_gof_test, 7},
     {"_gmwm_bootstrap_gof_test", (DL_FUNC) &_gmwm_bootstrap_gof_test, 4},
+    {"_gmwm_read_imu_lazy", (DL_FUNC) &_gmwm_read_imu_lazy, 2},
+    {"_gmwm_read_imu_cache_lazy", (DL_FUNC) &_gmwm_read_imu_cache_lazy, 1},
     {"_gmwm_lm_arma", (DL_FUNC) &_gmwm_lm_arma, 2},
     {"_gmwm_lm_dr", (DL_FUNC) &_gmwm_lm_dr, 1},
     {"_gmwm_B_matrix", (DL_FUNC) &_gmwm_B_matrix, 2},
@@ -2417,7 +2805,8 @@ static const R_CallMethodDef CallEntries[] = {
     {"_gmwm_theoretical_wv", (DL_FUNC) &_gmwm_theoretical_wv, 4},
     {"_gmwm_decomp_theoretical_wv", (DL_FUNC) &_gmwm_decomp_theoretical_wv, 4},
     {"_gmwm_decomp_to_theo_wv", (DL_FUNC) &_gmwm_decomp_to_theo_wv, 1},
-    {"_gmwm_read_imu", (DL_FUNC) &_gmwm_read_imu, 2},
+    {"_gmwm_read_imu", (DL_FUNC) &_gmwm_read_imu, 3},
+    {"_gmwm_read_imu_layout", (DL_FUNC) &_gmwm_read_imu_layout, 3},
     {"_gmwm_seq_cpp", (DL_FUNC) &_gmwm_seq_cpp, 2},
     {"_gmwm_seq_len_cpp", (DL_FUNC) &_gmwm_seq_len_cpp, 1},
     {"_gmwm_quantile_cpp", (DL_FUNC) &_gmwm_quantile_cpp, 2},
@@ -2440,6 +2829,9 @@ static const R_CallMethodDef CallEntries[] = {
     {"_gmwm_sarma_params_construct", (DL_FUNC) &_gmwm_sarma_params_construct, 4},
     {"_gmwm_sarma_expand_unguided", (DL_FUNC) &_gmwm_sarma_expand_unguided, 8},
     {"_gmwm_sarma_expand", (DL_FUNC) &_gmwm_sarma_expand, 2},
+    {"_gmwm_avar_stream_init", (DL_FUNC) &_gmwm_avar_stream_init, 0},
+    {"_gmwm_avar_stream_update", (DL_FUNC) &_gmwm_avar_stream_update, 2},
+    {"_gmwm_avar_stream_query", (DL_FUNC) &_gmwm_avar_stream_query, 2},
     {"_gmwm_get_summary", (DL_FUNC) &_gmwm_get_summary, 21},
     {"_gmwm_pseudo_logit_inv", (DL_FUNC) &_gmwm_pseudo_logit_inv, 1},
     {"_gmwm_logit_inv", (DL_FUNC) &_gmwm_logit_inv, 1},
@@ -2491,7 +2883,9 @@ static const R_CallMethodDef CallEntries[] = {
     {NULL, NULL, 0}
 };
 
+void init_lazy_imu(DllInfo* dll);
 RcppExport void R_init_gmwm(DllInfo *dll) {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
+    init_lazy_imu(dll);
 }
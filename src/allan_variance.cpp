@@ -37,7 +37,7 @@
 //' av_mat = avar_to_cpp(combined.ts)
 //' @keywords internal
 // [[Rcpp::export]]
-arma::mat avar_to_cpp(arma::vec x) {
+arma::mat avar_to_cpp(const arma::vec& x) {
   
    // Length of vector
    unsigned int T = x.n_elem;
@@ -110,7 +110,7 @@ arma::mat avar_to_cpp(arma::vec x) {
 //' av_mat = avar_mo_cpp(combined.ts)
 //' @keywords internal
 // [[Rcpp::export]]
-arma::mat avar_mo_cpp(arma::vec x) {
+arma::mat avar_mo_cpp(const arma::vec& x) {
   
    // Length of vector
    unsigned int T = x.n_elem;
@@ -149,4 +149,164 @@ arma::mat avar_mo_cpp(arma::vec x) {
   return av;
 }
 
+//' @title Compute the Modified Allan Variance
+//' @description Computation of the Modified Allan Variance using a linear-time algorithm per cluster size.
+//' @usage mavar_mo_cpp(x)
+//' @param x A \code{vector} with dimensions N x 1. 
+//' @return av A \code{matrix} that contains:
+//' \itemize{
+//'  \item{Col 1}{The size of the cluster}
+//'  \item{Col 2}{The modified Allan variance}
+//'  \item{Col 3}{The error associated with the variance estimation.}
+//' }
+//' @details
+//' The series is treated as frequency data \eqn{y_t} and is first integrated into the phase
+//' \eqn{x_k = \sum_{t < k} y_t}{x_k = sum_{t < k} y_t} with \eqn{k = 0, \ldots, N}{k = 0, ..., N}.
+//' For a cluster of size \eqn{m}, the modified Allan variance is given by:
+//' \eqn{\frac{1}{{2{m^4}\left( {N - 3m + 2} \right)}}\sum\limits_{j = 0}^{N - 3m + 1} {{{\left[ {\sum\limits_{i = j}^{j + m - 1} {\left( {{x_{i + 2m}} - 2{x_{i + m}} + {x_i}} \right)} } \right]}^2}} }
+//' 
+//' The inner moving sum is obtained from differences of the cumulative sum of the phase
+//' (i.e. a cumulative sum of a cumulative sum), so each cluster size costs \eqn{O(N)}{O(N)} rather
+//' than \eqn{O(Nm)}{O(N*m)}. The series is centered beforehand to limit the growth of the double
+//' cumulative sum, which leaves the estimator unchanged.
+//' Cluster sizes are \eqn{m = 2^j}{m = 2^j} with \eqn{3m \le N + 1}{3m <= N + 1}.
+//' @author JJB
+//' @references Handbook of Frequency Stability Analysis, W. J. Riley, NIST Special Publication 1065
+//' @examples
+//' set.seed(999)
+//' N = 100000
+//' white.noise = rnorm(N, 0, 2)
+//' random.walk = cumsum(0.1*rnorm(N, 0, 2))
+//' combined.ts = white.noise+random.walk
+//' mav_mat = mavar_mo_cpp(combined.ts)
+//' @keywords internal
+// [[Rcpp::export]]
+arma::mat mavar_mo_cpp(arma::vec x) {
+  
+  // Length of vector
+  unsigned int T = x.n_elem;
+  
+  // Largest cluster satisfies 3*tau <= T + 1
+  unsigned int J = (T < 5) ? 0 : floor(log10((T + 1)/3.0)/log10(2));
+  
+  // Modified Allan Variance Matrix
+  arma::mat av = arma::zeros<arma::mat>(J,3);
+  
+  if(J == 0){
+    return av;
+  }
+  
+  // Phase (x_0 = 0) and its cumulative sum (S_0 = 0)
+  x -= arma::mean(x);
+  arma::vec phase = arma::zeros<arma::vec>(T+1);
+  phase.rows(1,T) = arma::cumsum(x);
+  
+  arma::vec csum = arma::zeros<arma::vec>(T+2);
+  csum.rows(1,T+1) = arma::cumsum(phase);
+  
+  for (unsigned int i = 1; i <= J; i++){
+    // Tau
+    unsigned int tau = pow(2,i);
+    
+    // Number of terms in the outer sum
+    unsigned int M = T - 3*tau + 2;
+    
+    double summed = 0;
+    for(unsigned int j = 0; j < M; j++){
+      // sum_{i=j}^{j+tau-1} x_{i+c} = S_{j+tau+c} - S_{j+c}
+      double inner = (csum(j+3*tau) - csum(j+2*tau)) - 2*(csum(j+2*tau) - csum(j+tau)) + (csum(j+tau) - csum(j));
+      summed += inner*inner;
+    }
+    
+    // Cluster size
+    av(i-1,0) = tau;
+    // Compute the Modified Allan Variance estimate
+    av(i-1,1) = summed/(2*pow(double(tau),4)*M);
+    // Compute Error
+    av(i-1,2) = 1/sqrt(2*( (double(T)/tau) - 1) );
+  }
+  
+  return av;
+}
+
+//' @title Compute the Total Variance
+//' @description Computation of the Total (Tot) Variance using a linear-time algorithm per cluster size.
+//' @usage totvar_cpp(x)
+//' @param x A \code{vector} with dimensions N x 1. 
+//' @return av A \code{matrix} that contains:
+//' \itemize{
+//'  \item{Col 1}{The size of the cluster}
+//'  \item{Col 2}{The total variance}
+//'  \item{Col 3}{The error associated with the variance estimation.}
+//' }
+//' @details
+//' The series is treated as frequency data \eqn{y_t} and is first integrated into the phase
+//' \eqn{x_k = \sum_{t < k} y_t}{x_k = sum_{t < k} y_t} with \eqn{k = 0, \ldots, N}{k = 0, ..., N}.
+//' The phase is then extended by reflection about both endpoints, i.e.
+//' \eqn{x_{-j} = 2x_0 - x_j}{x_{-j} = 2*x_0 - x_j} and \eqn{x_{N+j} = 2x_N - x_{N-j}}{x_{N+j} = 2*x_N - x_{N-j}}
+//' for \eqn{1 \le j \le N - 1}{1 <= j <= N - 1}. For a cluster of size \eqn{m}, the total variance is given by:
+//' \eqn{\frac{1}{{2{m^2}\left( {N - 1} \right)}}\sum\limits_{k = 1}^{N - 1} {{{\left( {{x_{k - m}} - 2{x_k} + {x_{k + m}}} \right)}^2}} }
+//' 
+//' The reflected phase is built once, so each cluster size costs \eqn{O(N)}{O(N)}.
+//' The error is based on the white noise approximation of \eqn{1.5N/m}{1.5*N/m} degrees of freedom.
+//' @author JJB
+//' @references Handbook of Frequency Stability Analysis, W. J. Riley, NIST Special Publication 1065
+//' @examples
+//' set.seed(999)
+//' N = 100000
+//' white.noise = rnorm(N, 0, 2)
+//' random.walk = cumsum(0.1*rnorm(N, 0, 2))
+//' combined.ts = white.noise+random.walk
+//' tv_mat = totvar_cpp(combined.ts)
+//' @keywords internal
+// [[Rcpp::export]]
+arma::mat totvar_cpp(const arma::vec& x) {
+  
+  // Length of vector
+  unsigned int T = x.n_elem;
+  
+  // Create the number of halves possible and use it to find the number of clusters
+  unsigned int J = (T < 4) ? 0 : floor(log10(T)/log10(2))-1;
+  
+  // Total Variance Matrix
+  arma::mat av = arma::zeros<arma::mat>(J,3);
+  
+  if(J == 0){
+    return av;
+  }
+  
+  // Phase (x_0 = 0)
+  arma::vec phase = arma::zeros<arma::vec>(T+1);
+  phase.rows(1,T) = arma::cumsum(x);
+  
+  // Reflected phase: index k of the phase lives at k + (T-1)
+  unsigned int off = T - 1;
+  arma::vec ext(3*T - 1);
+  ext.rows(off, off+T) = phase;
+  for(unsigned int j = 1; j <= T - 1; j++){
+    ext(off-j) = 2*phase(0) - phase(j);
+    ext(off+T+j) = 2*phase(T) - phase(T-j);
+  }
+  
+  for (unsigned int i = 1; i <= J; i++){
+    // Tau
+    unsigned int tau = pow(2,i);
+    
+    double summed = 0;
+    for(unsigned int k = 1; k < T; k++){
+      double d = ext(off+k-tau) - 2*ext(off+k) + ext(off+k+tau);
+      summed += d*d;
+    }
+    
+    // Cluster size
+    av(i-1,0) = tau;
+    // Compute the Total Variance estimate
+    av(i-1,1) = summed/(2*double(tau)*tau*(T-1));
+    // Compute Error
+    av(i-1,2) = 1/sqrt(3*(double(T)/tau));
+  }
+  
+  return av;
+}
+
 /* --------------------- End Allan Variance Functions ---------------------- */
\ No newline at end of file
@@ -1,8 +1,12 @@
 #ifndef ALLAN_VARIANCE
 #define ALLAN_VARIANCE
 
-arma::mat avar_to_cpp(arma::vec x);
+arma::mat avar_to_cpp(const arma::vec& x);
 
-arma::mat avar_mo_cpp(arma::vec x);
+arma::mat avar_mo_cpp(const arma::vec& x);
+
+arma::mat mavar_mo_cpp(arma::vec x);
+
+arma::mat totvar_cpp(const arma::vec& x);
 
 #endif
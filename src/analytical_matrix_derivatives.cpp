@@ -3,6 +3,7 @@
 #include "inline_functions.h"
 #include "process_to_wv.h"
 #include "rtoarmadillo.h"
+#include "wv_cache.h"
 
 //' ARMA Adapter to ARMA to WV Process function
 //' 
@@ -493,6 +494,40 @@ arma::mat deriv_wn(const arma::vec& tau){
      return D;
 }
 
+//' @title Derivatives of a Single Process
+//' @description Computes the first (\code{order = 1}) or second (\code{order = 2}) derivatives of the
+//' WV of an AR1, GM, MA1 or ARMA11 process. The result is memoised while a \code{wv_cache_scope} is active.
+//' @param type  A \code{string} containing the descriptor of the process.
+//' @param theta A \code{vec} containing the parameters of the model.
+//' @param start An \code{unsigned int} giving the position of the first parameter of the process.
+//' @template misc/tau
+//' @param order An \code{unsigned int} that is either 1 or 2.
+//' @return A \code{matrix} with the derivatives of the process going down the column
+//' @keywords internal
+arma::mat process_deriv(const std::string& type, const arma::vec& theta, unsigned int start,
+                        const arma::vec& tau, unsigned int order){
+  wv_cache_kind kind = (order == 1) ? WV_CACHE_DERIV : WV_CACHE_DERIV2;
+  unsigned int n = process_param_count(type);
+  
+  arma::mat d;
+  if(wv_cache_get(kind, type, theta, start, n, tau, d)){
+    return d;
+  }
+  
+  if(type == "AR1" || type == "GM"){
+    d = (order == 1) ? deriv_ar1(theta(start), theta(start + 1), tau) : deriv_2nd_ar1(theta(start), theta(start + 1), tau);
+  }else if(type == "MA1"){
+    d = (order == 1) ? deriv_ma1(theta(start), theta(start + 1), tau) : deriv_2nd_ma1(theta(start), theta(start + 1), tau);
+  }else{ // ARMA11
+    d = (order == 1) ? deriv_arma11(theta(start), theta(start + 1), theta(start + 2), tau)
+                     : deriv_2nd_arma11(theta(start), theta(start + 1), theta(start + 2), tau);
+  }
+  
+  wv_cache_put(kind, type, theta, start, n, tau, d);
+  
+  return d;
+}
+
 //' Analytic D matrix of Processes
 //' 
 //' This function computes each process to WV (haar) in a given model.
@@ -528,30 +563,22 @@ arma::mat derivative_first_matrix(const arma::vec& theta,
     // AR 1
     if(element_type == "AR1" || element_type == "GM"){
       ++i_theta;
-      double sig2 = theta(i_theta);
       
       // Compute theoretical WV
-      D.cols(i_theta-1,i_theta) = deriv_ar1(theta_value, sig2, tau);
+      D.cols(i_theta-1,i_theta) = process_deriv(element_type, theta, i_theta-1, tau, 1);
     } // MA 1
     else if(element_type == "MA1"){
       
       ++i_theta;
-      double sig2 = theta(i_theta);
       
       // Compute theoretical WV
-      D.cols(i_theta-1,i_theta) = deriv_ma1(theta_value, sig2, tau);
+      D.cols(i_theta-1,i_theta) = process_deriv(element_type, theta, i_theta-1, tau, 1);
     }
     else if(element_type == "ARMA11"){
-      ++i_theta;
-      
-      double th = theta(i_theta);
-      
-      ++i_theta;
-      
-      double sig2 = theta(i_theta);
+      i_theta += 2;
       
       // Compute theoretical WV
-      D.cols(i_theta-2,i_theta) = deriv_arma11(theta_value, th, sig2, tau);
+      D.cols(i_theta-2,i_theta) = process_deriv(element_type, theta, i_theta-2, tau, 1);
       
     }
     // WN
@@ -633,20 +660,15 @@ arma::mat D_matrix(const arma::vec& theta,
   unsigned int i_theta = 0;
   for(unsigned int i = 0; i < num_desc; i++){
 
-    // Pop the first element. 
-    
-    double theta_value = theta(i_theta);
-    
     std::string element_type = desc[i];
     
     // AR 1
     if(element_type == "AR1" || element_type == "GM"){
       
       ++i_theta;
-      double sig2 = theta(i_theta);
       
       // Return matrix with d/dphi^2, d/dphisigma2, d/dsigma2^2
-      arma::mat s = deriv_2nd_ar1(theta_value, sig2, tau).t();
+      arma::mat s = process_deriv(element_type, theta, i_theta-1, tau, 2).t();
       
       // Modify p columns for phi
       // We have dphi^2 vs. dphisigma2
@@ -669,10 +691,9 @@ arma::mat D_matrix(const arma::vec& theta,
     }else if(element_type == "MA1"){
       
       ++i_theta;
-      double sig2 = theta(i_theta);
       
       // Return matrix with d/dtheta^2, d/dthetasigma2, d/dsigma2^2
-      arma::mat s = deriv_2nd_ma1(theta_value, sig2, tau).t();
+      arma::mat s = process_deriv(element_type, theta, i_theta-1, tau, 2).t();
       
       // Modify p columns for theta
       // We have dtheta^2 vs. dthetasigma2
@@ -695,21 +716,13 @@ arma::mat D_matrix(const arma::vec& theta,
     }
     else if(element_type == "ARMA11"){
       
-      // We receive the phi value in theta_value 
-      // I know, confusing... Don't blame me, I wrote it in the past (er present?)
-      
+      // Parameters are phi, theta and sigma2
       unsigned int start_i_theta = i_theta;
       
-      ++i_theta;
-      // theta value
-      double th = theta(i_theta);
-      
-      ++i_theta;
-      // sigma2
-      double sig2 = theta(i_theta);
+      i_theta += 2;
       
       // Return matrix with d/dtheta^2, d/dthetasig, d/dsig^2
-      arma::mat s = deriv_2nd_arma11(theta_value, th, sig2, tau).t();
+      arma::mat s = process_deriv(element_type, theta, start_i_theta, tau, 2).t();
       
       /* We receive from 2nd arma11 the following:
        * 
@@ -37,6 +37,9 @@ arma::mat deriv_RW(const arma::vec& tau);
 
 arma::mat deriv_WN(const arma::vec& tau);
 
+arma::mat process_deriv(const std::string& type, const arma::vec& theta, unsigned int start,
+                        const arma::vec& tau, unsigned int order);
+
 arma::mat derivative_first_matrix(const arma::vec& theta, 
                                   const std::vector<std::string>& desc,
                                   const arma::field<arma::vec>& objdesc,
@@ -2,6 +2,13 @@
 
 #include "arima_gmwm.h"
 
+// bfgs_min
+#include "bfgs.h"
+
+// invert_check
+#include "ts_checks.h"
+
+#ifndef GMWM_STANDALONE
 //' @title Hook into R's ARIMA function
 //' @description Uses R's ARIMA function to obtain CSS values for starting condition
 //' @param data A \code{vec} of data.
@@ -61,3 +68,214 @@ arma::vec Rcpp_ARIMA(const arma::vec& data,
   
   return out;
 }
+#endif
+
+
+
+/* ----------------------- Start Native CSS ------------------------ */
+
+// Orders of a (S)ARMA model described by an ARMA11 or SARIMA objdesc
+struct css_orders{
+  unsigned int p, q, P, Q, s;
+};
+
+css_orders css_model_orders(const arma::vec& params){
+  css_orders o;
+  o.p = params(0);
+  o.q = params(1);
+  o.P = o.Q = o.s = 0;
+
+  // Seasonal terms are only used with a season, as in Rcpp_ARIMA
+  if(params.n_elem > 5 && params(5) > 0){
+    o.P = params(2);
+    o.Q = params(3);
+    o.s = params(5);
+  }
+
+  return o;
+}
+
+// Conditional sum of squares of a (S)ARMA model, as minimised by stats::arima(method = "CSS").
+//
+// The objective is 0.5*log(S/m), with S the sum of the m squared residuals after the first
+// p + s*P observations. The gradient is obtained by running the residual recursion backwards
+// (adjoint method), so it costs about as much as the objective itself.
+class css_objective : public differentiable_function{
+public:
+  css_objective(const arma::vec& w, const css_orders& o) : w(w), o(o), e(w.n_elem) {
+    pf = o.p + o.s*o.P;
+    qf = o.q + o.s*o.Q;
+    ncond = pf;
+  }
+
+  // Full AR and MA polynomials of the expanded seasonal model (the transPars of stats::arima)
+  void expand(const arma::vec& par, arma::vec& phi, arma::vec& theta) const{
+    phi = arma::zeros<arma::vec>(pf);
+    theta = arma::zeros<arma::vec>(qf);
+
+    for(unsigned int i = 0; i < o.p; i++) phi(i) = par(i);
+    for(unsigned int i = 0; i < o.q; i++) theta(i) = par(o.p + i);
+
+    for(unsigned int j = 0; j < o.P; j++){
+      double sar = par(o.p + o.q + j);
+      phi((j + 1)*o.s - 1) += sar;
+      for(unsigned int i = 0; i < o.p; i++){
+        phi((j + 1)*o.s + i) -= par(i)*sar;
+      }
+    }
+
+    for(unsigned int j = 0; j < o.Q; j++){
+      double sma = par(o.p + o.q + o.P + j);
+      theta((j + 1)*o.s - 1) += sma;
+      for(unsigned int i = 0; i < o.q; i++){
+        theta((j + 1)*o.s + i) += par(o.p + i)*sma;
+      }
+    }
+  }
+
+  double value(const arma::vec& par){
+    expand(par, phi, theta);
+
+    unsigned int n = w.n_elem;
+    e.zeros();
+    ssq = 0;
+    m = 0;
+
+    for(unsigned int t = ncond; t < n; t++){
+      double tmp = w(t);
+      for(unsigned int j = 0; j < pf; j++){
+        tmp -= phi(j)*w(t - j - 1);
+      }
+      for(unsigned int j = 0; j < std::min(t - ncond, qf); j++){
+        tmp -= theta(j)*e(t - j - 1);
+      }
+      e(t) = tmp;
+      ssq += tmp*tmp;
+      m++;
+    }
+
+    if(m == 0){
+      return arma::datum::inf;
+    }
+
+    return 0.5*log(ssq/m);
+  }
+
+  void gradient(const arma::vec& par, arma::vec& g){
+    unsigned int n = w.n_elem;
+
+    // Adjoint of the residuals: lambda_t = dS/de_t, including the effect of e_t on later residuals
+    arma::vec lambda = arma::zeros<arma::vec>(n);
+    for(unsigned int t = n; t-- > ncond; ){
+      double l = 2.0*e(t);
+      for(unsigned int k = 1; k <= qf && t + k < n; k++){
+        l -= theta(k - 1)*lambda(t + k);
+      }
+      lambda(t) = l;
+    }
+
+    // Derivatives with respect to the full polynomials
+    arma::vec gphi = arma::zeros<arma::vec>(pf);
+    arma::vec gtheta = arma::zeros<arma::vec>(qf);
+    for(unsigned int t = ncond; t < n; t++){
+      for(unsigned int j = 0; j < pf; j++){
+        gphi(j) -= lambda(t)*w(t - j - 1);
+      }
+      for(unsigned int j = 0; j < qf && j + 1 <= t; j++){
+        gtheta(j) -= lambda(t)*e(t - j - 1);
+      }
+    }
+
+    // Chain rule through the seasonal expansion and the log
+    g.zeros(par.n_elem);
+    for(unsigned int i = 0; i < o.p; i++) g(i) = gphi(i);
+    for(unsigned int i = 0; i < o.q; i++) g(o.p + i) = gtheta(i);
+
+    for(unsigned int j = 0; j < o.P; j++){
+      unsigned int J = o.p + o.q + j;
+      g(J) = gphi((j + 1)*o.s - 1);
+      for(unsigned int i = 0; i < o.p; i++){
+        g(i) -= par(J)*gphi((j + 1)*o.s + i);
+        g(J) -= par(i)*gphi((j + 1)*o.s + i);
+      }
+    }
+
+    for(unsigned int j = 0; j < o.Q; j++){
+      unsigned int J = o.p + o.q + o.P + j;
+      g(J) = gtheta((j + 1)*o.s - 1);
+      for(unsigned int i = 0; i < o.q; i++){
+        g(o.p + i) += par(J)*gtheta((j + 1)*o.s + i);
+        g(J) += par(o.p + i)*gtheta((j + 1)*o.s + i);
+      }
+    }
+
+    g *= 0.5/ssq;
+  }
+
+  // Innovation variance at the last point evaluated
+  double sigma2() const{
+    return ssq/m;
+  }
+
+  const arma::vec& ar_polynomial() const{
+    return phi;
+  }
+
+private:
+  const arma::vec& w;
+  css_orders o;
+  unsigned int pf, qf, ncond;
+
+  // State of the last evaluation
+  arma::vec phi, theta, e;
+  double ssq;
+  unsigned int m;
+};
+
+// Fits a (S)ARMA model by conditional sum of squares from zero starting values.
+// Does not use the R API, so it can be called from any thread.
+css_fit arima_css_fit(const arma::vec& x, const arma::vec& params){
+  css_orders o = css_model_orders(params);
+  unsigned int np = o.p + o.q + o.P + o.Q;
+
+  css_fit fit;
+  fit.valid = false;
+  fit.value = arma::datum::inf;
+  fit.coef = arma::zeros<arma::vec>(np + 1);
+
+  if(x.n_elem <= o.p + o.s*o.P + 1){
+    return fit;
+  }
+
+  css_objective css(x, o);
+  bfgs_result opt = bfgs_min(css, arma::zeros<arma::vec>(np));
+
+  // Residuals at the estimates
+  double value = css.value(opt.par);
+
+  for(unsigned int i = 0; i < np; i++){
+    fit.coef(i) = opt.par(i);
+  }
+  fit.coef(np) = css.sigma2();
+  fit.value = value;
+
+  // stats::arima refuses a non-stationary AR part, so it is not a usable starting point either
+  arma::vec ar_poly = arma::join_cols(arma::ones<arma::vec>(1), -css.ar_polynomial());
+  fit.valid = arma::is_finite(value) && (ar_poly.n_elem == 1 || invert_check(ar_poly));
+
+  return fit;
+}
+
+//' @title Conditional Sum of Squares (S)ARMA Estimates
+//' @description Native equivalent of \code{\link{Rcpp_ARIMA}}: fits the (S)ARMA model by conditional
+//' sum of squares with BFGS and an analytic gradient, without calling into R.
+//' @param data A \code{vec} of data.
+//' @param params A \code{vec} of the ARMA parameters
+//' @return A \code{vec} containing the CSS estimates of the ARMA parameters followed by the innovation variance.
+//' @keywords internal
+// [[Rcpp::export]]
+arma::vec arima_css(const arma::vec& data, const arma::vec& params){
+  return arima_css_fit(data, params).coef;
+}
+
+/* ------------------------ End Native CSS ------------------------- */
@@ -1,7 +1,20 @@
 #ifndef ARIMA_GMWM_H
 #define ARIMA_GMWM_H
 
+#ifndef GMWM_STANDALONE
 arma::vec Rcpp_ARIMA(const arma::vec& data,
                      const arma::vec& params);
+#endif
+
+// CSS estimates of a (S)ARMA model
+struct css_fit{
+  arma::vec coef;     // AR, MA, seasonal AR, seasonal MA, then the innovation variance
+  double value;       // 0.5*log of the innovation variance
+  bool valid;         // Finite and with a stationary AR part
+};
+
+css_fit arima_css_fit(const arma::vec& x, const arma::vec& params);
+
+arma::vec arima_css(const arma::vec& data, const arma::vec& params);
 
 #endif
\ No newline at end of file
@@ -84,9 +84,10 @@ arma::mat rev_row_subset(arma::mat x, unsigned int start, unsigned int end){
 //' reverse_vec(x)
 //' @keywords internal
 // [[Rcpp::export]]
-arma::vec reverse_vec(arma::vec x) {
-   std::reverse(x.begin(), x.end());
-   return x;
+arma::vec reverse_vec(const arma::vec& x) {
+   arma::vec out(x.n_elem);
+   std::reverse_copy(x.begin(), x.end(), out.begin());
+   return out;
 }
 
 //' @title Transform an Armadillo field<vec> to a matrix
@@ -7,7 +7,7 @@ arma::mat rev_col_subset(arma::mat x, unsigned int start, unsigned int end);
 
 arma::mat rev_row_subset(arma::mat x, unsigned int start, unsigned int end);
 
-arma::vec reverse_vec(arma::vec x);
+arma::vec reverse_vec(const arma::vec& x);
 
 arma::mat field_to_matrix(arma::field<arma::vec> x);
 
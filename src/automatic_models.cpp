@@ -1,6 +1,7 @@
 #include <RcppArmadillo.h>
 
 #include "bootstrappers.h"
+#include "fit_state.h"
 #include "inference.h"
 #include "gmwm_logic.h"
 
@@ -12,13 +13,26 @@
 
 #include "analytical_matrix_derivatives.h"
 
+// Used for theoretical_wv and process_param_count
+#include "process_to_wv.h"
+
+// Memoises the process WV shared by the candidate models
+#include "wv_cache.h"
+
 #include "model_selection.h"
 
 #include "ts_model_cpp.h"
 
 #include "ts_checks.h"
 
-//#include "automatic_models.h"
+// RNG and messages of the context
+#include "gmwm_context.h"
+
+// Times the selection and counts the candidates
+#include "gmwm_profile.h"
+#include "gmwm_trace.h"
+
+#include "automatic_models.h"
 
 // ---- START helper functions
 
@@ -79,9 +93,7 @@ std::set<std::vector<std::string > > build_model_set(const arma::mat& combs, std
 //' all.equal(x,y, check.attributes = FALSE)
 // [[Rcpp::export]]
 void set_seed(unsigned int seed) {
-  Rcpp::Environment base_env("package:base");
-  Rcpp::Function set_seed_r = base_env["set.seed"];
-  set_seed_r(seed);  
+  current_context().rng->seed(seed);
 }
 
 
@@ -284,39 +296,333 @@ arma::rowvec bs_optim_calc(const arma::vec& theta,
 }
 
 
-arma::rowvec asympt_calc(const arma::vec& theta,
+// Model score and GoF p-value of a fit. V_inv is the inverse of V, shared by all candidates.
+arma::rowvec asympt_calc(const fit_state& fit,
                          const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, 
-                         std::string model_type, const arma::vec& scales, const arma::mat& V, const arma::mat& omega,
-                         const arma::vec& wv_empir, const arma::vec& theo, double obj_value){
-  
-  // Take derivatives
-  arma::mat A = derivative_first_matrix(theta, desc, objdesc, scales);
+                         std::string model_type, const arma::vec& scales, const arma::mat& V, const arma::mat& V_inv,
+                         const arma::vec& wv_empir){
   
-
   /* A note to someone in the future...
   * Yes, there is a difference in order between the diff (wv_empir-theo) for D_matrix
   *  and the model_score diff (theo-wv_empir).
   */
   
   // Create the D Matrix (note this is in the analytical_matrix_derivaties.cpp file)
-  arma::mat D = D_matrix(theta, desc, objdesc, scales, omega*(theo - wv_empir));
+  arma::mat D = D_matrix(fit.theta, desc, objdesc, scales, fit.omega*(fit.theo - wv_empir));
   
   arma::rowvec temp(4);
   
-  arma::vec result = model_score(A, D, omega, V,  obj_value);
+  arma::vec result = model_score(fit, D, V);
   
-  temp(0) = obj_value;
+  temp(0) = fit.obj_value;
   temp(1) = arma::as_scalar(result.row(1));
   temp(2) = arma::as_scalar(result.row(0));
-  temp(3) = arma::as_scalar( gof_test(theta, desc, objdesc, model_type, scales, V, wv_empir).row(1) ); // GoF
+  temp(3) = arma::as_scalar( gof_test(fit, desc, objdesc, model_type, scales, V, V_inv, wv_empir).row(1) ); // GoF
   
   return temp;
 }
 
 
+
+// Index of each candidate model, keyed by its sorted terms so that the order of the terms does not matter
+std::map<std::vector<std::string>, unsigned int> index_models(const std::vector<std::vector<std::string> >& cands){
+  std::map<std::vector<std::string>, unsigned int> index;
+  for(unsigned int i = 0; i < cands.size(); i++){
+    std::vector<std::string> key = cands[i];
+    std::sort(key.begin(), key.end());
+    index[key] = i;
+  }
+  return index;
+}
+
+// Candidates nested in each candidate by removing a single term
+std::vector<std::vector<unsigned int> > nested_models(const std::vector<std::vector<std::string> >& cands){
+  std::map<std::vector<std::string>, unsigned int> index = index_models(cands);
+  std::vector<std::vector<unsigned int> > children(cands.size());
+  
+  for(unsigned int i = 0; i < cands.size(); i++){
+    std::vector<std::string> key = cands[i];
+    std::sort(key.begin(), key.end());
+    
+    for(unsigned int j = 0; j < key.size(); j++){
+      // Identical terms give the same sub model
+      if(j > 0 && key[j] == key[j-1]){
+        continue;
+      }
+      std::vector<std::string> sub = key;
+      sub.erase(sub.begin() + j);
+      
+      std::map<std::vector<std::string>, unsigned int>::const_iterator it = index.find(sub);
+      if(it != index.end()){
+        children[i].push_back(it->second);
+      }
+    }
+  }
+  
+  return children;
+}
+
+// Inverse relation of nested_models: candidates obtained by adding a single term
+std::vector<std::vector<unsigned int> > nesting_models(const std::vector<std::vector<unsigned int> >& children){
+  std::vector<std::vector<unsigned int> > parents(children.size());
+  for(unsigned int i = 0; i < children.size(); i++){
+    for(unsigned int j = 0; j < children[i].size(); j++){
+      parents[children[i][j]].push_back(i);
+    }
+  }
+  return parents;
+}
+
+// Orders candidates by decreasing number of terms
+struct more_terms{
+  more_terms(const std::vector<std::vector<std::string> >& cands) : cands(cands) {}
+  bool operator()(unsigned int a, unsigned int b) const { return cands[a].size() > cands[b].size(); }
+  const std::vector<std::vector<std::string> >& cands;
+};
+
+// True when every term of sub (with multiplicity) is a term of sup
+bool nested_in(std::vector<std::string> sub, std::vector<std::string> sup){
+  std::sort(sub.begin(), sub.end());
+  std::sort(sup.begin(), sup.end());
+  return std::includes(sup.begin(), sup.end(), sub.begin(), sub.end());
+}
+
+// Position of the first parameter of the k-th term of the given type, or -1 if there are not that many
+int term_start(const std::vector<std::string>& desc, const std::string& type, unsigned int k){
+  unsigned int i_theta = 0;
+  for(unsigned int i = 0; i < desc.size(); i++){
+    if(desc[i] == type){
+      if(k == 0){
+        return i_theta;
+      }
+      k--;
+    }
+    i_theta += process_param_count(desc[i]);
+  }
+  return -1;
+}
+
+/* Starting values for desc taken from a fitted donor model. The k-th term of a type takes the parameters
+ * of the k-th term of that type in the donor or, when the donor has fewer of them, in the full model
+ * (AR1s are ordered by decreasing phi in both). Returns false for processes with a varying number of
+ * parameters, which cannot be matched.
+ */
+bool warm_theta(const std::vector<std::string>& desc,
+                const std::vector<std::string>& donor, const arma::vec& donor_theta,
+                const std::vector<std::string>& full, const arma::vec& full_theta,
+                arma::vec& theta){
+  std::map<std::string, unsigned int> seen;
+  
+  unsigned int i_theta = 0;
+  for(unsigned int i = 0; i < desc.size(); i++){
+    unsigned int np = process_param_count(desc[i]);
+    if(np == 0){
+      return false;
+    }
+    
+    unsigned int k = seen[desc[i]]++;
+    
+    int start = term_start(donor, desc[i], k);
+    const arma::vec* source = &donor_theta;
+    if(start < 0){
+      start = term_start(full, desc[i], k);
+      source = &full_theta;
+    }
+    if(start < 0){
+      return false;
+    }
+    
+    theta.rows(i_theta, i_theta + np - 1) = source->rows(start, start + np - 1);
+    i_theta += np;
+  }
+  
+  return true;
+}
+
+/* Removing processes leaves part of the WV unexplained. As the WV of every process is linear in its
+ * variance (quadratic in the slope of a drift), scaling all variances by c scales the theoretical WV by c.
+ * The c minimising the weighted distance to the empirical WV has a closed form.
+ */
+void rescale_variances(arma::vec& theta, const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc,
+                       const arma::vec& scales, const arma::vec& wv_empir, const arma::vec& weights){
+  arma::vec theo = theoretical_wv(theta, desc, objdesc, scales);
+  
+  double c = arma::sum(weights % theo % wv_empir) / arma::sum(weights % theo % theo);
+  if(!arma::is_finite(c) || c <= 0){
+    return;
+  }
+  
+  unsigned int i_theta = 0;
+  for(unsigned int i = 0; i < desc.size(); i++){
+    unsigned int np = process_param_count(desc[i]);
+    
+    if(desc[i] == "DR"){
+      theta(i_theta) *= sqrt(c);
+    }else{
+      // The variance is the last parameter of each process
+      theta(i_theta + np - 1) *= c;
+    }
+    
+    i_theta += np;
+  }
+}
+
+// Fits candidate models against the WV of the full model and stores their scores
+struct candidate_fitter{
+  // Shared by all candidates
+  const std::vector<std::vector<std::string> >& cands;
+  std::string model_type;
+  unsigned int N;
+  double expect_diff, dr_slope;
+  const arma::mat& orgV;
+  const arma::mat& omega;
+  const arma::mat& V;
+  const arma::mat& V_inv;
+  const arma::vec& scales;
+  const arma::mat& wv;
+  const arma::vec& wv_empir;
+  bool bs_optimism;
+  double alpha;
+  std::string compute_v;
+  unsigned int K, H, G;
+  bool robust;
+  double eff;
+  unsigned int seed;
+  bool warm_start;
+  unsigned int full;
+  
+  // Scores and fits, filled as candidates are fitted
+  std::vector<bool>& fitted;
+  arma::mat& results;
+  arma::field<arma::field<arma::mat> >& model_results;
+  unsigned int& count;
+  unsigned int& warm_count;
+  
+  // Closest fitted model that i is nested in or that is nested in i, preferring the former on ties
+  int closest_fitted(unsigned int i) const{
+    int donor = -1;
+    unsigned int best = 0;
+    bool best_super = false;
+    for(unsigned int j = 0; j < cands.size(); j++){
+      if(!fitted[j]){
+        continue;
+      }
+      
+      bool super = cands[j].size() > cands[i].size();
+      unsigned int dist = super ? cands[j].size() - cands[i].size() : cands[i].size() - cands[j].size();
+      
+      if(donor >= 0 && (dist > best || (dist == best && (best_super || !super)))){
+        continue;
+      }
+      
+      if(super ? nested_in(cands[i], cands[j]) : nested_in(cands[j], cands[i])){
+        donor = j;
+        best = dist;
+        best_super = super;
+      }
+    }
+    return donor;
+  }
+  
+  // A warm started fit is kept if its objective is finite and, as adding processes can only lower the
+  // objective, no larger than the objective of any fitted model nested in it.
+  bool acceptable(unsigned int i, double obj_value) const{
+    if(!arma::is_finite(obj_value)){
+      return false;
+    }
+    for(unsigned int j = 0; j < cands.size(); j++){
+      if(fitted[j] && j != i && cands[j].size() < cands[i].size() && nested_in(cands[j], cands[i]) &&
+         obj_value > results(j, 0) * (1 + 1e-6)){
+        return false;
+      }
+    }
+    return true;
+  }
+  
+  // Fits the i-th candidate unless it already was. Returns its criterion.
+  double operator()(unsigned int i){
+    if(!fitted[i]){
+      trace_scope trace("candidate", "select", i);
+      
+      count++;
+      
+      log_line() << "Processing model " << count << " out of " << cands.size();
+      
+      const std::vector<std::string>& desc = cands[i];
+      
+      // Build the fields off of the model's description
+      arma::vec theta = model_theta(desc);
+      arma::field<arma::vec> objdesc = model_objdesc(desc); 
+      
+      // Every candidate is fitted from the same RNG state, so that its score does not depend on the candidates
+      // visited before it
+      set_seed(seed);
+      
+      arma::field<arma::mat> update;
+      bool warm = false;
+      
+      // Start from the parameters of the closest fitted model instead of a random search
+      int donor = warm_start ? closest_fitted(i) : -1;
+      arma::vec start = theta;
+      if(donor >= 0 && warm_theta(desc, cands[donor], model_results(donor)(0), cands[full], model_results(full)(0), start)){
+        rescale_variances(start, desc, objdesc, scales, wv_empir, 1/orgV.diag());
+        
+        update = gmwm_update_cpp(start, desc, objdesc, model_type, 
+                                 N, expect_diff, dr_slope,
+                                 orgV, scales, wv,
+                                 false, // warm start
+                                 "fast", 
+                                 K,H,G, 
+                                 robust,eff);
+        
+        warm = acceptable(i, arma::as_scalar(update(5)));
+      }
+      
+      if(warm){
+        warm_count++;
+      }else{
+        // Set guessing seed, as the rejected warm start may have drawn from the RNG
+        set_seed(seed);
+        
+        // Run the update version of the GMWM
+        arma::field<arma::mat> guessed = gmwm_update_cpp(theta, desc, objdesc, model_type, 
+                                                         N, expect_diff, dr_slope,
+                                                         orgV, scales, wv,
+                                                         true, //starting
+                                                         "fast", 
+                                                         K,H,G, 
+                                                         robust,eff);
+        
+        // Keep the rejected warm start if the random search does no better
+        if(update.n_elem == 0 || !(arma::as_scalar(update(5)) <= arma::as_scalar(guessed(5)))){
+          update = guessed;
+        }
+      }
+      
+      theta = update(0);
+      arma::vec theo = update(3);
+      double obj_value = arma::as_scalar(update(5));
+      
+      if(bs_optimism){
+        results.row(i) = bs_optim_calc(theta,  desc,  objdesc, model_type, scales, omega, N,
+                    obj_value, alpha, compute_v, K, H, G, robust, eff);
+      }else{
+        // Calculate the model score according to model selection criteria paper
+        fit_state state = make_fit_state(theta, desc, objdesc, omega, scales, theo, obj_value);
+        results.row(i) = asympt_calc(state, desc, objdesc, model_type, scales, V, V_inv, wv_empir);
+      }
+      
+      model_results(i) = update;
+      fitted[i] = true;
+    }
+    
+    return results(i, 0) + results(i, 1);
+  }
+};
+
 // ---- End helper functions
 
-arma::field<arma::field<arma::mat> > model_select(arma::vec& data,
+arma::field<arma::field<arma::mat> > model_select(const arma::vec& data,
                                                   const std::set<std::vector<std::string > >& models,
                                                   const std::vector< std::string >& full_model,
                                                   std::string model_type,
@@ -324,7 +630,19 @@ arma::field<arma::field<arma::mat> > model_select(arma::vec& data,
                                                   double alpha,
                                                   std::string compute_v, 
                                                   unsigned int K, unsigned int H, unsigned int G, 
-                                                  bool robust, double eff, unsigned int seed){
+                                                  bool robust, double eff, unsigned int seed,
+                                                  std::string search, bool warm_start){
+  
+  if(search != "exhaustive" && search != "backward" && search != "forward" && search != "bnb"){
+    Rcpp::stop("The supplied 'search' argument is not supported! Choose either exhaustive, backward, forward or bnb.");
+  }
+  
+  profile_timer timer(STAGE_SELECT);
+  trace_scope trace("model_select", "select");
+  
+  // The theoretical WV and derivatives of each candidate are evaluated again at its estimates
+  // by the criterion and the goodness of fit: memoise them for the duration of the selection
+  wv_cache_scope cache;
   
   // Number of data points
   unsigned int N = data.n_rows;
@@ -335,10 +653,6 @@ arma::field<arma::field<arma::mat> > model_select(arma::vec& data,
   // Store output from models
   arma::field<arma::field<arma::mat> > model_results(num_models);
   
-  // Make an iterator to iterator through it
-  std::set<std::vector<std::string > > ::const_iterator iter;
-  iter = models.begin(); 
-  
   // Get the first model
   std::vector<std::string> desc = full_model;
   
@@ -352,7 +666,7 @@ arma::field<arma::field<arma::mat> > model_select(arma::vec& data,
   // Build matrix to store results
   arma::mat results(num_models, 4);
   
-  Rcpp::Rcout << "Processing model 1 out of " << num_models << std::endl;
+  log_line() << "Processing model 1 out of " << num_models;
   
   set_seed(seed);
   
@@ -427,8 +741,9 @@ arma::field<arma::field<arma::mat> > model_select(arma::vec& data,
   
   // Asymptotic ----
   
-  // Get bootstrapped V
+  // Get bootstrapped V and its inverse
   arma::mat V;
+  arma::mat V_inv;
   
   // Bootstrap ----
   // Hold optimism result
@@ -442,11 +757,13 @@ arma::field<arma::field<arma::mat> > model_select(arma::vec& data,
                 obj_value, alpha, compute_v, K, H, G, robust, eff);
   }else{
     
-    Rcpp::Rcout << "Bootstrapping the covariance matrix... Please stand by." << std::endl;
+    log_line() << "Bootstrapping the covariance matrix... Please stand by.";
     V = cov_bootstrapper(theta, desc, objdesc, N, robust, eff, H, false); // Bootstrapped V (largest model)
+    V_inv = arma::inv(V);
     
     // Calculate the model score according to model selection criteria paper
-    results.row(full_model_index) = asympt_calc(theta, desc, objdesc, model_type, scales, V, omega, wv_empir, theo, obj_value);
+    fit_state state = make_fit_state(theta, desc, objdesc, omega, scales, theo, obj_value);
+    results.row(full_model_index) = asympt_calc(state, desc, objdesc, model_type, scales, V, V_inv, wv_empir);
     
   }
   
@@ -462,68 +779,140 @@ arma::field<arma::field<arma::mat> > model_select(arma::vec& data,
   
   model_results(full_model_index) = model_update_info;
   
-  // Initialize counter to keep track of values
-  unsigned int count = 0;
+  // Candidate models, in the order of the set
+  std::vector<std::vector<std::string> > cands(models.begin(), models.end());
+  
+  // Models fitted so far
+  std::vector<bool> fitted(num_models, false);
+  fitted[full_model_index] = true;
   
   unsigned int countModels = 1;
+  unsigned int countWarm = 0;
   
-  while(iter != models.end()){
+  candidate_fitter fit = {cands, model_type, N, expect_diff, dr_slope, orgV, omega, V, V_inv, scales, wv, wv_empir,
+                          bs_optimism, alpha, compute_v, K, H, G, robust, eff, seed, warm_start, full_model_index,
+                          fitted, results, model_results, countModels, countWarm};
+  
+  if(search == "exhaustive"){
     
-    if(full_model_index != count){
-      countModels++;
-      
-      // Set guessing seed
-      set_seed(seed);
+    for(unsigned int i = 0; i < num_models; i++){
+      fit(i);
+    }
+    
+  }else{
+    
+    std::vector<std::vector<unsigned int> > children = nested_models(cands);
+    std::vector<std::vector<unsigned int> > parents = nesting_models(children);
+    
+    if(search == "backward"){
       
-      Rcpp::Rcout << "Processing model " << countModels << " out of " << num_models << std::endl;
-      // Get the first model
-      desc = *iter;
+      // Remove the term that lowers the criterion the most, as long as it decreases
+      unsigned int current = full_model_index;
+      double current_crit = results(current, 0) + results(current, 1);
       
-      // Build the fields off of the first model's description
-      theta = model_theta(desc);
-      objdesc = model_objdesc(desc); 
+      for(;;){
+        unsigned int best = current;
+        double best_crit = current_crit;
+        
+        for(unsigned int c = 0; c < children[current].size(); c++){
+          double crit = fit(children[current][c]);
+          if(crit < best_crit){
+            best = children[current][c];
+            best_crit = crit;
+          }
+        }
+        
+        if(best == current){
+          break;
+        }
+        current = best;
+        current_crit = best_crit;
+      }
       
-      // Run the update version of the GMWM
-      arma::field<arma::mat> update = gmwm_update_cpp(theta, desc, objdesc, model_type, 
-                                                      N, expect_diff, dr_slope,
-                                                      orgV, scales, wv,
-                                                      true, //starting
-                                                      "fast", 
-                                                      K,H,G, 
-                                                      robust,eff);
+    }else if(search == "forward"){
       
+      // Start from the best of the smallest models, then add the term that lowers the criterion the most
+      unsigned int current = full_model_index;
+      double current_crit = arma::datum::inf;
       
-      // Theta update
-      theta = update(0);
+      for(unsigned int i = 0; i < num_models; i++){
+        if(children[i].empty()){
+          double crit = fit(i);
+          if(crit < current_crit){
+            current = i;
+            current_crit = crit;
+          }
+        }
+      }
       
-      // Update theo
-      theo = update(3);
+      for(;;){
+        unsigned int best = current;
+        double best_crit = current_crit;
+        
+        for(unsigned int c = 0; c < parents[current].size(); c++){
+          double crit = fit(parents[current][c]);
+          if(crit < best_crit){
+            best = parents[current][c];
+            best_crit = crit;
+          }
+        }
+        
+        if(best == current){
+          break;
+        }
+        current = best;
+        current_crit = best_crit;
+      }
       
-      // Update objective function
-      obj_value = arma::as_scalar(update(5));
+    }else{
       
-      if(bs_optimism){
-        results.row(count) = bs_optim_calc(theta,  desc,  objdesc, model_type, scales, omega, N,
-                    obj_value, alpha, compute_v, K, H, G, robust, eff);
-      }else{
-        // Calculate the model score according to model selection criteria paper
-        results.row(count) = asympt_calc(theta, desc, objdesc, model_type, scales, V, omega, wv_empir, theo, obj_value);
+      /* Branch and bound (heuristic)
+       * At their global minimum, removing terms from a model can only increase the objective function, as the
+       * theoretical WV is additive in the terms. The objective value of a fitted model plus the smallest optimism
+       * seen so far (when negative) is hence taken as a bound on the criterion of all models nested in it: they are
+       * skipped once it exceeds the best criterion found. The optimism of a skipped model may be lower still and
+       * each fit is a local search, so the selected model may differ from the one of the exhaustive search.
+       * Models are visited from the largest to the smallest so that each bound is known before it is needed.
+       */
+      std::vector<unsigned int> order(num_models);
+      for(unsigned int i = 0; i < num_models; i++){
+        order[i] = i;
       }
+      std::stable_sort(order.begin(), order.end(), more_terms(cands));
+      
+      arma::vec bound(num_models);
+      bound.fill(-arma::datum::inf);
+      bound(full_model_index) = results(full_model_index, 0);
       
-      model_results(count) = update;
+      double best_crit = results(full_model_index, 0) + results(full_model_index, 1);
       
+      // Smallest optimism of the fitted models, when negative
+      double optimism_floor = std::min(0.0, results(full_model_index, 1));
+      
+      for(unsigned int o = 0; o < num_models; o++){
+        unsigned int i = order[o];
+        if(fitted[i]){
+          continue;
+        }
+        
+        // Bound inherited from the models it is nested in, fitted or skipped
+        for(unsigned int p = 0; p < parents[i].size(); p++){
+          bound(i) = std::max(bound(i), bound(parents[i][p]));
+        }
+        
+        if(bound(i) + optimism_floor >= best_crit){
+          continue;
+        }
+        
+        best_crit = std::min(best_crit, fit(i));
+        bound(i) = std::max(bound(i), results(i, 0));
+        optimism_floor = std::min(optimism_floor, results(i, 1));
+      }
     }
-    // end if
-    
-    // Increment iterator
-    iter++;
     
-    // Increase count
-    count++;
+    log_line() << "Fitted " << countModels << " out of " << num_models << " models.";
   }
   
-  
-  
   // Only run if in asymptotic mode
   if(!bs_optimism){
     
@@ -558,10 +947,26 @@ arma::field<arma::field<arma::mat> > model_select(arma::vec& data,
     
   }
   
+  if(warm_start){
+    log_line() << "Warm started " << countWarm << " out of " << countModels - 1 << " candidate fits.";
+  }
+  
+  profile_count(COUNT_CANDIDATES, countModels);
+  profile_count(COUNT_WARM_STARTS, countWarm);
+  
+  // Only keep the models that were fitted
+  arma::uvec fitted_ind(countModels);
+  for(unsigned int i = 0, j = 0; i < num_models; i++){
+    if(fitted[i]){
+      fitted_ind(j++) = i;
+    }
+  }
+  results = results.rows(fitted_ind);
+  
   results.col(2) = results.col(0) + results.col(1);
   
   // Sort matrix
-  arma::uvec sort_ind = sort_index(results.col(2));
+  arma::uvec sort_ind = fitted_ind(sort_index(results.col(2)));
   
   // Pick the "best" model
   unsigned int best_model_id = sort_ind(0);
@@ -621,16 +1026,19 @@ arma::field<arma::field<arma::mat> > model_select(arma::vec& data,
 //' @param eff A \code{double} that indicates the efficiency to use.
 //' @param bs_optimism A \code{bool} that indicates whether the model selection score should be calculated with bootstrap or asymptotics.
 //' @param seed A \code{unsigned int} that is the seed one wishes to use. 
+//' @param search A \code{string} indicating how the candidate models are visited: \code{"exhaustive"}, \code{"backward"}, \code{"forward"} or \code{"bnb"} (see \code{\link{rank_models}}).
+//' @param warm_start A \code{bool} that indicates whether candidates start from the parameters of the closest fitted model (see \code{\link{rank_models}}).
 //' @return A \code{field<field<field<mat>>>} that contains the model score matrix and the best GMWM model object.
 //' @keywords internal
 // [[Rcpp::export]]
-arma::field< arma::field<arma::field<arma::mat> > >  rank_models_cpp(arma::vec& data,
+arma::field< arma::field<arma::field<arma::mat> > >  rank_models_cpp(const arma::vec& data,
                                                                      const std::vector<std::vector < std::string > >& model_str, 
                                                                      const std::vector< std::string >&  full_model,
                                                                      double alpha, 
                                                                      std::string compute_v, std::string model_type, 
                                                                      unsigned int K, unsigned int H, unsigned int G, 
-                                                                     bool robust, double eff, bool bs_optimism, unsigned int seed){
+                                                                     bool robust, double eff, bool bs_optimism, unsigned int seed,
+                                                                     std::string search = "exhaustive", bool warm_start = true){
   
   
   std::set<std::vector < std::string > > models = vector_to_set(model_str);
@@ -645,7 +1053,7 @@ arma::field< arma::field<arma::field<arma::mat> > >  rank_models_cpp(arma::vec&
     alpha,
     compute_v, 
     K, H, G, 
-    robust, eff, seed);
+    robust, eff, seed, search, warm_start);
   
   return h;
 }
@@ -665,16 +1073,19 @@ arma::field< arma::field<arma::field<arma::mat> > >  rank_models_cpp(arma::vec&
 //' @param eff A \code{double} that indicates the efficiency to use.
 //' @param bs_optimism A \code{bool} that indicates whether the model selection score should be calculated with bootstrap or asymptotics.
 //' @param seed A \code{unsigned int} that is the seed one wishes to use. 
+//' @param search A \code{string} indicating how the candidate models are visited: \code{"exhaustive"}, \code{"backward"}, \code{"forward"} or \code{"bnb"} (see \code{\link{rank_models}}).
+//' @param warm_start A \code{bool} that indicates whether candidates start from the parameters of the closest fitted model (see \code{\link{rank_models}}).
 //' @return A \code{field<field<field<mat>>>} that contains the model score matrix and the best GMWM model object.
 //' @keywords internal
 // [[Rcpp::export]]
-arma::field< arma::field<arma::field<arma::mat> > >  auto_imu_cpp(arma::mat& data,
+arma::field< arma::field<arma::field<arma::mat> > >  auto_imu_cpp(const arma::mat& data,
                                                                   const arma::mat& combs,
                                                                   const std::vector< std::string >&  full_model,
                                                                   double alpha, 
                                                                   std::string compute_v, std::string model_type, 
                                                                   unsigned int K, unsigned int H, unsigned int G, 
-                                                                  bool robust, double eff, bool bs_optimism, unsigned int seed){
+                                                                  bool robust, double eff, bool bs_optimism, unsigned int seed,
+                                                                  std::string search = "exhaustive", bool warm_start = true){
   
   
   
@@ -688,9 +1099,13 @@ arma::field< arma::field<arma::field<arma::mat> > >  auto_imu_cpp(arma::mat& dat
   arma::field< arma::field<arma::field<arma::mat> > > h(V);
   
   for(unsigned int i = 0; i < V; i++){
-    Rcpp::Rcout << "Generating models for the " << i + 1 << " column in the data set " << std::endl << std::endl;
+    trace_scope trace("auto_imu_axis", "select", i);
+    
+    log_line() << "Generating models for the " << i + 1 << " column in the data set ";
+    log_line();
     
-    arma::vec signal_col = data.col(i);
+    // View of the column, without copying it
+    const arma::vec signal_col = data.unsafe_col(i);
     
     h(i) = model_select(signal_col,
                         models,
@@ -700,9 +1115,9 @@ arma::field< arma::field<arma::field<arma::mat> > >  auto_imu_cpp(arma::mat& dat
                         alpha,
                         compute_v, 
                         K, H, G, 
-                        robust, eff, seed);
+                        robust, eff, seed, search, warm_start);
     
-    Rcpp::Rcout << std::endl;
+    log_line();
   }
   
   return h;
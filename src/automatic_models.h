@@ -0,0 +1,24 @@
+#ifndef AUTOMATIC_MODELS_H
+#define AUTOMATIC_MODELS_H
+
+void set_seed(unsigned int seed);
+
+arma::field< arma::field<arma::field<arma::mat> > > rank_models_cpp(const arma::vec& data,
+                                                                    const std::vector<std::vector < std::string > >& model_str, 
+                                                                    const std::vector< std::string >& full_model,
+                                                                    double alpha, 
+                                                                    std::string compute_v, std::string model_type, 
+                                                                    unsigned int K, unsigned int H, unsigned int G, 
+                                                                    bool robust, double eff, bool bs_optimism, unsigned int seed,
+                                                                    std::string search, bool warm_start);
+
+arma::field< arma::field<arma::field<arma::mat> > > auto_imu_cpp(const arma::mat& data,
+                                                                 const arma::mat& combs,
+                                                                 const std::vector< std::string >& full_model,
+                                                                 double alpha, 
+                                                                 std::string compute_v, std::string model_type, 
+                                                                 unsigned int K, unsigned int H, unsigned int G, 
+                                                                 bool robust, double eff, bool bs_optimism, unsigned int seed,
+                                                                 std::string search, bool warm_start);
+
+#endif
@@ -0,0 +1,443 @@
+#include <RcppArmadillo.h>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+#include "mpmc_queue.h"
+#include "mapped_file.h"
+#include "imu_layout.h"
+#include "read_imu.h"
+#include "batch_pipeline.h"
+
+// Uses modwt_cpp
+#include "dwt.h"
+
+// Uses ci_eta3, wvar_cpp
+#include "wave_variance.h"
+
+// Uses gmwm_master_wv_cpp
+#include "gmwm_logic.h"
+
+/* ----------------------- Start Batch IMU Pipeline ------------------------ */
+
+// Seconds elapsed since start
+inline double seconds_since(const std::chrono::steady_clock::time_point& start){
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Wait a little before retrying a full or empty queue: spin first, then yield, then sleep
+inline void backoff(unsigned int& spins){
+  if(spins < 64){
+    spins++;
+  }else if(spins < 128){
+    spins++;
+    std::this_thread::yield();
+  }else{
+    std::this_thread::sleep_for(std::chrono::microseconds(500));
+  }
+}
+
+// Decode stage: claims the next file, maps and decodes it, then hands it to the wavelet stage.
+// A file is only decoded once it is less than window files ahead of the next one to fit, which bounds
+// the files held by all stages together, whatever order the wavelet stage finishes them in.
+void batch_decode_worker(std::vector<batch_job>& jobs, std::atomic<unsigned int>& next_file,
+                         const std::atomic<unsigned int>& next_fit, unsigned int window,
+                         mpmc_queue<batch_job*>& decoded, const std::atomic<bool>& cancel){
+  for(;;){
+    unsigned int i = next_file.fetch_add(1);
+    if(i >= jobs.size() || cancel.load()){
+      return;
+    }
+
+    unsigned int spins = 0;
+    while(i >= next_fit.load() + window){
+      if(cancel.load()){
+        return;
+      }
+      backoff(spins);
+    }
+
+    batch_job& job = jobs[i];
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    try{
+      mapped_file fid(job.file);
+      fid.advise_sequential();
+
+      arma::field<arma::mat> imu = decode_imu_file(fid, *job.layout, false);
+      job.data.swap(imu(0));
+      job.fIMU = imu(1)(0);
+      job.n = job.data.n_rows;
+
+      // Inputs of the model fit that require the signal itself (see wvar4gmwm)
+      for(unsigned int c = 0; c < 6; c++){
+        const double* x = job.data.colptr(c + 1);
+        job.expect_diff(c) = (x[job.n - 1] - x[0])/double(job.n - 1);
+        job.ranged(c) = (job.data.col(c + 1).max() - job.data.col(c + 1).min())/double(job.n);
+      }
+    }catch(std::exception& e){
+      job.failed = true;
+      job.message = e.what();
+    }catch(...){
+      job.failed = true;
+      job.message = "Unknown error while reading the file.";
+    }
+
+    job.t_decode = seconds_since(start);
+
+    spins = 0;
+    while(!decoded.try_push(&job)){
+      if(cancel.load()){
+        return;
+      }
+      backoff(spins);
+    }
+  }
+}
+
+// Wavelet stage: Haar MODWT of each axis and the classical wavelet variance of its coefficients.
+// The confidence intervals use R's quantile functions and are left to the calling thread.
+void batch_wvar_worker(mpmc_queue<batch_job*>& decoded, mpmc_queue<batch_job*>& ready,
+                       std::atomic<unsigned int>& decoders_left, unsigned int nlevels, bool robust,
+                       const std::atomic<bool>& cancel){
+  for(;;){
+    batch_job* job;
+
+    unsigned int spins = 0;
+    for(;;){
+      if(decoded.try_pop(job)){
+        break;
+      }
+      // Once the decoders are done, everything they queued is visible: drain it, then stop
+      if(decoders_left.load() == 0){
+        if(decoded.try_pop(job)){
+          break;
+        }
+        return;
+      }
+      if(cancel.load()){
+        return;
+      }
+      backoff(spins);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    if(!job->failed){
+      try{
+        unsigned int mlevels = floor(log2(double(job->n)));
+        unsigned int J = (nlevels == 0) ? mlevels : nlevels;
+
+        if(J > mlevels){
+          throw std::runtime_error("`nlevels` must be less than or equal to the max number of levels of the file.");
+        }
+
+        for(unsigned int c = 0; c < 6; c++){
+          // Periodic boundary and a supported number of levels: modwt_cpp only fails here on the memory budget
+          arma::field<arma::vec> decomp = modwt_cpp(job->data.unsafe_col(c + 1), "haar", J, "periodic", true);
+
+          arma::vec wv(J), dims(J);
+          for(unsigned int j = 0; j < J; j++){
+            dims(j) = decomp(j).n_elem;
+            wv(j) = arma::dot(decomp(j), decomp(j))/dims(j);
+          }
+
+          job->wv(c) = wv;
+          job->dims(c) = dims;
+
+          // The robust estimator calls into R: keep the coefficients for the calling thread
+          if(robust){
+            job->decomp(c) = decomp;
+          }
+        }
+      }catch(std::exception& e){
+        job->failed = true;
+        job->message = e.what();
+      }catch(...){
+        job->failed = true;
+        job->message = "Unknown error while computing the wavelet variance.";
+      }
+    }
+
+    // The signal is no longer needed
+    job->data.reset();
+
+    job->t_wvar = seconds_since(start);
+
+    spins = 0;
+    while(!ready.try_push(job)){
+      if(cancel.load()){
+        return;
+      }
+      backoff(spins);
+    }
+  }
+}
+
+// Stops and joins the workers when leaving scope, including on error or user interrupt
+class batch_threads{
+public:
+  explicit batch_threads(std::atomic<bool>& cancel) : cancel(cancel) {}
+
+  ~batch_threads(){
+    cancel.store(true);
+    join();
+  }
+
+  void join(){
+    for(unsigned int i = 0; i < threads.size(); i++){
+      if(threads[i].joinable()){
+        threads[i].join();
+      }
+    }
+  }
+
+  std::vector<std::thread> threads;
+
+private:
+  std::atomic<bool>& cancel;
+};
+
+// Last stage, on the calling thread: confidence intervals and model fit of each axis
+void batch_fit(batch_job& job, const batch_options& opt){
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  try{
+    for(unsigned int c = 0; c < 6; c++){
+      if(opt.robust){
+        job.wvar(c) = wvar_cpp(job.decomp(c), true, opt.eff, opt.alpha, "eta3");
+        job.decomp(c).reset();
+      }else{
+        job.wvar(c) = ci_eta3(job.wv(c), job.dims(c), opt.alpha/2.0);
+      }
+    }
+
+    if(!opt.desc.empty()){
+      job.estimate.set_size(opt.theta.n_elem, 6);
+      job.obj_fun.set_size(6);
+
+      for(unsigned int c = 0; c < 6; c++){
+        arma::mat wvar = job.wvar(c);
+        arma::mat omega = arma::diagmat(1.0/arma::square(wvar.col(2) - wvar.col(1)));
+
+        arma::field<arma::mat> fit = gmwm_master_wv_cpp(wvar, job.n, job.expect_diff(c), omega, job.ranged(c),
+                                                        opt.theta, opt.desc, opt.objdesc, opt.model_type,
+                                                        opt.starting, opt.alpha, opt.compute_v,
+                                                        opt.K, opt.H, opt.G, opt.robust, opt.eff);
+        job.estimate.col(c) = fit(0);
+        job.obj_fun(c) = arma::as_scalar(fit(10));
+      }
+    }
+  }catch(std::exception& e){
+    job.failed = true;
+    job.message = e.what();
+  }
+
+  job.t_fit = seconds_since(start);
+}
+
+// Result record of a file
+Rcpp::List batch_record(const batch_job& job){
+  return Rcpp::List::create(Rcpp::_["file"] = job.file,
+                            Rcpp::_["status"] = job.failed ? "error" : "ok",
+                            Rcpp::_["message"] = job.message,
+                            Rcpp::_["freq"] = job.fIMU,
+                            Rcpp::_["n"] = double(job.n),
+                            Rcpp::_["scale"] = Rcpp::NumericVector::create(job.layout->scale_gyro,
+                                                                           job.layout->scale_acc),
+                            Rcpp::_["wvar"] = job.failed ? R_NilValue : Rcpp::wrap(job.wvar),
+                            Rcpp::_["estimate"] = job.failed || job.estimate.is_empty() ? R_NilValue : Rcpp::wrap(job.estimate),
+                            Rcpp::_["obj.fun"] = job.failed || job.obj_fun.is_empty() ? R_NilValue : Rcpp::wrap(job.obj_fun),
+                            Rcpp::_["timings"] = Rcpp::NumericVector::create(Rcpp::_["decode"] = job.t_decode,
+                                                                             Rcpp::_["wvar"] = job.t_wvar,
+                                                                             Rcpp::_["fit"] = job.t_fit));
+}
+
+// Runs the three stages over all files:
+//
+//   decode (decode_threads) -> queue -> wavelet variance (wvar_threads) -> queue -> fit (calling thread)
+//
+// Each queue holds queue_size files rounded up to a power of 2 of at least 2, so a slow stage stalls
+// the ones before it instead of accumulating decoded signals. The fit stays on the calling thread since the optimizer and the
+// quantile functions call into R. Files are fitted in the order supplied so that the results do
+// not depend on the scheduling of the workers (the starting values use R's RNG).
+//
+// The files finished out of order wait in done[] for the ones before them. The queues alone do not
+// bound them, so the decoders only start a file within the window of the next file to fit: at most
+// 2*queue_size + decode_threads + wvar_threads files are held at once, in done[] included.
+Rcpp::List batch_imu_pipeline(std::vector<batch_job>& jobs, const batch_options& opt){
+
+  std::atomic<bool> cancel(false);
+  std::atomic<unsigned int> next_file(0);
+  std::atomic<unsigned int> decoders_left(opt.decode_threads);
+
+  mpmc_queue<batch_job*> decoded(opt.queue_size);
+  mpmc_queue<batch_job*> ready(opt.queue_size);
+
+  std::vector<batch_job*> done(jobs.size(), (batch_job*)NULL);
+  std::atomic<unsigned int> next_fit(0);
+  unsigned int window = 2*opt.queue_size + opt.decode_threads + opt.wvar_threads;
+
+  {
+    batch_threads workers(cancel);
+
+    for(unsigned int i = 0; i < opt.decode_threads; i++){
+      workers.threads.push_back(std::thread([&](){
+        batch_decode_worker(jobs, next_file, next_fit, window, decoded, cancel);
+        decoders_left.fetch_sub(1);
+      }));
+    }
+
+    for(unsigned int i = 0; i < opt.wvar_threads; i++){
+      workers.threads.push_back(std::thread(batch_wvar_worker, std::ref(decoded), std::ref(ready),
+                                            std::ref(decoders_left), opt.nlevels, opt.robust,
+                                            std::cref(cancel)));
+    }
+
+    unsigned int spins = 0, polls = 0;
+    while(next_fit < jobs.size()){
+      batch_job* job;
+      if(ready.try_pop(job)){
+        done[job->index] = job;
+        spins = 0;
+      }else{
+        backoff(spins);
+
+        // Allow the user to interrupt: the workers are stopped when leaving scope
+        if(++polls % 256 == 0){
+          Rcpp::checkUserInterrupt();
+        }
+      }
+
+      while(next_fit < jobs.size() && done[next_fit] != NULL){
+        batch_job& job = *done[next_fit];
+        if(!job.failed){
+          batch_fit(job, opt);
+        }
+
+        // Only the robust estimator consumes the coefficients; a failure may have left some behind
+        job.decomp.reset();
+
+        // Lets the decoders start one more file
+        next_fit++;
+      }
+    }
+
+    workers.join();
+  }
+
+  Rcpp::List out(jobs.size());
+  for(unsigned int i = 0; i < jobs.size(); i++){
+    out[i] = batch_record(jobs[i]);
+  }
+
+  return out;
+}
+
+//' @title Batch Characterization of IMU Binary Files
+//'
+//' @description
+//' Reads a set of binary IMU files, computes the wavelet variance of each sensor and optionally
+//' fits a model to each of them, overlapping the reading of files with the computations.
+//'
+//' @param file_paths     A \code{vector} of \code{string} with the full path of each file.
+//' @param imu_types      A \code{list} with either one IMU type (see \code{\link{read_imu}}) or \code{\link{imu_layout}}
+//' for all files or one per file.
+//' @param nlevels        An \code{integer} indicating the number of decomposition levels. Use 0 for the max number of levels of each file.
+//' @param theta          A \code{vec} with dimensions N x 1 that contains user-supplied initial values for parameters
+//' @param desc           A \code{vector<string>} indicating the models that should be considered. Leave empty to only compute the wavelet variance.
+//' @param objdesc        A \code{field<vec>} containing a list of parameters (e.g. AR(1) = c(1,1), ARMA(p,q) = c(p,q,1))
+//' @param model_type     A \code{string} that represents the model transformation
+//' @param starting       A \code{bool} that indicates whether the supplied values are guessed (T) or are user-based (F).
+//' @param alpha          A \code{double} that handles the alpha level of the confidence interval (1-alpha)*100
+//' @param compute_v      A \code{string} that describes what kind of covariance matrix should be computed.
+//' @param K              An \code{int} that controls how many times theta is updated.
+//' @param H              An \code{int} that controls how many bootstrap replications are done.
+//' @param G              An \code{int} that controls how many guesses at different parameters are made.
+//' @param robust         A \code{bool} that indicates whether the estimation should be robust or not.
+//' @param eff            A \code{double} that specifies the amount of efficiency required by the robust estimator.
+//' @param decode_threads An \code{integer} giving the number of threads reading and decoding files.
+//' @param wvar_threads   An \code{integer} giving the number of threads computing wavelet variances.
+//' @param queue_size     An \code{integer} giving the number of files each queue between two stages can hold, rounded up
+//' to a power of 2 of at least 2.
+//' @return A \code{list} with one record per file containing:
+//' \describe{
+//' \item{file}{The path of the file}
+//' \item{status}{Either \code{"ok"} or \code{"error"}}
+//' \item{message}{The error message, if any}
+//' \item{freq}{The data rate of the file}
+//' \item{n}{The number of epochs}
+//' \item{scale}{The gyroscope and accelerometer scales}
+//' \item{wvar}{A \code{field<mat>} with the wavelet variance of each sensor, as in \code{\link{modwt_wvar_cpp}}}
+//' \item{estimate}{A \code{matrix} with the estimates of each sensor by column, if a model was supplied}
+//' \item{obj.fun}{The value of the objective function of each sensor, if a model was supplied}
+//' \item{timings}{The time in seconds spent decoding, computing the wavelet variance and fitting}
+//' }
+//' @details
+//' The work is split into three stages connected by bounded lock-free queues. Files are claimed by
+//' \code{decode_threads} threads that memory-map and decode them, then \code{wvar_threads} threads compute the
+//' Haar MODWT wavelet variance of each sensor and the calling thread computes the confidence intervals and fits
+//' the model. When a queue is full the stage feeding it waits. Model fitting uses R and therefore always
+//' runs on the calling thread, in the order of \code{file_paths}, and a file is only read once it is fewer
+//' than \code{2*queue_size + decode_threads + wvar_threads} files ahead of the next file to fit, which bounds
+//' the memory to that many files even when the wavelet stage finishes them out of order.
+//'
+//' An error in one file is reported in its record and does not stop the other files.
+//' @keywords internal
+// [[Rcpp::export]]
+Rcpp::List batch_imu_cpp(std::vector<std::string> file_paths, Rcpp::List imu_types, unsigned int nlevels,
+                         arma::vec theta,
+                         const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc,
+                         std::string model_type, bool starting = true, double alpha = 0.05,
+                         std::string compute_v = "fast", unsigned int K = 1, unsigned int H = 100,
+                         unsigned int G = 1000, bool robust = false, double eff = 0.6,
+                         unsigned int decode_threads = 2, unsigned int wvar_threads = 2,
+                         unsigned int queue_size = 4){
+
+  if(imu_types.size() != 1 && imu_types.size() != (int)file_paths.size()){
+    Rcpp::stop("Supply either one IMU type for all files or one per file.");
+  }
+
+  if(decode_threads == 0 || wvar_threads == 0 || queue_size == 0){
+    Rcpp::stop("The number of threads of each stage and the size of the queues must be positive.");
+  }
+
+  // Layouts are resolved here since they may come from R
+  std::vector<imu_layout> layouts(imu_types.size());
+  for(unsigned int i = 0; i < layouts.size(); i++){
+    layouts[i] = resolve_imu_layout(imu_types[i]);
+  }
+
+  std::vector<batch_job> jobs(file_paths.size());
+  for(unsigned int i = 0; i < jobs.size(); i++){
+    jobs[i].index = i;
+    jobs[i].file = file_paths[i];
+    jobs[i].layout = &layouts[layouts.size() == 1 ? 0 : i];
+  }
+
+  batch_options opt;
+  opt.nlevels = nlevels;
+  opt.alpha = alpha;
+  opt.robust = robust;
+  opt.eff = eff;
+  opt.theta = theta;
+  opt.desc = desc;
+  opt.objdesc = objdesc;
+  opt.model_type = model_type;
+  opt.starting = starting;
+  opt.compute_v = compute_v;
+  opt.K = K;
+  opt.H = H;
+  opt.G = G;
+  opt.decode_threads = decode_threads;
+  opt.wvar_threads = wvar_threads;
+  opt.queue_size = queue_size;
+
+  return batch_imu_pipeline(jobs, opt);
+}
+
+/* --------------------- End Batch IMU Pipeline ---------------------- */
@@ -0,0 +1,72 @@
+#ifndef BATCH_PIPELINE
+#define BATCH_PIPELINE
+
+// State of a file as it moves through the stages of the batch pipeline
+struct batch_job{
+  batch_job() : index(0), layout(NULL), fIMU(0), n(0), expect_diff(6), ranged(6),
+                wv(6), dims(6), decomp(6), wvar(6), failed(false),
+                t_decode(0), t_wvar(0), t_fit(0) {}
+
+  unsigned int index;
+  std::string file;
+  const imu_layout* layout;
+
+  // Decode stage
+  arma::mat data;
+  double fIMU;
+  arma::uword n;
+  arma::vec expect_diff;
+  arma::vec ranged;
+
+  // Wavelet variance stage (decomp is only kept for the robust estimator)
+  arma::field<arma::vec> wv;
+  arma::field<arma::vec> dims;
+  arma::field< arma::field<arma::vec> > decomp;
+
+  // Fit stage
+  arma::field<arma::mat> wvar;
+  arma::mat estimate;
+  arma::vec obj_fun;
+
+  bool failed;
+  std::string message;
+
+  double t_decode;
+  double t_wvar;
+  double t_fit;
+};
+
+// Settings shared by all files of a batch
+struct batch_options{
+  unsigned int nlevels;
+  double alpha;
+  bool robust;
+  double eff;
+
+  arma::vec theta;
+  std::vector<std::string> desc;
+  arma::field<arma::vec> objdesc;
+  std::string model_type;
+  bool starting;
+  std::string compute_v;
+  unsigned int K;
+  unsigned int H;
+  unsigned int G;
+
+  unsigned int decode_threads;
+  unsigned int wvar_threads;
+  unsigned int queue_size;
+};
+
+Rcpp::List batch_imu_pipeline(std::vector<batch_job>& jobs, const batch_options& opt);
+
+Rcpp::List batch_imu_cpp(std::vector<std::string> file_paths, Rcpp::List imu_types, unsigned int nlevels,
+                         arma::vec theta,
+                         const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc,
+                         std::string model_type, bool starting, double alpha,
+                         std::string compute_v, unsigned int K, unsigned int H,
+                         unsigned int G, bool robust, double eff,
+                         unsigned int decode_threads, unsigned int wvar_threads,
+                         unsigned int queue_size);
+
+#endif
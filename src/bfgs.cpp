@@ -0,0 +1,132 @@
+#include <RcppArmadillo.h>
+
+#include "bfgs.h"
+
+/* ----------------------- Start BFGS ------------------------ */
+
+// Variable metric minimisation with a backtracking line search.
+// This is a port of vmmin, the "BFGS" method of optim, using the same constants and
+// stopping rules. It does not use the R API, so it can run on any thread.
+bfgs_result bfgs_min(differentiable_function& f, const arma::vec& start,
+                     unsigned int maxit, double reltol){
+
+  const double stepredn = 0.2;
+  const double acctol = 0.0001;
+  const double reltest = 10.0;
+
+  unsigned int n = start.n_elem;
+
+  bfgs_result res;
+  res.par = start;
+  res.iterations = 0;
+  res.converged = false;
+
+  arma::vec& b = res.par;
+
+  double fmin = f.value(b);
+  res.value = fmin;
+  if(!arma::is_finite(fmin) || n == 0){
+    res.converged = (n == 0);
+    return res;
+  }
+
+  arma::vec g(n);
+  f.gradient(b, g);
+
+  unsigned int gradcount = 1;
+  unsigned int ilast = gradcount;
+  unsigned int iter = 1;
+  unsigned int count = 0;
+
+  arma::mat B(n, n);
+  arma::vec X(n), c(n), t(n);
+
+  do{
+    if(ilast == gradcount){
+      B.eye();
+    }
+
+    X = b;
+    c = g;
+
+    t = -B*g;
+    double gradproj = arma::dot(t, g);
+
+    if(gradproj < 0.0){
+      double steplength = 1.0;
+      bool accpoint = false;
+      double fval = fmin;
+
+      do{
+        count = 0;
+        for(unsigned int i = 0; i < n; i++){
+          b(i) = X(i) + steplength*t(i);
+          if(reltest + X(i) == reltest + b(i)){
+            count++;
+          }
+        }
+
+        if(count < n){
+          fval = f.value(b);
+          accpoint = arma::is_finite(fval) && (fval <= fmin + gradproj*steplength*acctol);
+          if(!accpoint){
+            steplength *= stepredn;
+          }
+        }
+      }while(!(count == n || accpoint));
+
+      bool enough = std::fabs(fval - fmin) > reltol*(std::fabs(fmin) + reltol);
+      if(!enough){
+        count = n;
+        fmin = fval;
+      }
+
+      if(count < n){
+        fmin = fval;
+        f.gradient(b, g);
+        gradcount++;
+        iter++;
+
+        t *= steplength;
+        c = g - c;
+        double D1 = arma::dot(t, c);
+
+        if(D1 > 0){
+          X = B*c;
+          double D2 = 1.0 + arma::dot(X, c)/D1;
+          B += (D2*(t*t.t()) - X*t.t() - t*X.t())/D1;
+        }else{
+          ilast = gradcount;
+        }
+      }else{
+        if(ilast < gradcount){
+          count = 0;
+          ilast = gradcount;
+        }
+      }
+    }else{
+      count = 0;
+      if(ilast == gradcount){
+        count = n;
+      }else{
+        ilast = gradcount;
+      }
+    }
+
+    if(iter >= maxit){
+      break;
+    }
+
+    if(gradcount - ilast > 2*n){
+      ilast = gradcount;
+    }
+  }while(count != n || ilast != gradcount);
+
+  res.value = fmin;
+  res.iterations = iter;
+  res.converged = iter < maxit;
+
+  return res;
+}
+
+/* ------------------------ End BFGS ------------------------- */
@@ -0,0 +1,25 @@
+#ifndef BFGS_H
+#define BFGS_H
+
+// Function minimised by bfgs_min
+class differentiable_function{
+public:
+  virtual ~differentiable_function() {}
+
+  virtual double value(const arma::vec& x) = 0;
+
+  // Gradient at the point of the last call to value
+  virtual void gradient(const arma::vec& x, arma::vec& g) = 0;
+};
+
+struct bfgs_result{
+  arma::vec par;
+  double value;
+  unsigned int iterations;
+  bool converged;
+};
+
+bfgs_result bfgs_min(differentiable_function& f, const arma::vec& start,
+                     unsigned int maxit = 100, double reltol = 1.490116119384765625e-8);
+
+#endif
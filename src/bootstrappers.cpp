@@ -42,6 +42,17 @@
 // Covariance matrix
 #include "covariance_matrix.h"
 
+// Times the bootstraps, counts the replicates and charges their workspace
+#include "gmwm_memory.h"
+#include "gmwm_profile.h"
+#include "gmwm_trace.h"
+
+// Bytes of the workspace of a bootstrap: a replicate series of N observations and k statistics kept
+// for each of the H replicates. The MODWT of each replicate is charged by modwt_cpp.
+static double bootstrap_workspace(unsigned int N, unsigned int H, double k){
+  return memory_doubles(N + H*k);
+}
+
 //' @title Bootstrap for Matrix V
 //' @description Using the bootstrap approach, we simulate a model based on user supplied parameters, obtain the wavelet variance, and then V.
 //' @param theta A \code{vector} with dimensions N x 1 that contains user-supplied initial values for parameters
@@ -59,16 +70,23 @@ arma::mat cov_bootstrapper(const arma::vec&  theta,
                            const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc,
                            unsigned int N, bool robust, double eff,
                            unsigned int H, bool diagonal_matrix){
+  profile_timer timer(STAGE_BOOTSTRAP);
+  profile_count(COUNT_BOOTSTRAP_REPLICATES, H);
+  
   unsigned int nb_level = floor(log2(N));
   
+  memory_charge workspace(MEMORY_BOOTSTRAP, bootstrap_workspace(N, H, nb_level), "cov_bootstrapper");
+  
   arma::mat res(nb_level, H);
   for(unsigned int i=0; i<H; i++){
+    trace_scope trace("bootstrap_replicate", "bootstrap", i);
     
     // Generate x_t ~ F_theta
     arma::vec x = gen_model(N, theta, desc, objdesc);
     
     // MODWT transform
     arma::field<arma::vec> signal_modwt_bw = modwt_cpp(x, "haar", nb_level, "periodic", true);
+    memory_charge coefficients(MEMORY_MODWT, decomposition_bytes(signal_modwt_bw));
     
     // Obtain WV
     arma::vec wv_x = wave_variance(signal_modwt_bw, robust, eff);
@@ -106,13 +124,19 @@ arma::mat optimism_bootstrapper(const arma::vec&  theta,
                                 const arma::vec& scales, std::string model_type, 
                                 unsigned int N, bool robust, double eff, double alpha,
                                 unsigned int H){
+  profile_timer timer(STAGE_BOOTSTRAP);
+  profile_count(COUNT_BOOTSTRAP_REPLICATES, H);
+  
   unsigned int nb_level = floor(log2(N));
   
+  memory_charge workspace(MEMORY_BOOTSTRAP, bootstrap_workspace(N, H, 2*nb_level), "optimism_bootstrapper");
+  
   arma::mat theo(nb_level, H);
   
   arma::mat all_wv_empir(nb_level, H);
   
   for(unsigned int i=0; i<H; i++){
+    trace_scope trace("bootstrap_replicate", "bootstrap", i);
     
     // Generate x_t ~ F_theta
     arma::vec x = gen_model(N, theta, desc, objdesc);
@@ -163,8 +187,13 @@ arma::field<arma::mat> opt_n_gof_bootstrapper(const arma::vec&  theta,
                                               const arma::vec& scales, std::string model_type, 
                                               unsigned int N, bool robust, double eff, double alpha,
                                               unsigned int H){
+  profile_timer timer(STAGE_BOOTSTRAP);
+  profile_count(COUNT_BOOTSTRAP_REPLICATES, H);
+  
   unsigned int nb_level = floor(log2(N));
   
+  memory_charge workspace(MEMORY_BOOTSTRAP, bootstrap_workspace(N, H, 2*nb_level + 1), "opt_n_gof_bootstrapper");
+  
   unsigned int p = theta.n_elem;
   
   arma::mat theo(nb_level, H);
@@ -174,6 +203,7 @@ arma::field<arma::mat> opt_n_gof_bootstrapper(const arma::vec&  theta,
   arma::vec obj_values(H);
   
   for(unsigned int i=0; i<H; i++){
+    trace_scope trace("bootstrap_replicate", "bootstrap", i);
     
     // Generate x_t ~ F_theta
     arma::vec x = gen_model(N, theta, desc, objdesc);
@@ -248,12 +278,18 @@ arma::vec gmwm_sd_bootstrapper(const arma::vec&  theta,
                                const arma::vec& scales, std::string model_type,
                                unsigned int N, bool robust, double eff, double alpha,
                                unsigned int H){
+  profile_timer timer(STAGE_BOOTSTRAP);
+  profile_count(COUNT_BOOTSTRAP_REPLICATES, H);
+  
   unsigned int nb_level = floor(log2(N));
   
   unsigned int p = theta.n_elem;
   
+  memory_charge workspace(MEMORY_BOOTSTRAP, bootstrap_workspace(N, H, p), "gmwm_sd_bootstrapper");
+  
   arma::mat mest(H, p);
   for(unsigned int i=0; i<H; i++){
+    trace_scope trace("bootstrap_replicate", "bootstrap", i);
     
     // Generate x_t ~ F_theta
     arma::vec x = gen_model(N, theta, desc, objdesc);
@@ -331,10 +367,15 @@ arma::field<arma::mat> gmwm_param_bootstrapper(const arma::vec&  theta,
                                                const arma::vec& scales, std::string model_type,
                                                unsigned int N, bool robust, double eff, double alpha,
                                                unsigned int H){
+  profile_timer timer(STAGE_BOOTSTRAP);
+  profile_count(COUNT_BOOTSTRAP_REPLICATES, H);
+  
   unsigned int nb_level = floor(log2(N));
   
   unsigned int p = theta.n_elem;
   
+  memory_charge workspace(MEMORY_BOOTSTRAP, bootstrap_workspace(N, H, p + 2*nb_level + 1), "gmwm_param_bootstrapper");
+  
   arma::mat mest(p, H);
   
   arma::mat theo(nb_level, H);
@@ -344,6 +385,7 @@ arma::field<arma::mat> gmwm_param_bootstrapper(const arma::vec&  theta,
   arma::vec obj_values(H);
   
   for(unsigned int i=0; i<H; i++){
+    trace_scope trace("bootstrap_replicate", "bootstrap", i);
     
     // Generate x_t ~ F_theta
     arma::vec x = gen_model(N, theta, desc, objdesc);
@@ -391,10 +433,15 @@ arma::field<arma::mat> all_bootstrapper(const arma::vec&  theta,
                                         const arma::vec& scales, std::string model_type, 
                                         unsigned int N, bool robust, double eff, double alpha,
                                         unsigned int H){
+  profile_timer timer(STAGE_BOOTSTRAP);
+  profile_count(COUNT_BOOTSTRAP_REPLICATES, H);
+  
   unsigned int nb_level = floor(log2(N));
   
   unsigned int p = theta.n_elem;
   
+  memory_charge workspace(MEMORY_BOOTSTRAP, bootstrap_workspace(N, H, p + 2*nb_level + 1), "all_bootstrapper");
+  
   arma::mat mest(p, H);
   
   arma::mat theo(nb_level, H);
@@ -404,6 +451,7 @@ arma::field<arma::mat> all_bootstrapper(const arma::vec&  theta,
   arma::vec obj_values(H);
   
   for(unsigned int i=0; i<H; i++){
+    trace_scope trace("bootstrap_replicate", "bootstrap", i);
     
     // Generate x_t ~ F_theta
     arma::vec x = gen_model(N, theta, desc, objdesc);
@@ -18,7 +18,7 @@
 //' V = compute_cov_cpp(decomp$data, decomp$nlevels, compute_v="diag", robust = TRUE, eff=0.6)
 //' }
 // [[Rcpp::export]]
-arma::field<arma::mat> compute_cov_cpp(arma::field<arma::vec> signal_modwt, unsigned int nb_level, 
+arma::field<arma::mat> compute_cov_cpp(const arma::field<arma::vec>& signal_modwt, unsigned int nb_level, 
                                         std::string compute_v="diag",
                                         bool robust = true, double eff=0.6){// Compute asymptotic covariance matrix
   arma::field<arma::mat> V(2);
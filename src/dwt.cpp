@@ -7,6 +7,11 @@
 // We use reverse vec
 #include "armadillo_manipulations.h"
 
+// Times the MODWT and charges its coefficients
+#include "gmwm_memory.h"
+#include "gmwm_profile.h"
+#include "gmwm_trace.h"
+
 /* --------------------- Start DWT and MODWT Functions --------------------- */
 
 
@@ -27,21 +32,24 @@
 //' x = rnorm(2^8)
 //' dwt_cpp(x, filter_name = "haar", nlevels = 4, boundary = "periodic", brickwall = TRUE)
 // [[Rcpp::export]]
-arma::field<arma::vec> dwt_cpp(arma::vec x, std::string filter_name, 
+arma::field<arma::vec> dwt_cpp(const arma::vec& x, std::string filter_name, 
                                    unsigned int nlevels, std::string boundary, bool brickwall) {
-                                     
+  
+  // The signal is only copied when it must be extended
+  arma::vec reflected;
   if(boundary == "periodic"){
     //
   }else if(boundary == "reflection"){
-    unsigned int temp_N = x.n_elem;
-    arma::vec rev_vec = reverse_vec(x);
-    x.resize(2*temp_N);
-    x.rows(temp_N, 2*temp_N-1) = rev_vec;
+    reflected = arma::join_cols(x, reverse_vec(x));
   }else{
       Rcpp::stop("The supplied 'boundary' argument is not supported! Choose either periodic or reflection."); 
   }
+  
+  // Series decomposed at the current level: the signal, then the scaling coefficients
+  const arma::vec* px = (boundary == "reflection") ? &reflected : &x;
+  arma::vec v;
 
-  unsigned int N = x.n_elem;
+  unsigned int N = px->n_elem;
   
   unsigned int J = nlevels;
   
@@ -70,20 +78,22 @@ arma::field<arma::vec> dwt_cpp(arma::vec x, std::string filter_name,
     arma::vec Wj(M_over_2);
     arma::vec Vj(M_over_2);
     
+    const arma::vec& xj = *px;
+    
     for(unsigned t = 0; t < M_over_2; t++) {
       
       int u = 2*t + 1;
 
-      double Wjt = h(0)*x(u);
-      double Vjt = g(0)*x(u);
+      double Wjt = h(0)*xj(u);
+      double Vjt = g(0)*xj(u);
       
       for(int n = 1; n < L; n++){
         u -= 1;
         if(u < 0){
           u = M - 1;
         } 
-        Wjt += h(n)*x(u);
-        Vjt += g(n)*x(u);
+        Wjt += h(n)*xj(u);
+        Vjt += g(n)*xj(u);
       }
       
       Wj[t] = Wjt;
@@ -91,13 +101,14 @@ arma::field<arma::vec> dwt_cpp(arma::vec x, std::string filter_name,
     }
     
     y(j-1) = Wj;
-    x = Vj;
+    v.swap(Vj);
+    px = &v;
   }
   
   
   // Apply brickwall
   if(brickwall){
-    y = brick_wall(y, filter_info, "dwt");
+    brick_wall_inplace(y, filter_info, "dwt");
   }
   
   return y;
@@ -122,27 +133,37 @@ arma::field<arma::vec> dwt_cpp(arma::vec x, std::string filter_name,
 //' x = rnorm(100)
 //' modwt_cpp(x, filter_name = "haar", nlevels = 4, boundary = "periodic", brickwall = TRUE)
 // [[Rcpp::export]]
-arma::field<arma::vec> modwt_cpp(arma::vec x, std::string filter_name, 
+arma::field<arma::vec> modwt_cpp(const arma::vec& x, std::string filter_name, 
                                    unsigned int nlevels, std::string boundary, bool brickwall){
   
-  if(boundary == "periodic"){
-    //
-  }else if(boundary == "reflection"){
-    unsigned int temp_N = x.n_elem;
-    arma::vec rev_vec = reverse_vec(x);
-    x.resize(2*temp_N);
-    x.rows(temp_N, 2*temp_N-1) = rev_vec;
-  }else{
+  profile_timer timer(STAGE_MODWT);
+  trace_scope trace("modwt_cpp", "wv");
+  
+  if(boundary != "periodic" && boundary != "reflection"){
     Rcpp::stop("The supplied 'boundary' argument is not supported! Choose either periodic or reflection."); 
   }
-
-  unsigned int N = x.n_elem;
+  bool reflect = boundary == "reflection";
+  
+  unsigned int N = reflect ? 2*x.n_elem : x.n_elem;
   
   unsigned int J = nlevels;
   
   unsigned int tau = pow(2.0,double(J));
   
   if(tau > N) Rcpp::stop("The number of levels [ 2^(nlevels) ] exceeds sample size ('x'). Supply a lower number of levels.");
+  
+  // Coefficients of each level and the two series being filtered, plus the extended signal
+  memory_charge coefficients(MEMORY_MODWT, memory_doubles(double(N)*(J + 2) + (reflect ? N : 0)), "modwt_cpp");
+  
+  // The signal is only copied when it must be extended
+  arma::vec reflected;
+  if(reflect){
+    reflected = arma::join_cols(x, reverse_vec(x));
+  }
+  
+  // Series decomposed at the current level: the signal, then the scaling coefficients
+  const arma::vec* px = reflect ? &reflected : &x;
+  arma::vec v;
 
   arma::field<arma::vec> filter_info = select_filter(filter_name);
   
@@ -161,20 +182,22 @@ arma::field<arma::vec> modwt_cpp(arma::vec x, std::string filter_name,
   arma::vec Vj(N);
   
   for(unsigned int j = 1; j <= J; j++) {
+    const arma::vec& xj = *px;
+    
     for(unsigned t = 0; t < N; t++) {
       
       int k = t;
 
-      double Wjt = ht(0)*x(k);
-      double Vjt = gt(0)*x(k);
+      double Wjt = ht(0)*xj(k);
+      double Vjt = gt(0)*xj(k);
   
       for(int n = 1; n < L; n++){
         k -= pow(2.0, double(j)-1.0);
         if(k < 0){
           k += N;
         } 
-        Wjt += ht(n)*x(k);
-        Vjt += gt(n)*x(k);
+        Wjt += ht(n)*xj(k);
+        Vjt += gt(n)*xj(k);
       }
       
       Wj[t] = Wjt;
@@ -182,18 +205,30 @@ arma::field<arma::vec> modwt_cpp(arma::vec x, std::string filter_name,
     }
     
     y(j-1) = Wj;
-    x = Vj;
+    v.swap(Vj);
+    Vj.set_size(N);
+    px = &v;
   }
   
   // Apply brickwall
   if(brickwall){
-   y = brick_wall(y, filter_info, "modwt");
+    brick_wall_inplace(y, filter_info, "modwt");
   }
   
   return y;
 }
 
 
+// Bytes held by the coefficients of a decomposition
+double decomposition_bytes(const arma::field<arma::vec>& decomp){
+  double n = 0;
+  for(unsigned int j = 0; j < decomp.n_elem; j++){
+    n += decomp(j).n_elem;
+  }
+  return memory_doubles(n);
+}
+
+
 //' @title Removal of Boundary Wavelet Coefficients
 //' @description Removes the first n wavelet coefficients.
 //' @param x           A \code{field<vec>} that contains the nlevel decomposition using either modwt or dwt.
@@ -210,9 +245,17 @@ arma::field<arma::vec> modwt_cpp(arma::vec x, std::string filter_name,
 //' me = modwt_cpp(x, filter_name = "haar", nlevels = 4, boundary = "periodic", brickwall = FALSE)
 //' brick_wall(me, select_filter("haar"), "modwt")
 // [[Rcpp::export]]
-arma::field<arma::vec> brick_wall(arma::field<arma::vec> x,  
-                                  arma::field<arma::vec> wave_filter, 
+arma::field<arma::vec> brick_wall(const arma::field<arma::vec>& x,  
+                                  const arma::field<arma::vec>& wave_filter, 
                                   std::string method) 
+{
+    arma::field<arma::vec> out = x;
+    brick_wall_inplace(out, wave_filter, method);
+    return out;
+}
+
+// Removes the boundary coefficients of a decomposition without copying it.
+void brick_wall_inplace(arma::field<arma::vec>& x, const arma::field<arma::vec>& wave_filter, const std::string& method)
 {
     int m = as_scalar(wave_filter(0));
 
@@ -225,19 +268,18 @@ arma::field<arma::vec> brick_wall(arma::field<arma::vec> x,
         if (method == "dwt"){
             n = ceil((m - 2.0) * (1.0 - 1.0/binary_power));
         }
-        arma::vec temp = x(j);
-        int temp_size = temp.n_elem - 1; // numbers are 0,...,(N-1)
+        int temp_size = x(j).n_elem - 1; // numbers are 0,...,(N-1)
         n = std::min(n, temp_size);
         
         // Addresses the case where all scales are removed.
-        if(n != temp_size){        
-          x(j) = temp.rows(n,temp_size);
+        if(n != temp_size){
+          if(n > 0){
+            x(j).shed_rows(0, n-1);
+          }
         }else{
-          x(j) = arma::zeros<arma::vec>(0);
+          x(j).reset();
         }
     }
-    
-    return x;
 }
 
 
@@ -1,13 +1,18 @@
 #ifndef DWT
 #define DWT
 
-arma::field<arma::vec> brick_wall(arma::field<arma::vec> x,  
-                                  arma::field<arma::vec> wave_filter, 
+arma::field<arma::vec> brick_wall(const arma::field<arma::vec>& x,  
+                                  const arma::field<arma::vec>& wave_filter, 
                                   std::string method = "modwt") ;
 
-arma::field<arma::vec> dwt_cpp(arma::vec x, std::string filter_name = "haar", 
+void brick_wall_inplace(arma::field<arma::vec>& x, const arma::field<arma::vec>& wave_filter, const std::string& method);
+
+arma::field<arma::vec> dwt_cpp(const arma::vec& x, std::string filter_name = "haar", 
                                unsigned int nlevels = 4, std::string boundary = "periodic", bool brickwall = true);
                                  
-arma::field<arma::vec> modwt_cpp(arma::vec x, std::string filter_name = "haar", 
+arma::field<arma::vec> modwt_cpp(const arma::vec& x, std::string filter_name = "haar", 
                                  unsigned int nlevels = 4, std::string boundary = "periodic", bool brickwall = true);
+
+// Bytes held by the coefficients of a decomposition
+double decomposition_bytes(const arma::field<arma::vec>& decomp);
 #endif
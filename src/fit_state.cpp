@@ -0,0 +1,35 @@
+#include <RcppArmadillo.h>
+
+#include "fit_state.h"
+
+// Needed for derivative_first_matrix
+#include "analytical_matrix_derivatives.h"
+
+// Needed for theoretical_wv
+#include "process_to_wv.h"
+
+// Build the state of a fit whose theoretical WV and objective function are already known
+fit_state make_fit_state(const arma::vec& theta,
+                         const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc,
+                         const arma::mat& omega, const arma::vec& scales,
+                         const arma::vec& theo, double obj_value){
+  fit_state fit;
+  fit.theta = theta;
+  fit.omega = omega;
+  fit.theo = theo;
+  fit.A = derivative_first_matrix(theta, desc, objdesc, scales);
+  fit.at_omega = arma::trans(fit.A) * omega;
+  fit.obj_value = obj_value;
+
+  return fit;
+}
+
+// Build the state of a fit from its estimates alone
+fit_state make_fit_state(const arma::vec& theta,
+                         const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc,
+                         const arma::mat& omega, const arma::vec& wv_empir, const arma::vec& scales){
+  arma::vec theo = theoretical_wv(theta, desc, objdesc, scales);
+  arma::vec dif = theo - wv_empir;
+
+  return make_fit_state(theta, desc, objdesc, omega, scales, theo, arma::as_scalar(trans(dif)*omega*dif));
+}
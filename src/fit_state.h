@@ -0,0 +1,24 @@
+#ifndef FIT_STATE
+#define FIT_STATE
+
+// Quantities of a fitted GMWM model that the inference and model selection routines share,
+// computed once per fit instead of once per routine.
+struct fit_state{
+  arma::vec theta;        // Estimates
+  arma::mat omega;        // Weighting matrix of the fit
+  arma::vec theo;         // Theoretical WV at theta
+  arma::mat A;            // First derivatives of the theoretical WV at theta
+  arma::mat at_omega;     // A^T * omega
+  double obj_value;       // Objective function at theta
+};
+
+fit_state make_fit_state(const arma::vec& theta,
+                         const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc,
+                         const arma::mat& omega, const arma::vec& scales,
+                         const arma::vec& theo, double obj_value);
+
+fit_state make_fit_state(const arma::vec& theta,
+                         const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc,
+                         const arma::mat& omega, const arma::vec& wv_empir, const arma::vec& scales);
+
+#endif
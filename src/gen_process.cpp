@@ -11,6 +11,12 @@
 // Support for SARMA models
 #include "sarma.h"
 
+// Draws from the RNG of the context
+#include "gmwm_context.h"
+
+// Charges the processes of gen_lts_cpp
+#include "gmwm_memory.h"
+
 /* ------------------------------ START Individual Process Generation Functions ------------------------------ */
 
 //' Generate a Gaussian White Noise Process (WN(\eqn{\sigma ^2}{sigma^2}))
@@ -35,7 +41,7 @@ arma::vec gen_wn(const unsigned int N, const double sigma2 = 1)
   arma::vec wn(N);
   double sigma = sqrt(sigma2);
   for(unsigned int i = 0; i < N; i++){
-    wn(i) = R::rnorm(0.0, sigma);
+    wn(i) = rng_norm(0.0, sigma);
   }
   
   return wn;
@@ -103,7 +109,7 @@ arma::vec gen_qn(const unsigned int N, double q2 = .1)
   
   for(unsigned int i=0; i <= N; i++ )
   {		
-    gu(i) = sqrt12*R::runif(0.0,1.0);
+    gu(i) = sqrt12*rng_unif(0.0,1.0);
   }
   
   return sqrt(q2)*diff_cpp(gu);
@@ -167,7 +173,7 @@ arma::vec gen_rw(const unsigned int N, const double sigma2 = 1)
   arma::vec grw(N);
   double sigma = sqrt(sigma2);
   for(unsigned int i = 0; i < N; i++){
-      grw(i) = R::rnorm(0.0, sigma);
+      grw(i) = rng_norm(0.0, sigma);
   }
   return cumsum(grw);
 }
@@ -322,14 +328,14 @@ arma::vec gen_arma(const unsigned int N,
   
   // Generate Innovations
   for(i = 0; i < N; i++){
-    innov(i) = R::rnorm(0,sd);
+    innov(i) = rng_norm(0,sd);
   }
   
   // Generate Starting Innovations
   start_innov = arma::vec(n_start);
   
   for(i = 0; i < n_start; i++){
-    start_innov(i) = R::rnorm(0,sd);
+    start_innov(i) = rng_norm(0,sd);
   }
   
   // Combine
@@ -709,6 +715,10 @@ arma::vec gen_model(unsigned int N, const arma::vec& theta, const std::vector<st
 arma::mat gen_lts_cpp(unsigned int N, const arma::vec& theta, const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc){
   unsigned int i_theta = 0;
   unsigned int num_desc = desc.size();
+  
+  // Each process and their sum, plus the process being generated
+  memory_charge processes(MEMORY_SIMULATION, memory_doubles(double(N)*(num_desc + 2)), "gen_lts_cpp");
+  
   arma::mat x = arma::zeros<arma::mat>(N, num_desc+1);
   
   for(unsigned int i = 0; i < num_desc; i++){
@@ -812,7 +822,7 @@ arma::mat gen_lts_cpp(unsigned int N, const arma::vec& theta, const std::vector<
       // Apply a cap
       if(d > 0){ 
         temp = temp.rows(0,N-d-1); // delete extra from differencing. 
-        Rcpp::Rcout << "Warning: This is not an ideal generation function for difference! Observations truncated to length N!." << std::endl;
+        log_line() << "Warning: This is not an ideal generation function for difference! Observations truncated to length N!.";
       }
       
       // Modified arima.sim
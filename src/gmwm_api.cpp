@@ -0,0 +1,228 @@
+#include <RcppArmadillo.h>
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+
+// Public C++ interface
+#include "gmwm.h"
+
+#include "allan_variance.h"
+#include "automatic_models.h"
+#include "gen_process.h"
+#include "gmwm_logic.h"
+#include "hadamard_variance.h"
+#include "imu_layout.h"
+#include "mapped_file.h"
+#include "read_imu.h"
+#include "ts_model_cpp.h"
+#include "wave_variance.h"
+
+// Implements inst/include/gmwm.h over the functions behind the R interface.
+
+namespace gmwm{
+
+/* ------------------------- Helpers ------------------------- */
+
+// Default number of guesses of gmwm()
+static unsigned int default_guesses(unsigned int N){
+  return N > 10000 ? 1000000 : 20000;
+}
+
+static cluster_variance to_cluster_variance(const arma::mat& m){
+  cluster_variance out;
+  out.tau = m.col(0);
+  out.variance = m.col(1);
+  out.error = m.col(2);
+  return out;
+}
+
+// Fit laid out as the output of gmwm_master_cpp
+static fit_result to_fit_result(const arma::field<arma::mat>& out, const std::vector<std::string>& model){
+  fit_result res;
+  res.model = model;
+  res.theta = out(0);
+  res.starting = out(1);
+  res.wv_empir = out(2);
+  res.ci_low = out(3);
+  res.ci_high = out(4);
+  res.V = out(5);
+  res.wv_theo = out(8);
+  res.decomp_theo = out(9);
+  res.objective = arma::as_scalar(out(10));
+  res.omega = out(11);
+  return res;
+}
+
+// Records the profile of a call into its result while in scope, and adds it to the profile of the
+// caller's context, if that has one
+class profile_recorder{
+public:
+  explicit profile_recorder(gmwm_profile& out) : out(out), parent(current_context().profile),
+                                                 ctx(current_context()), scope(with_profile(ctx, out)) {}
+
+  ~profile_recorder(){
+    if(parent){
+      *parent += out;
+    }
+  }
+
+private:
+  gmwm_profile& out;
+  gmwm_profile* parent;
+  gmwm_context ctx;
+  gmwm_context_scope scope;
+
+  static gmwm_context& with_profile(gmwm_context& ctx, gmwm_profile& out){
+    out.reset();
+    ctx.profile = &out;
+    return ctx;
+  }
+
+  profile_recorder(const profile_recorder&);
+  profile_recorder& operator=(const profile_recorder&);
+};
+
+static void check_fit_options(const fit_options& opt){
+  if(opt.model_type != "imu" && opt.model_type != "ssm"){
+    throw std::invalid_argument("Model Type must be either `ssm` or `imu`!");
+  }
+  if(opt.compute_v != "fast" && opt.compute_v != "diag" && opt.compute_v != "full" && opt.compute_v != "bootstrap"){
+    throw std::invalid_argument("compute_v must be one of fast, diag, full or bootstrap.");
+  }
+}
+
+/* ------------------------- Wavelet Variance ------------------------- */
+
+wv_result wvar(const arma::vec& x, const wv_options& opt){
+  unsigned int nlevels = opt.nlevels ? opt.nlevels : (unsigned int)floor(log2(double(x.n_elem)));
+  if(x.n_elem < 2 || nlevels > floor(log2(double(x.n_elem)))){
+    throw std::invalid_argument("nlevels must be less than or equal to floor(log2(length(x))).");
+  }
+
+  wv_result res;
+  arma::mat wv;
+  {
+    profile_recorder recorder(res.profile);
+    wv = modwt_wvar_cpp(x, nlevels, opt.robust, opt.eff, opt.alpha, "eta3", "haar", "modwt");
+  }
+
+  res.scales = scales_cpp(nlevels);
+  res.variance = wv.col(0);
+  res.ci_low = wv.col(1);
+  res.ci_high = wv.col(2);
+  return res;
+}
+
+/* ------------------------- Allan and Hadamard Variances ------------------------- */
+
+cluster_variance avar(const arma::vec& x, bool overlap){
+  return to_cluster_variance(overlap ? avar_mo_cpp(x) : avar_to_cpp(x));
+}
+
+cluster_variance hadamard(const arma::vec& x, bool overlap){
+  return to_cluster_variance(overlap ? hadam_mo_cpp(x) : hadam_to_cpp(x));
+}
+
+/* ------------------------- GMWM ------------------------- */
+
+fit_result fit(const arma::vec& x, const std::vector<std::string>& model, const fit_options& opt){
+  check_fit_options(opt);
+
+  arma::field<arma::vec> objdesc = model_objdesc(model);
+  arma::vec theta = model_theta(model);
+
+  unsigned int np = theta.n_elem + (opt.robust ? 1 : 0);
+  if(np > floor(log2(double(x.n_elem)))){
+    throw std::invalid_argument("Please supply a longer signal / time series in order to use the GMWM.");
+  }
+
+  unsigned int G = opt.G ? opt.G : default_guesses(x.n_elem);
+
+  current_context().rng->seed(opt.seed);
+
+  gmwm_profile profile;
+  arma::field<arma::mat> out;
+  {
+    profile_recorder recorder(profile);
+    out = gmwm_master_cpp(x, theta, model, objdesc, opt.model_type, true, opt.alpha,
+                          opt.compute_v, opt.K, opt.H, G, opt.robust, opt.eff);
+  }
+
+  fit_result res = to_fit_result(out, model);
+  res.profile = profile;
+  return res;
+}
+
+/* ------------------------- Model Selection ------------------------- */
+
+selection_result select_model(const arma::vec& x, const std::vector<std::string>& full_model,
+                              std::vector< std::vector<std::string> > candidates,
+                              const fit_options& opt,
+                              const std::string& search, bool warm_start, bool bootstrap){
+  check_fit_options(opt);
+
+  if(candidates.empty()){
+    // Every non empty combination of the processes, keeping their order
+    unsigned int p = full_model.size();
+    for(unsigned long mask = 1; mask < (1ul << p); mask++){
+      std::vector<std::string> cand;
+      for(unsigned int j = 0; j < p; j++){
+        if(mask & (1ul << j)){
+          cand.push_back(full_model[j]);
+        }
+      }
+      candidates.push_back(cand);
+    }
+  }else if(std::find(candidates.begin(), candidates.end(), full_model) == candidates.end()){
+    candidates.push_back(full_model);
+  }
+
+  unsigned int G = opt.G ? opt.G : default_guesses(x.n_elem);
+
+  gmwm_profile profile;
+  arma::field< arma::field<arma::field<arma::mat> > > h;
+  {
+    profile_recorder recorder(profile);
+    h = rank_models_cpp(x, candidates, full_model, opt.alpha, opt.compute_v, opt.model_type,
+                        opt.K, opt.H, G, opt.robust, opt.eff, bootstrap, opt.seed, search, warm_start);
+  }
+
+  // Candidates are identified by their position in the set the selection ran over (1 based)
+  std::set< std::vector<std::string> > unique(candidates.begin(), candidates.end());
+  std::vector< std::vector<std::string> > ordered(unique.begin(), unique.end());
+
+  const arma::field<arma::mat>& ms = h(0)(0);
+
+  selection_result res;
+  res.scores = ms(0);
+  for(unsigned int i = 0; i < ms(1).n_elem; i++){
+    res.models.push_back(ordered[(unsigned int)ms(1)(i) - 1]);
+  }
+  res.best = to_fit_result(h(0)(1), res.models.front());
+  res.profile = profile;
+
+  return res;
+}
+
+/* ------------------------- Data ------------------------- */
+
+imu_data read_imu(const std::string& path, const std::string& imu_type, unsigned int decimate){
+  imu_data res;
+  arma::field<arma::mat> out;
+  {
+    profile_recorder recorder(res.profile);
+    out = read_imu_file(path, get_imu_layout(imu_type), decimate);
+  }
+
+  res.data.swap(out(0));
+  res.freq = out(1)(0);
+  res.scale_gyro = out(1)(1);
+  res.scale_acc = out(1)(2);
+  return res;
+}
+
+arma::vec simulate(unsigned int n, const arma::vec& theta, const std::vector<std::string>& model){
+  return gen_model(n, theta, model, model_objdesc(model));
+}
+
+}
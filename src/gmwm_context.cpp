@@ -0,0 +1,120 @@
+#include <RcppArmadillo.h>
+#include <random>
+#include <thread>
+
+#include "gmwm_context.h"
+
+#ifndef GMWM_STANDALONE
+/* ------------------------- R Adapters ------------------------- */
+
+// R's RNG, so that set.seed makes fits run from R reproducible
+class r_rng : public gmwm_rng{
+public:
+  void seed(unsigned int s){
+    Rcpp::Environment base_env("package:base");
+    Rcpp::Function set_seed_r = base_env["set.seed"];
+    set_seed_r(s);
+  }
+
+  double unif(double a, double b){
+    return R::runif(a, b);
+  }
+
+  double norm(double mu, double sd){
+    return R::rnorm(mu, sd);
+  }
+};
+
+// R's console
+class r_logger : public gmwm_logger{
+public:
+  void message(const std::string& line){
+    Rcpp::Rcout << line << std::endl;
+  }
+};
+#endif
+
+/* ------------------------- Native Implementations ------------------------- */
+
+struct native_rng::state{
+  std::mt19937 gen;
+  std::normal_distribution<double> normal;
+};
+
+native_rng::native_rng(unsigned int s) : st(new state){
+  st->gen.seed(s);
+}
+
+native_rng::~native_rng(){
+  delete st;
+}
+
+void native_rng::seed(unsigned int s){
+  st->gen.seed(s);
+  st->normal.reset();
+}
+
+double native_rng::unif(double a, double b){
+  return std::uniform_real_distribution<double>(a, b)(st->gen);
+}
+
+double native_rng::norm(double mu, double sd){
+  return mu + sd*st->normal(st->gen);
+}
+
+void ostream_logger::message(const std::string& line){
+  out << line << std::endl;
+}
+
+arma::vec native_solver::minimize(objective_function& f, const arma::vec& start){
+  return cg_min(f, start);
+}
+
+double native_solver::minimize_1d(scalar_function& f, double lower, double upper){
+  return brent_min(f, lower, upper);
+}
+
+/* ------------------------- Context Selection ------------------------- */
+
+static thread_local gmwm_context* active_context = NULL;
+
+#ifndef GMWM_STANDALONE
+// The package is loaded, and so this is initialised, on R's thread
+static const std::thread::id r_thread = std::this_thread::get_id();
+
+static gmwm_context& r_context(){
+  static r_rng rng;
+  static r_logger logger;
+  static native_solver solver;
+  static gmwm_context ctx = {&rng, &logger, &solver, NULL};
+  return ctx;
+}
+#endif
+
+static gmwm_context& thread_context(){
+  static thread_local native_rng rng;
+  static thread_local null_logger logger;
+  static thread_local native_solver solver;
+  static thread_local gmwm_context ctx = {&rng, &logger, &solver, NULL};
+  return ctx;
+}
+
+gmwm_context& current_context(){
+  if(active_context){
+    return *active_context;
+  }
+#ifndef GMWM_STANDALONE
+  if(std::this_thread::get_id() == r_thread){
+    return r_context();
+  }
+#endif
+  return thread_context();
+}
+
+gmwm_context_scope::gmwm_context_scope(gmwm_context& ctx) : previous(active_context){
+  active_context = &ctx;
+}
+
+gmwm_context_scope::~gmwm_context_scope(){
+  active_context = previous;
+}
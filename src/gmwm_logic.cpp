@@ -47,6 +47,14 @@
 //
 #include "bootstrappers.h"
 
+// Messages go to the logger of the context
+#include "gmwm_context.h"
+
+// Times the stages of the fit and charges the decomposition it holds
+#include "gmwm_memory.h"
+#include "gmwm_profile.h"
+#include "gmwm_trace.h"
+
 
 //' @title Optim loses NaN
 //' @description This function takes numbers that are very small and sets them to the minimal tolerance for C++.
@@ -101,6 +109,7 @@ arma::vec gmwm_engine(const arma::vec& theta,
                       arma::vec scales,
                       bool starting){
   
+  trace_scope trace("gmwm_engine", "fit");
   
   // Transform the Starting values
   arma::vec starting_theta = transform_values(theta, desc, objdesc, model_type);
@@ -220,129 +229,144 @@ arma::field<arma::mat> gmwm_update_cpp(arma::vec theta,
                                         
 }
 
-//' @title Master Wrapper for the GMWM Estimator
-//' @description This function generates WV, GMWM Estimator, and an initial test estimate.
+//' @title Differencing Required by a Model
+//' @description Differencing of the first SARIMA term that requires it.
+//' @param desc A \code{vector<string>} indicating the models that should be considered.
+//' @param objdesc A \code{field<vec>} containing a list of parameters (e.g. AR(1) = c(1,1), ARMA(p,q) = c(p,q,1))
+//' @return A \code{vec} with the number of differences (d), the seasonality (s) and the number of seasonal differences (D).
+//' All zero when the data is modeled as is.
+//' @keywords internal
+arma::vec model_differencing(const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc){
+  
+  arma::vec differencing = arma::zeros<arma::vec>(3);
+  
+  // HACK METHOD (todo: formalize it)
+  // Note: s, i, si are 6,7,8 => 5,6,7
+  for(unsigned int i = 0; i < desc.size(); i ++){
+    if(objdesc(i).n_elem > 3){
+      arma::vec sarima_desc = objdesc(i);
+      // Do we need to difference? 
+      if(sarima_desc(6) > 0 || sarima_desc(7) > 0){
+        differencing(0) = sarima_desc(6);
+        differencing(1) = sarima_desc(5);
+        differencing(2) = sarima_desc(7);
+        
+        // Kill loop. We only handle the tsmodel object with the first difference.
+        break;
+      }
+    }
+  }
+  
+  return differencing;
+}
+
+//' @title Difference a Series
+//' @description Applies the differencing given by \code{\link{model_differencing}}: first non-seasonal and then seasonal.
 //' @param data A \code{vec} containing the data.
+//' @param differencing A \code{vec} with the number of differences, the seasonality and the number of seasonal differences.
+//' @return A \code{vec} containing the differenced data.
+//' @keywords internal
+arma::vec difference_series(const arma::vec& data, const arma::vec& differencing){
+  
+  arma::vec x = data;
+  
+  if(differencing(0) > 0){
+    // Lag is always 1, number of differences is (i)
+    x = diff_cpp(x, 1, differencing(0));
+  }
+  
+  if(differencing(2) > 0){
+    // Lag is always seasonality (s) and differences is (si).
+    x = diff_cpp(x, differencing(1), differencing(2));
+  }
+  
+  return x;
+}
+
+//' @title Covariance Matrix of the WV
+//' @description Computes the covariance matrix of the empirical WV that the GMWM starts from.
+//' @param modwt_decomp A \code{field<vec>} containing the MODWT decomposition of the data.
+//' @param wvar A \code{mat} containing the empirical WV (col1), lower bound (col2) and upper bound (col3).
+//' @param compute_v A \code{string} that describes what kind of covariance matrix should be computed.
+//' @param robust A \code{bool} that indicates whether the estimation should be robust or not.
+//' @param eff A \code{double} that specifies the amount of efficiency required by the robust estimator.
+//' @return A \code{mat} containing the covariance matrix. "fast" and "bootstrap" start from the CI of the WV.
+//' @keywords internal
+arma::mat wv_covariance(const arma::field<arma::vec>& modwt_decomp, const arma::mat& wvar,
+                        std::string compute_v, bool robust, double eff){
+  
+  profile_timer timer(STAGE_V);
+  
+  // compute_cov_cpp is the hard core function. It can only be improved by using parallelization.
+  if(compute_v == "diag" || compute_v == "full"){
+    arma::field<arma::mat> Vout = compute_cov_cpp(modwt_decomp, wvar.n_rows, compute_v, robust, eff);
+    if(robust){
+      return Vout(1);
+    }else{
+      return Vout(0);
+    }
+  }
+  
+  return fast_cov_cpp(wvar.col(2), wvar.col(1));
+}
+
+//' @title Core of the GMWM Estimator
+//' @description Estimates a model from the WV of a series and its covariance matrix.
+//' @param x A \code{vec} containing the (differenced) data being modeled.
+//' @param wvar A \code{mat} containing the empirical WV (col1), lower bound (col2) and upper bound (col3).
+//' @param orgV A \code{mat} containing the covariance matrix of the WV from \code{\link{wv_covariance}}.
+//' @param expect_diff A \code{double} corresponding to the empirical mean of the first difference of the data.
+//' @param ranged A \code{double} corresponding to the scaled range of the data (i.e. (max - min)/length). 
 //' @param theta A \code{vec} with dimensions N x 1 that contains user-supplied initial values for parameters
 //' @param desc A \code{vector<string>} indicating the models that should be considered.
 //' @param objdesc A \code{field<vec>} containing a list of parameters (e.g. AR(1) = c(1,1), ARMA(p,q) = c(p,q,1))
 //' @param model_type A \code{string} that represents the model transformation
 //' @param starting A \code{bool} that indicates whether the supplied values are guessed (T) or are user-based (F).
-//' @param alpha A \code{double} that handles the alpha level of the confidence interval (1-alpha)*100
 //' @param compute_v A \code{string} that describes what kind of covariance matrix should be computed.
 //' @param K An \code{int} that controls how many times theta is updated.
 //' @param H An \code{int} that controls how many bootstrap replications are done.
 //' @param G An \code{int} that controls how many guesses at different parameters are made.
 //' @param robust A \code{bool} that indicates whether the estimation should be robust or not.
 //' @param eff A \code{double} that specifies the amount of efficiency required by the robust estimator.
-//' @return A \code{field<mat>} that contains a list of ever-changing estimates...
-//' @author JJB
-//' @references Wavelet variance based estimation for composite stochastic processes, S. Guerrier and Robust Inference for Time Series Models: a Wavelet-Based Framework, S. Guerrier
+//' @return A \code{field<mat>} laid out as the output of \code{\link{gmwm_master_cpp}}.
 //' @keywords internal
-//' @export
-//' @backref src/gmwm_logic.cpp
-//' @backref src/gmwm_logic.h
-// [[Rcpp::export]]
-arma::field<arma::mat> gmwm_master_cpp(arma::vec& data, 
-                                       arma::vec theta,
-                                       const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, 
-                                       std::string model_type, bool starting,
-                                       double alpha, 
-                                       std::string compute_v, unsigned int K, unsigned int H,
-                                       unsigned int G, 
-                                       bool robust, double eff){
+arma::field<arma::mat> gmwm_fit_core(const arma::vec& x, const arma::mat& wvar, const arma::mat& orgV,
+                                     double expect_diff, double ranged,
+                                     arma::vec theta,
+                                     const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, 
+                                     std::string model_type, bool starting,
+                                     std::string compute_v, unsigned int K, unsigned int H,
+                                     unsigned int G, 
+                                     bool robust, double eff){
   
   // Obtain counts of the different models we need to work with
   std::map<std::string, int> models = count_models(desc);
   
-  // HACK METHOD (todo: formalize it)
-  // Determine if we need to difference
-  if(models["SARIMA"] > 0){
-    
-    // Note: s, i, si are 6,7,8 => 5,6,7
-    for(unsigned int i = 0; i < desc.size(); i ++){
-      if(objdesc(i).n_elem > 3){
-        arma::vec sarima_desc = objdesc(i);
-        // Do we need to difference? 
-        if(sarima_desc(6) > 0 || sarima_desc(7) > 0){
-          // Perform differencing in specific order...
-          // First non-seasonal and then seasonal.
-          
-          if(sarima_desc(6) > 0){
-            // Lag is always 1, number of differences is (i)
-            data = diff_cpp(data, 1, sarima_desc(6));
-          }
-          
-          if(sarima_desc(7) > 0){
-            // Lag is always seasonality (s) and differences is (si).
-            data = diff_cpp(data, sarima_desc(5), sarima_desc(7));
-          }
-          
-          // Kill loop. We only handle the tsmodel object with the first difference.
-          break;
-        }
-      }
-    }
-  }
-  
-  // ------ Variable Declarations
-  
   // Length of the Time Series
-  unsigned int N = data.n_elem;
+  unsigned int N = x.n_elem;
   
   // Number of Scales (J)
-  unsigned int nlevels = floor(log2(N));
+  unsigned int nlevels = wvar.n_rows;
   
   // Number of parameters
   unsigned int np = theta.n_elem;
   
-  // Take the mean of the first difference
-  double expect_diff = mean_diff(data);
-  
   // Guessed values of Theta (user supplied or generated)
   arma::vec guessed_theta = theta;
   
-  // MODWT decomp
-  arma::field<arma::vec> modwt_decomp = modwt_cpp(data, "haar", nlevels, "periodic", true);
-  
-  // Obtain WV and confidence intervals
-  arma::mat wvar = wvar_cpp(modwt_decomp, robust, eff, alpha, "eta3");
-  
   // Extract
   arma::vec wv_empir = wvar.col(0);
   arma::vec ci_lo = wvar.col(1);
   arma::vec ci_hi = wvar.col(2);
   
-  //-------------------------
-  // Obtain Covariance Matrix
-  //-------------------------
-  
-  arma::mat V;
-  
-  // compute_cov_cpp is the hard core function. It can only be improved by using parallelization.
-  if(compute_v == "diag" || compute_v == "full"){
-    arma::field<arma::mat> Vout = compute_cov_cpp(modwt_decomp, nlevels, compute_v, robust, eff);
-    if(robust){
-      V = Vout(1);
-    }else{
-      V = Vout(0);
-    }
-  }else{
-    V = fast_cov_cpp(wvar.col(2), wvar.col(1));
-  }
+  arma::mat V = orgV;
   
   // Obtain the Omega matrix
   arma::mat omega = arma::inv(diagmat(V));
   
-  // Store the original V matrix (in case of bootstrapping) for use in the update function
-  arma::mat orgV = V;
-  
   // Calculate the values of the Scales 
   arma::vec scales = scales_cpp(nlevels);
   
-  // Min-Max / N
-  double ranged = dr_slope(data);
-  
   // Guess starting values for the theta parameters
   if(starting){
     
@@ -351,23 +375,27 @@ arma::field<arma::mat> gmwm_master_cpp(arma::vec& data,
     
     // If under ARMA case and only ARMA is in the model, 
     // then see how well these values are.
-    if(desc.size() == 1 && (desc[0] == "SARIMA" || desc[0] == "ARMA11") && N <= 1000){
+    if(desc.size() == 1 && (desc[0] == "SARIMA" || desc[0] == "ARMA11")){
       
-      // Use R's ARIMA function to estimate parameter space
-      arma::vec theta2 = Rcpp_ARIMA(data, objdesc(0)); // Only 1 objdesc in the available.
+      // Native CSS estimates of the parameter space
+      css_fit css = arima_css_fit(x, objdesc(0)); // Only 1 objdesc in the available.
       
-      // Obtain the obj function under omega with these initial guesses
-      // DO >>NOT<< USE Yannick's to optimize starting values!!!!
-      double mle_css_obj = getObjFun(theta2, desc, objdesc,  model_type, omega, wv_empir, scales); 
-      
-      // Obtain the objective function under Yannick's starting algorithm
-      double init_guess_obj = getObjFunStarting(theta, desc, objdesc,  model_type, wv_empir, scales);
-      
-      // What performs better? 
-      if(mle_css_obj < init_guess_obj){
-        // Disable starting value optimization if using MLE. 
-        theta = theta2;
-        starting = false;
+      if(css.valid){
+        arma::vec theta2 = css.coef;
+        
+        // Obtain the obj function under omega with these initial guesses
+        // DO >>NOT<< USE Yannick's to optimize starting values!!!!
+        double mle_css_obj = getObjFun(theta2, desc, objdesc,  model_type, omega, wv_empir, scales); 
+        
+        // Obtain the objective function under Yannick's starting algorithm
+        double init_guess_obj = getObjFunStarting(theta, desc, objdesc,  model_type, wv_empir, scales);
+        
+        // What performs better? 
+        if(mle_css_obj < init_guess_obj){
+          // Disable starting value optimization if using MLE. 
+          theta = theta2;
+          starting = false;
+        }
       }
       
     }
@@ -405,7 +433,7 @@ arma::field<arma::mat> gmwm_master_cpp(arma::vec& data,
     arma::vec temp = objdesc(0);
     unsigned int p = temp(0);
     if(p != 0 && invert_check(arma::join_cols(arma::ones<arma::vec>(1), -theta.rows(0, p - 1))) == false){
-      Rcpp::Rcout << "WARNING: This ARMA model contains AR coefficients that are NON-STATIONARY!" << std::endl;
+      log_line() << "WARNING: This ARMA model contains AR coefficients that are NON-STATIONARY!";
     }
   } 
   
@@ -444,6 +472,73 @@ arma::field<arma::mat> gmwm_master_cpp(arma::vec& data,
 }
 
 
+//' @title Master Wrapper for the GMWM Estimator
+//' @description This function generates WV, GMWM Estimator, and an initial test estimate.
+//' @param data A \code{vec} containing the data.
+//' @param theta A \code{vec} with dimensions N x 1 that contains user-supplied initial values for parameters
+//' @param desc A \code{vector<string>} indicating the models that should be considered.
+//' @param objdesc A \code{field<vec>} containing a list of parameters (e.g. AR(1) = c(1,1), ARMA(p,q) = c(p,q,1))
+//' @param model_type A \code{string} that represents the model transformation
+//' @param starting A \code{bool} that indicates whether the supplied values are guessed (T) or are user-based (F).
+//' @param alpha A \code{double} that handles the alpha level of the confidence interval (1-alpha)*100
+//' @param compute_v A \code{string} that describes what kind of covariance matrix should be computed.
+//' @param K An \code{int} that controls how many times theta is updated.
+//' @param H An \code{int} that controls how many bootstrap replications are done.
+//' @param G An \code{int} that controls how many guesses at different parameters are made.
+//' @param robust A \code{bool} that indicates whether the estimation should be robust or not.
+//' @param eff A \code{double} that specifies the amount of efficiency required by the robust estimator.
+//' @return A \code{field<mat>} that contains a list of ever-changing estimates...
+//' @author JJB
+//' @references Wavelet variance based estimation for composite stochastic processes, S. Guerrier and Robust Inference for Time Series Models: a Wavelet-Based Framework, S. Guerrier
+//' @keywords internal
+//' @export
+//' @backref src/gmwm_logic.cpp
+//' @backref src/gmwm_logic.h
+// [[Rcpp::export]]
+arma::field<arma::mat> gmwm_master_cpp(const arma::vec& data, 
+                                       arma::vec theta,
+                                       const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, 
+                                       std::string model_type, bool starting,
+                                       double alpha, 
+                                       std::string compute_v, unsigned int K, unsigned int H,
+                                       unsigned int G, 
+                                       bool robust, double eff){
+  
+  // The data is only copied when it is differenced
+  arma::vec differencing = model_differencing(desc, objdesc);
+  bool is_differenced = differencing(0) > 0 || differencing(2) > 0;
+  
+  arma::vec differenced;
+  if(is_differenced){
+    differenced = difference_series(data, differencing);
+  }
+  
+  // ------ Variable Declarations
+  
+  // Series being modeled
+  const arma::vec& x = is_differenced ? differenced : data;
+  
+  // Number of Scales (J)
+  unsigned int nlevels = floor(log2(x.n_elem));
+  
+  // MODWT decomp
+  arma::field<arma::vec> modwt_decomp = modwt_cpp(x, "haar", nlevels, "periodic", true);
+  memory_charge coefficients(MEMORY_MODWT, decomposition_bytes(modwt_decomp));
+  
+  // Obtain WV and confidence intervals
+  arma::mat wvar = wvar_cpp(modwt_decomp, robust, eff, alpha, "eta3");
+  
+  //-------------------------
+  // Obtain Covariance Matrix
+  //-------------------------
+  
+  arma::mat V = wv_covariance(modwt_decomp, wvar, compute_v, robust, eff);
+  
+  return gmwm_fit_core(x, wvar, V, mean_diff(x), dr_slope(x), theta, desc, objdesc, model_type, starting,
+                       compute_v, K, H, G, robust, eff);
+}
+
+
 
 
 
@@ -557,7 +652,7 @@ arma::field<arma::mat> gmwm_master_wv_cpp(arma::mat wvar,
     arma::vec temp = objdesc(0);
     unsigned int p = temp(0);
     if(p != 0 && invert_check(arma::join_cols(arma::ones<arma::vec>(1), -theta.rows(0, p - 1))) == false){
-      Rcpp::Rcout << "WARNING: This ARMA model contains AR coefficients that are NON-STATIONARY!" << std::endl;
+      log_line() << "WARNING: This ARMA model contains AR coefficients that are NON-STATIONARY!";
     }
   } 
   
@@ -18,7 +18,23 @@ arma::field<arma::mat> gmwm_update_cpp(arma::vec theta,
                                        unsigned int G = 1000, 
                                        bool robust=false, double eff = 0.6);
                                       
-arma::field<arma::mat> gmwm_master_cpp(arma::vec& data, 
+arma::vec model_differencing(const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc);
+
+arma::vec difference_series(const arma::vec& data, const arma::vec& differencing);
+
+arma::mat wv_covariance(const arma::field<arma::vec>& modwt_decomp, const arma::mat& wvar,
+                        std::string compute_v, bool robust, double eff);
+
+arma::field<arma::mat> gmwm_fit_core(const arma::vec& x, const arma::mat& wvar, const arma::mat& orgV,
+                                     double expect_diff, double ranged,
+                                     arma::vec theta,
+                                     const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, 
+                                     std::string model_type, bool starting,
+                                     std::string compute_v, unsigned int K, unsigned int H,
+                                     unsigned int G, 
+                                     bool robust, double eff);
+
+arma::field<arma::mat> gmwm_master_cpp(const arma::vec& data, 
                                        arma::vec theta,
                                        const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, 
                                        std::string model_type, bool starting = true,
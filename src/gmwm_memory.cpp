@@ -0,0 +1,176 @@
+#include <RcppArmadillo.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+#include "gmwm_memory.h"
+
+// Peaks are recorded into the profile of the context
+#include "gmwm_profile.h"
+
+static std::atomic<long long> held[MEMORY_STRUCTURES];
+static std::atomic<long long> held_peak[MEMORY_STRUCTURES];
+static std::atomic<long long> total(0);
+static std::atomic<long long> total_peak(0);
+static std::atomic<long long> budget(0);
+
+// Raises peak to at least v
+static void raise_peak(std::atomic<long long>& peak, long long v){
+  long long p = peak.load(std::memory_order_relaxed);
+  while(p < v && !peak.compare_exchange_weak(p, v, std::memory_order_relaxed)){}
+}
+
+const char* memory_structure_name(memory_structure structure){
+  static const char* names[MEMORY_STRUCTURES] = {
+    "modwt", "bootstrap", "imu", "simulation"
+  };
+  return names[structure];
+}
+
+static const char* memory_structure_description(memory_structure structure){
+  static const char* descriptions[MEMORY_STRUCTURES] = {
+    "MODWT coefficients", "bootstrap workspace", "decoded IMU records", "simulated processes"
+  };
+  return descriptions[structure];
+}
+
+// What to use instead when a structure does not fit
+static const char* memory_alternative(memory_structure structure){
+  static const char* alternatives[MEMORY_STRUCTURES] = {
+    "gmwm_session() and read.wvar.imu() compute the wavelet variance from a bounded history of the series "
+    "instead of every coefficient.",
+    "compute.v = \"fast\" avoids the bootstrap, and fewer replicates (H) need a smaller workspace.",
+    "read.wvar.imu() streams the file in blocks, read.imu(lazy = TRUE) reads the columns when they are used "
+    "and read.imu(decimate = k) averages the records while reading them.",
+    "gen_gts() keeps only the sum of the processes, instead of each process and their sum."
+  };
+  return alternatives[structure];
+}
+
+std::string memory_format(double bytes){
+  static const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+  unsigned int u = 0;
+  while(bytes >= 1024.0 && u < 4){
+    bytes /= 1024.0;
+    u++;
+  }
+  char buf[32];
+  snprintf(buf, sizeof(buf), u == 0 ? "%.0f %s" : "%.1f %s", bytes, units[u]);
+  return buf;
+}
+
+memory_usage memory_snapshot(){
+  memory_usage u;
+  for(unsigned int i = 0; i < MEMORY_STRUCTURES; i++){
+    u.current[i] = held[i].load();
+    u.peak[i] = held_peak[i].load();
+  }
+  u.total = total.load();
+  u.peak_total = total_peak.load();
+  u.budget = budget.load();
+  return u;
+}
+
+void memory_reset_peaks(){
+  for(unsigned int i = 0; i < MEMORY_STRUCTURES; i++){
+    held_peak[i] = held[i].load();
+  }
+  total_peak = total.load();
+}
+
+double memory_set_budget(double bytes){
+  if(!(bytes >= 0)){
+    throw std::invalid_argument("The memory budget must be a number of bytes, 0 for no limit.");
+  }
+  return budget.exchange((long long)bytes);
+}
+
+memory_charge::memory_charge(memory_structure structure, double bytes, const char* operation)
+  : structure(structure), bytes((long long)bytes) {
+
+  long long now;
+  if(operation){
+    // Reserve against the budget, so that threads charging at the same time cannot both pass the check
+    long long limit = budget.load(std::memory_order_relaxed);
+    long long t = total.load(std::memory_order_relaxed);
+    do{
+      if(limit > 0 && t + this->bytes > limit){
+        throw memory_budget_error(std::string(operation) + " needs " + memory_format(bytes) + " for its " +
+                                  memory_structure_description(structure) + ", but the memory budget of " +
+                                  memory_format(limit) + " has " + memory_format(std::max(limit - t, 0LL)) +
+                                  " left. " + memory_alternative(structure));
+      }
+    }while(!total.compare_exchange_weak(t, t + this->bytes, std::memory_order_relaxed));
+    now = t + this->bytes;
+  }else{
+    now = total.fetch_add(this->bytes, std::memory_order_relaxed) + this->bytes;
+  }
+
+  long long mine = held[structure].fetch_add(this->bytes, std::memory_order_relaxed) + this->bytes;
+  raise_peak(held_peak[structure], mine);
+  raise_peak(total_peak, now);
+
+#ifndef GMWM_NO_PROFILE
+  gmwm_profile* profile = current_context().profile;
+  if(profile){
+    profile->peak_bytes[structure] = std::max(profile->peak_bytes[structure], double(mine));
+    profile->peak_total_bytes = std::max(profile->peak_total_bytes, double(now));
+    for(unsigned int i = 0; i < PROFILE_STAGES; i++){
+      if(profile->depth[i] > 0){
+        profile->stage_peak_bytes[i] = std::max(profile->stage_peak_bytes[i], double(now));
+      }
+    }
+  }
+#endif
+}
+
+memory_charge::~memory_charge(){
+  held[structure].fetch_sub(bytes, std::memory_order_relaxed);
+  total.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+#ifndef GMWM_STANDALONE
+
+//' @title Set the Memory Budget
+//' @description Sets the most bytes the MODWT coefficients, bootstrap workspaces, decoded IMU records and
+//' simulated processes may hold at once.
+//' @param bytes A \code{double} giving the budget in bytes, 0 for no limit.
+//' @return The previous budget.
+//' @keywords internal
+//' @backref src/gmwm_memory.cpp
+// [[Rcpp::export]]
+double memory_budget_cpp(double bytes){
+  return memory_set_budget(bytes);
+}
+
+//' @title Memory Held by the Estimation
+//' @description Reports the bytes held by each tracked structure, now and at their peak.
+//' @param reset A \code{bool} indicating whether the peaks are reset to the current values after being read.
+//' @return A \code{matrix} with a row per structure and a row for their total, and the columns current and peak.
+//' The budget is the attribute \code{budget}.
+//' @keywords internal
+//' @backref src/gmwm_memory.cpp
+// [[Rcpp::export]]
+Rcpp::NumericMatrix memory_usage_cpp(bool reset){
+  memory_usage u = memory_snapshot();
+  if(reset){
+    memory_reset_peaks();
+  }
+
+  Rcpp::NumericMatrix out(MEMORY_STRUCTURES + 1, 2);
+  Rcpp::CharacterVector rows(MEMORY_STRUCTURES + 1);
+  for(unsigned int i = 0; i < MEMORY_STRUCTURES; i++){
+    out(i, 0) = u.current[i];
+    out(i, 1) = u.peak[i];
+    rows[i] = memory_structure_name(memory_structure(i));
+  }
+  out(MEMORY_STRUCTURES, 0) = u.total;
+  out(MEMORY_STRUCTURES, 1) = u.peak_total;
+  rows[MEMORY_STRUCTURES] = "total";
+
+  out.attr("dimnames") = Rcpp::List::create(rows, Rcpp::CharacterVector::create("current", "peak"));
+  out.attr("budget") = u.budget;
+  return out;
+}
+
+#endif
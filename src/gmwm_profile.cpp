@@ -0,0 +1,140 @@
+#include <RcppArmadillo.h>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "gmwm_profile.h"
+
+void gmwm_profile::reset(){
+  for(unsigned int i = 0; i < PROFILE_STAGES; i++){
+    seconds[i] = 0.0;
+    calls[i] = 0;
+    stage_peak_bytes[i] = 0.0;
+    depth[i] = 0;
+  }
+  for(unsigned int i = 0; i < PROFILE_COUNTERS; i++){
+    counts[i] = 0;
+  }
+  for(unsigned int i = 0; i < MEMORY_STRUCTURES; i++){
+    peak_bytes[i] = 0.0;
+  }
+  peak_total_bytes = 0.0;
+  convergence = 0;
+}
+
+gmwm_profile& gmwm_profile::operator+=(const gmwm_profile& other){
+  for(unsigned int i = 0; i < PROFILE_STAGES; i++){
+    seconds[i] += other.seconds[i];
+    calls[i] += other.calls[i];
+    stage_peak_bytes[i] = std::max(stage_peak_bytes[i], other.stage_peak_bytes[i]);
+  }
+  for(unsigned int i = 0; i < PROFILE_COUNTERS; i++){
+    counts[i] += other.counts[i];
+  }
+  for(unsigned int i = 0; i < MEMORY_STRUCTURES; i++){
+    peak_bytes[i] = std::max(peak_bytes[i], other.peak_bytes[i]);
+  }
+  peak_total_bytes = std::max(peak_total_bytes, other.peak_total_bytes);
+
+  // The other call ran within the stages this profile is in
+  for(unsigned int i = 0; i < PROFILE_STAGES; i++){
+    if(depth[i] > 0){
+      stage_peak_bytes[i] = std::max(stage_peak_bytes[i], other.peak_total_bytes);
+    }
+  }
+
+  if(other.counts[COUNT_OPTIM_RUNS] > 0){
+    convergence = other.convergence;
+  }
+  return *this;
+}
+
+const char* profile_stage_name(profile_stage stage){
+  static const char* names[PROFILE_STAGES] = {
+    "modwt", "wv", "v", "guess", "optim", "bootstrap", "select"
+  };
+  return names[stage];
+}
+
+const char* profile_counter_name(profile_counter counter){
+  static const char* names[PROFILE_COUNTERS] = {
+    "guess_draws", "objective_evaluations", "optim_runs", "optim_iterations", "optim_not_converged",
+    "bootstrap_replicates", "candidates", "warm_starts",
+    "wv_cache_lookups", "wv_cache_hits", "deriv_cache_lookups", "deriv_cache_hits",
+    "deriv2_cache_lookups", "deriv2_cache_hits"
+  };
+  return names[counter];
+}
+
+#ifndef GMWM_STANDALONE
+
+// Profiles of the R calls being recorded, innermost last. R calls them on its own thread.
+static std::vector< std::unique_ptr<gmwm_profile> > r_profiles;
+
+//' @title Start Recording a Profile
+//' @description Records the stages of the following calls into a new profile until \code{\link{profile_stop_cpp}}.
+//' Recordings nest: the inner one is added to the outer one when it stops.
+//' @keywords internal
+//' @backref src/gmwm_profile.cpp
+// [[Rcpp::export]]
+void profile_start_cpp(){
+  r_profiles.push_back(std::unique_ptr<gmwm_profile>(new gmwm_profile));
+  current_context().profile = r_profiles.back().get();
+}
+
+//' @title Stop Recording a Profile
+//' @description Stops the innermost recording started by \code{\link{profile_start_cpp}}.
+//' @return A \code{list} with a \code{matrix} giving the seconds, calls and peak bytes of each stage, the counters,
+//' the convergence code of the last minimisation and the peak bytes of each structure and of their total.
+//' @keywords internal
+//' @backref src/gmwm_profile.cpp
+// [[Rcpp::export]]
+Rcpp::List profile_stop_cpp(){
+  if(r_profiles.empty()){
+    Rcpp::stop("No profile is being recorded.");
+  }
+
+  std::unique_ptr<gmwm_profile> profile(r_profiles.back().release());
+  r_profiles.pop_back();
+
+  gmwm_profile* parent = r_profiles.empty() ? NULL : r_profiles.back().get();
+  current_context().profile = parent;
+  if(parent){
+    *parent += *profile;
+  }
+
+  Rcpp::NumericMatrix stages(PROFILE_STAGES, 3);
+  Rcpp::CharacterVector stage_names(PROFILE_STAGES);
+  for(unsigned int i = 0; i < PROFILE_STAGES; i++){
+    stages(i, 0) = profile->seconds[i];
+    stages(i, 1) = profile->calls[i];
+    stages(i, 2) = profile->stage_peak_bytes[i];
+    stage_names[i] = profile_stage_name(profile_stage(i));
+  }
+  stages.attr("dimnames") = Rcpp::List::create(stage_names, Rcpp::CharacterVector::create("seconds", "calls", "peak_bytes"));
+
+  Rcpp::NumericVector counts(PROFILE_COUNTERS);
+  Rcpp::CharacterVector count_names(PROFILE_COUNTERS);
+  for(unsigned int i = 0; i < PROFILE_COUNTERS; i++){
+    counts[i] = profile->counts[i];
+    count_names[i] = profile_counter_name(profile_counter(i));
+  }
+  counts.attr("names") = count_names;
+
+  Rcpp::NumericVector peaks(MEMORY_STRUCTURES + 1);
+  Rcpp::CharacterVector peak_names(MEMORY_STRUCTURES + 1);
+  for(unsigned int i = 0; i < MEMORY_STRUCTURES; i++){
+    peaks[i] = profile->peak_bytes[i];
+    peak_names[i] = memory_structure_name(memory_structure(i));
+  }
+  peaks[MEMORY_STRUCTURES] = profile->peak_total_bytes;
+  peak_names[MEMORY_STRUCTURES] = "total";
+  peaks.attr("names") = peak_names;
+
+  return Rcpp::List::create(Rcpp::_["stages"] = stages,
+                            Rcpp::_["counts"] = counts,
+                            Rcpp::_["convergence"] = profile->convergence,
+                            Rcpp::_["peak_bytes"] = peaks);
+}
+
+#endif
@@ -0,0 +1,413 @@
+#include <RcppArmadillo.h>
+#include <map>
+#include <sstream>
+
+#include "modwt_stream.h"
+#include "gmwm_session.h"
+
+// modwt_cpp
+#include "dwt.h"
+
+// wvar_cpp and scales_cpp
+#include "wave_variance.h"
+
+// gmwm_fit_core and the data preparation steps
+#include "gmwm_logic.h"
+
+// getObjFun
+#include "objective_functions.h"
+
+// decomp_theoretical_wv
+#include "process_to_wv.h"
+
+// get_summary
+#include "summary_inf_mod.h"
+
+/* ----------------------- Start GMWM Session ------------------------ */
+
+// Fits kept by a session before the oldest is dropped
+static const unsigned int session_max_fits = 32;
+
+// Whether the data is differenced before being modeled
+inline bool differencing_applied(const arma::vec& differencing){
+  return differencing.n_elem == 3 && (differencing(0) > 0 || differencing(2) > 0);
+}
+
+gmwm_session::gmwm_session(const arma::vec& data, bool robust, double eff, double alpha) :
+  data(data.begin(), data.end()), robust(robust), eff(eff), alpha(alpha), prepared(false), decomp_current(false),
+  first(0), last(0), lowest(0), highest(0) {}
+
+arma::vec gmwm_session::series() const{
+  const std::vector<double>& s = differencing_applied(differencing) ? x : data;
+  return arma::vec(const_cast<double*>(&s[0]), s.size(), false, true);
+}
+
+void gmwm_session::prepare(const arma::vec& differencing_needed){
+  if(prepared && arma::approx_equal(differencing, differencing_needed, "absdiff", 0)){
+    return;
+  }
+
+  // A different differencing invalidates everything derived from the series
+  differencing = differencing_needed;
+  x.clear();
+  if(differencing_applied(differencing)){
+    arma::vec differenced = difference_series(arma::vec(&data[0], data.size(), false, true), differencing);
+    x.assign(differenced.begin(), differenced.end());
+  }
+
+  const std::vector<double>& s = differencing_applied(differencing) ? x : data;
+  if(s.size() < 2){
+    Rcpp::stop("The series of the session is too short to be modeled.");
+  }
+
+  stream = modwt_stream(floor(log2(s.size())));
+  first = lowest = highest = s[0];
+  extend(&s[0], s.size());
+
+  decomp_current = false;
+  update_wv();
+
+  prepared = true;
+}
+
+void gmwm_session::extend(const double* samples, unsigned int n){
+  stream.push(samples, n);
+
+  for(unsigned int i = 0; i < n; i++){
+    lowest = std::min(lowest, samples[i]);
+    highest = std::max(highest, samples[i]);
+  }
+  last = samples[n - 1];
+}
+
+void gmwm_session::update_wv(){
+  if(robust){
+    // The robust WV has no incremental form
+    wvar = wvar_cpp(decomposition(), robust, eff, alpha, "eta3");
+  }else{
+    wvar = stream.wvar(alpha);
+  }
+
+  scales = scales_cpp(wvar.n_rows);
+  covs.clear();
+  covs_inv.clear();
+}
+
+const arma::field<arma::vec>& gmwm_session::decomposition(){
+  if(!decomp_current){
+    decomp = modwt_cpp(series(), "haar", stream.levels(), "periodic", true);
+    decomp_current = true;
+  }
+
+  return decomp;
+}
+
+void gmwm_session::append(const arma::vec& samples){
+  if(samples.n_elem == 0){
+    return;
+  }
+
+  data.insert(data.end(), samples.begin(), samples.end());
+
+  // Models fitted so far restart from their estimates
+  for(unsigned int i = 0; i < fits.size(); i++){
+    previous[fits[i].model] = arma::vectorise(fits[i].out(0));
+  }
+  fits.clear();
+
+  if(!prepared){
+    return;
+  }
+
+  // New samples of the modeled series: the differences need the last samples before them
+  const double* added = samples.memptr();
+  unsigned int n_added = samples.n_elem;
+  arma::vec differenced;
+  if(differencing_applied(differencing)){
+    unsigned int lag = differencing(0) + differencing(1)*differencing(2);
+    if(data.size() < samples.n_elem + lag){
+      prepared = false;
+      prepare(differencing);
+      return;
+    }
+
+    arma::vec tail(&data[data.size() - samples.n_elem - lag], samples.n_elem + lag);
+    differenced = difference_series(tail, differencing);
+    x.insert(x.end(), differenced.begin(), differenced.end());
+    added = differenced.memptr();
+    n_added = differenced.n_elem;
+  }
+
+  unsigned int length = stream.size() + n_added;
+  if(floor(log2(length)) != stream.levels()){
+    // A new level needs the whole series. Happens each time the length doubles.
+    prepared = false;
+    prepare(differencing);
+    return;
+  }
+
+  extend(added, n_added);
+
+  decomp_current = false;
+  update_wv();
+}
+
+const arma::mat& gmwm_session::covariance(const std::string& compute_v){
+  // "bootstrap" starts from the same matrix as "fast"
+  std::string type = (compute_v == "diag" || compute_v == "full") ? compute_v : "fast";
+
+  std::map<std::string, arma::mat>::iterator it = covs.find(type);
+  if(it == covs.end()){
+    // "fast" only uses the CI of the WV, so the MODWT is not rebuilt for it
+    const arma::field<arma::vec>& d = (type == "fast") ? decomp : decomposition();
+    it = covs.insert(std::make_pair(type, wv_covariance(d, wvar, type, robust, eff))).first;
+  }
+
+  return it->second;
+}
+
+// Identifies a model
+std::string session_model_key(const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc,
+                              const std::string& model_type){
+  std::ostringstream key;
+
+  for(unsigned int i = 0; i < desc.size(); i++){
+    key << desc[i] << "(";
+    for(unsigned int j = 0; j < objdesc(i).n_elem; j++){
+      key << objdesc(i)(j) << ",";
+    }
+    key << ")";
+  }
+
+  key << "|" << model_type;
+
+  return key.str();
+}
+
+// Identifies a fit by everything its result depends on
+std::string session_fit_key(const arma::vec& theta,
+                            const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc,
+                            const std::string& model_type, bool starting,
+                            const std::string& compute_v, unsigned int K, unsigned int H, unsigned int G,
+                            unsigned int seed){
+  std::ostringstream key;
+  key.precision(17);
+
+  key << session_model_key(desc, objdesc, model_type);
+  key << "|" << starting << "|" << compute_v << "|" << K << "|" << H << "|" << G << "|" << seed << "|";
+
+  for(unsigned int i = 0; i < theta.n_elem; i++){
+    key << theta(i) << ",";
+  }
+
+  return key.str();
+}
+
+const arma::field<arma::mat>& gmwm_session::fit(arma::vec theta,
+                                                const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc,
+                                                std::string model_type, bool starting,
+                                                std::string compute_v, unsigned int K, unsigned int H, unsigned int G,
+                                                unsigned int seed){
+  std::string key = session_fit_key(theta, desc, objdesc, model_type, starting, compute_v, K, H, G, seed);
+
+  for(unsigned int i = 0; i < fits.size(); i++){
+    if(fits[i].key == key){
+      return fits[i].out;
+    }
+  }
+
+  prepare(model_differencing(desc, objdesc));
+
+  session_fit f;
+  f.key = key;
+  f.model = session_model_key(desc, objdesc, model_type);
+  f.desc = desc;
+  f.model_type = model_type;
+
+  // A model fitted before samples were appended starts from its previous estimates instead of a new search
+  std::map<std::string, arma::vec>::const_iterator warm = previous.find(f.model);
+  if(starting && warm != previous.end() && warm->second.n_elem == theta.n_elem){
+    theta = warm->second;
+    starting = false;
+  }
+
+  arma::vec s = series();
+  unsigned int N = s.n_elem;
+  double expect_diff = (last - first)/double(N - 1);
+  double ranged = (highest - lowest)/double(N);
+
+  f.out = gmwm_fit_core(s, wvar, covariance(compute_v), expect_diff, ranged, theta, desc, objdesc, model_type, starting,
+                        compute_v, K, H, G, robust, eff);
+
+  if(fits.size() >= session_max_fits){
+    fits.erase(fits.begin());
+  }
+  fits.push_back(f);
+
+  return fits.back().out;
+}
+
+arma::field<arma::mat> gmwm_session::summary(const arma::vec& theta,
+                                             const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc,
+                                             std::string model_type,
+                                             bool inference, bool bs_gof, bool bs_gof_p_ci, bool bs_theta_est, bool bs_ci,
+                                             unsigned int B){
+  prepare(model_differencing(desc, objdesc));
+
+  // Most recent fit with these estimates
+  const session_fit* f = NULL;
+  for(unsigned int i = fits.size(); i-- > 0; ){
+    const arma::mat& est = fits[i].out(0);
+    if(fits[i].desc == desc && fits[i].model_type == model_type && est.n_elem == theta.n_elem &&
+       arma::approx_equal(arma::vectorise(est), theta, "absdiff", 0)){
+      f = &fits[i];
+      break;
+    }
+  }
+
+  // Estimates from elsewhere are evaluated against the fast covariance matrix
+  const arma::mat& orgV = f ? f->out(6) : covariance("fast");
+  arma::mat V = f ? f->out(5) : orgV;
+
+  std::string cov_key = f ? f->key : "fast";
+  std::map<std::string, arma::mat>::iterator it = covs_inv.find(cov_key);
+  if(it == covs_inv.end()){
+    it = covs_inv.insert(std::make_pair(cov_key, arma::mat(arma::inv(orgV)))).first;
+  }
+
+  arma::vec theo;
+  double obj_value;
+  if(f){
+    theo = f->out(8);
+    obj_value = arma::as_scalar(f->out(10));
+  }else{
+    theo = arma::sum(decomp_theoretical_wv(theta, desc, objdesc, scales), 1);
+    obj_value = getObjFun(theta, desc, objdesc, model_type, arma::inv(arma::diagmat(orgV)), wvar.col(0), scales);
+  }
+
+  return get_summary(theta, desc, objdesc, model_type, wvar.col(0), theo, scales,
+                     V, it->second, obj_value, series().n_elem, alpha, robust, eff,
+                     inference, false, bs_gof, bs_gof_p_ci, bs_theta_est, bs_ci, B);
+}
+
+Rcpp::List gmwm_session::info() const{
+  return Rcpp::List::create(Rcpp::Named("N") = data.size(),
+                            Rcpp::Named("robust") = robust,
+                            Rcpp::Named("eff") = eff,
+                            Rcpp::Named("alpha") = alpha,
+                            Rcpp::Named("prepared") = prepared,
+                            Rcpp::Named("fits") = fits.size(),
+                            Rcpp::Named("wvar") = prepared ? Rcpp::wrap(wvar) : R_NilValue);
+}
+
+// Session behind an external pointer, failing if it was released
+gmwm_session* session_ptr(SEXP session){
+  if(TYPEOF(session) != EXTPTRSXP){
+    Rcpp::stop("`session` must be created by gmwm_session().");
+  }
+
+  gmwm_session* s = static_cast<gmwm_session*>(R_ExternalPtrAddr(session));
+  if(s == NULL){
+    Rcpp::stop("The session has been released.");
+  }
+
+  return s;
+}
+
+//' @title Create a GMWM Session
+//' @description Keeps the MODWT, WV and covariance matrices of a series in C++ across fits.
+//' @param data A \code{vec} containing the data.
+//' @param robust A \code{bool} that indicates whether the estimation should be robust or not.
+//' @param eff A \code{double} that specifies the amount of efficiency required by the robust estimator.
+//' @param alpha A \code{double} that handles the alpha level of the confidence interval (1-alpha)*100
+//' @return An external pointer to the session.
+//' @keywords internal
+// [[Rcpp::export]]
+SEXP gmwm_session_cpp(const arma::vec& data, bool robust, double eff, double alpha){
+  Rcpp::XPtr<gmwm_session> ptr(new gmwm_session(data, robust, eff, alpha), true);
+  return ptr;
+}
+
+//' @title Fit a Model within a GMWM Session
+//' @description Same as \code{\link{gmwm_master_cpp}}, reusing the quantities of the session.
+//' @param session An external pointer created by \code{\link{gmwm_session_cpp}}.
+//' @param theta A \code{vec} with dimensions N x 1 that contains user-supplied initial values for parameters
+//' @param desc A \code{vector<string>} indicating the models that should be considered.
+//' @param objdesc A \code{field<vec>} containing a list of parameters (e.g. AR(1) = c(1,1), ARMA(p,q) = c(p,q,1))
+//' @param model_type A \code{string} that represents the model transformation
+//' @param starting A \code{bool} that indicates whether the supplied values are guessed (T) or are user-based (F).
+//' @param compute_v A \code{string} that describes what kind of covariance matrix should be computed.
+//' @param K An \code{int} that controls how many times theta is updated.
+//' @param H An \code{int} that controls how many bootstrap replications are done.
+//' @param G An \code{int} that controls how many guesses at different parameters are made.
+//' @param seed An \code{unsigned int} with the seed R set before the call. Fits with the same seed are reused.
+//' @return A \code{field<mat>} laid out as the output of \code{\link{gmwm_master_cpp}}.
+//' @keywords internal
+// [[Rcpp::export]]
+arma::field<arma::mat> gmwm_session_fit_cpp(SEXP session, const arma::vec& theta,
+                                            const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc,
+                                            std::string model_type, bool starting,
+                                            std::string compute_v, unsigned int K, unsigned int H, unsigned int G,
+                                            unsigned int seed){
+  return session_ptr(session)->fit(theta, desc, objdesc, model_type, starting, compute_v, K, H, G, seed);
+}
+
+//' @title Summary of a Model within a GMWM Session
+//' @description Same as \code{\link{get_summary}}, reusing the fit and covariance matrices of the session.
+//' @param session An external pointer created by \code{\link{gmwm_session_cpp}}.
+//' @param theta A \code{vec} containing the estimates (AR1 parameterization).
+//' @param desc A \code{vector<string>} indicating the models that should be considered.
+//' @param objdesc A \code{field<vec>} containing a list of parameters (e.g. AR(1) = c(1,1), ARMA(p,q) = c(p,q,1))
+//' @param model_type A \code{string} that represents the model transformation
+//' @param inference A \code{bool} that indicates whether inference should be performed.
+//' @param bs_gof A \code{bool} that indicates whether the GoF test is bootstrapped.
+//' @param bs_gof_p_ci A \code{bool} that indicates whether a CI of the bootstrapped GoF p-value is computed.
+//' @param bs_theta_est A \code{bool} that indicates whether the bootstrapped estimates are reported.
+//' @param bs_ci A \code{bool} that indicates whether the CIs are bootstrapped.
+//' @param B An \code{int} that indicates how many bootstrap replications are done.
+//' @return A \code{field<mat>} laid out as the output of \code{\link{get_summary}}.
+//' @keywords internal
+// [[Rcpp::export]]
+arma::field<arma::mat> gmwm_session_summary_cpp(SEXP session, const arma::vec& theta,
+                                                const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc,
+                                                std::string model_type,
+                                                bool inference, bool bs_gof, bool bs_gof_p_ci, bool bs_theta_est, bool bs_ci,
+                                                unsigned int B){
+  return session_ptr(session)->summary(theta, desc, objdesc, model_type, inference, bs_gof, bs_gof_p_ci, bs_theta_est, bs_ci, B);
+}
+
+//' @title Append Data to a GMWM Session
+//' @description Adds samples at the end of the series of the session. The MODWT and the classical WV are
+//' updated with the new samples only, and the models fitted so far restart from their estimates. The robust WV
+//' has no incremental form: robust sessions decompose the whole series again at every append.
+//' @param session An external pointer created by \code{\link{gmwm_session_cpp}}.
+//' @param samples A \code{vec} containing the new samples.
+//' @keywords internal
+// [[Rcpp::export]]
+void gmwm_session_append_cpp(SEXP session, const arma::vec& samples){
+  session_ptr(session)->append(samples);
+}
+
+//' @title Information on a GMWM Session
+//' @param session An external pointer created by \code{\link{gmwm_session_cpp}}.
+//' @return A \code{list} with the length of the series, the WV settings, whether the series has been decomposed,
+//' the number of fits kept and the WV of the modeled series laid out as \code{\link{wvar_cpp}}, if decomposed.
+//' @keywords internal
+// [[Rcpp::export]]
+Rcpp::List gmwm_session_info_cpp(SEXP session){
+  return session_ptr(session)->info();
+}
+
+//' @title Release a GMWM Session
+//' @description Frees the memory of the session immediately instead of at garbage collection.
+//' @param session An external pointer created by \code{\link{gmwm_session_cpp}}.
+//' @keywords internal
+// [[Rcpp::export]]
+void gmwm_session_release_cpp(SEXP session){
+  delete session_ptr(session);
+
+  // The finalizer skips cleared pointers
+  R_ClearExternalPtr(session);
+}
+
+/* ------------------------ End GMWM Session ------------------------- */
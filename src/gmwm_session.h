@@ -0,0 +1,81 @@
+#ifndef GMWM_SESSION
+#define GMWM_SESSION
+
+// A model fitted within a session
+struct session_fit{
+  std::string key;                      // Model, starting values and settings of the fit
+  std::string model;                    // Model alone
+  std::vector<std::string> desc;
+  std::string model_type;
+  arma::field<arma::mat> out;           // Laid out as the output of gmwm_master_cpp
+};
+
+// Keeps the quantities derived from a series across fits of different models, so that model edits,
+// summaries and inference only compute what changed. Held by R through an external pointer and
+// freed when the session is released or garbage collected.
+class gmwm_session{
+public:
+  gmwm_session(const arma::vec& data, bool robust, double eff, double alpha);
+
+  const arma::field<arma::mat>& fit(arma::vec theta,
+                                    const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc,
+                                    std::string model_type, bool starting,
+                                    std::string compute_v, unsigned int K, unsigned int H, unsigned int G,
+                                    unsigned int seed);
+
+  arma::field<arma::mat> summary(const arma::vec& theta,
+                                 const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc,
+                                 std::string model_type,
+                                 bool inference, bool bs_gof, bool bs_gof_p_ci, bool bs_theta_est, bool bs_ci,
+                                 unsigned int B);
+
+  // Append samples to the series, updating what was derived from it
+  void append(const arma::vec& samples);
+
+  Rcpp::List info() const;
+
+private:
+  // Series modeled under the given differencing, decomposed on first use
+  void prepare(const arma::vec& differencing);
+
+  // Add samples of the modeled series to the MODWT and the moments of the series
+  void extend(const double* samples, unsigned int n);
+
+  // Recompute the WV from the MODWT
+  void update_wv();
+
+  // Series being modeled, without copying it
+  arma::vec series() const;
+
+  // Brick walled MODWT, computed on first use since the classical WV does not need it
+  const arma::field<arma::vec>& decomposition();
+
+  const arma::mat& covariance(const std::string& compute_v);
+
+  // Settings of the WV
+  std::vector<double> data;
+  bool robust;
+  double eff;
+  double alpha;
+
+  // Derived from the (differenced) series
+  bool prepared;
+  arma::vec differencing;
+  std::vector<double> x;                // Differenced series, empty when the data is modeled as is
+  modwt_stream stream;
+  bool decomp_current;
+  arma::field<arma::vec> decomp;
+  arma::mat wvar;
+  arma::vec scales;
+  double first, last, lowest, highest;  // Moments behind mean_diff and dr_slope
+  std::map<std::string, arma::mat> covs;
+  std::map<std::string, arma::mat> covs_inv;
+
+  // Fitted models, most recent last
+  std::vector<session_fit> fits;
+
+  // Estimates of the models fitted before samples were appended, used as their starting values
+  std::map<std::string, arma::vec> previous;
+};
+
+#endif
@@ -0,0 +1,195 @@
+#include <RcppArmadillo.h>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "gmwm_trace.h"
+
+std::atomic<bool> trace_on(false);
+
+// Event of a trace_scope, in nanoseconds since trace_start()
+struct trace_event{
+  const char* name;
+  const char* category;
+  long long id;
+  long long start;
+  long long end;
+};
+
+// Ring buffer of the events of one thread. Only that thread writes it.
+struct trace_buffer{
+  unsigned int tid;
+  std::atomic<unsigned int> generation;     // Trace the events belong to
+  std::vector<trace_event> events;
+  std::atomic<unsigned long long> written;  // Events recorded, of which the last events.size() are kept
+};
+
+static std::mutex registry_mutex;
+
+// Buffers of every thread that recorded an event, kept after the thread ends so its events can be written.
+// The buffers of ended threads are dropped when the next trace starts.
+static std::vector< std::shared_ptr<trace_buffer> > registry;
+static unsigned int next_tid = 1;
+
+static std::atomic<unsigned int> generation(0);
+static std::atomic<unsigned int> capacity(65536);
+static std::atomic<long long> epoch(0);
+
+static thread_local std::shared_ptr<trace_buffer> local;
+
+static long long clock_ns(){
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+long long trace_now(){
+  return clock_ns() - epoch.load(std::memory_order_relaxed);
+}
+
+// Buffer of the calling thread, emptied when it still holds an earlier trace
+static trace_buffer& local_buffer(){
+  unsigned int gen = generation.load(std::memory_order_acquire);
+
+  if(!local){
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    local = std::make_shared<trace_buffer>();
+    local->tid = next_tid++;
+    local->generation = gen - 1;
+    local->written = 0;
+    registry.push_back(local);
+  }
+
+  if(local->generation.load(std::memory_order_relaxed) != gen){
+    local->events.assign(capacity.load(), trace_event());
+    local->written.store(0, std::memory_order_relaxed);
+    local->generation.store(gen, std::memory_order_release);
+  }
+
+  return *local;
+}
+
+void trace_record(const char* name, const char* category, long long id, long long start_ns, long long end_ns){
+  trace_buffer& buf = local_buffer();
+
+  unsigned long long n = buf.written.load(std::memory_order_relaxed);
+  trace_event& e = buf.events[n % buf.events.size()];
+  e.name = name;
+  e.category = category;
+  e.id = id;
+  e.start = start_ns;
+  e.end = end_ns;
+
+  buf.written.store(n + 1, std::memory_order_release);
+}
+
+void trace_start(unsigned int events_per_thread){
+  if(events_per_thread == 0){
+    throw std::invalid_argument("A trace must keep at least one event per thread.");
+  }
+
+  {
+    // Only the registry still refers to the buffer of a thread that ended
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    unsigned int kept = 0;
+    for(unsigned int b = 0; b < registry.size(); b++){
+      if(registry[b].use_count() > 1){
+        registry[kept++] = registry[b];
+      }
+    }
+    registry.resize(kept);
+  }
+
+  capacity = events_per_thread;
+  epoch = clock_ns();
+  generation.fetch_add(1, std::memory_order_release);
+  trace_on = true;
+}
+
+void trace_stop(){
+  trace_on = false;
+}
+
+unsigned long trace_write(const std::string& path){
+  FILE* f = fopen(path.c_str(), "w");
+  if(f == NULL){
+    throw std::runtime_error("Cannot write the trace to " + path + ".");
+  }
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+
+  unsigned int gen = generation.load(std::memory_order_acquire);
+  unsigned long count = 0;
+  unsigned long long dropped = 0;
+  bool first = true;
+
+  fputs("{\"traceEvents\":[", f);
+
+  for(unsigned int b = 0; b < registry.size(); b++){
+    const trace_buffer& buf = *registry[b];
+    if(buf.generation.load(std::memory_order_acquire) != gen){
+      continue;
+    }
+
+    unsigned long long written = buf.written.load(std::memory_order_acquire);
+    if(written == 0){
+      continue;
+    }
+    unsigned long long size = buf.events.size();
+    unsigned long long from = written > size ? written - size : 0;
+    dropped += from;
+
+    fprintf(f, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"gmwm thread %u\"}}",
+            first ? "" : ",", buf.tid, buf.tid);
+    first = false;
+
+    for(unsigned long long i = from; i < written; i++){
+      const trace_event& e = buf.events[i % size];
+      fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+              e.name, e.category, buf.tid, e.start/1e3, (e.end - e.start)/1e3);
+      if(e.id >= 0){
+        fprintf(f, ",\"args\":{\"id\":%lld}", e.id);
+      }
+      fputs("}", f);
+      count++;
+    }
+  }
+
+  fprintf(f, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":%llu}}\n", dropped);
+
+  bool failed = ferror(f) != 0;
+  if(fclose(f) != 0 || failed){
+    throw std::runtime_error("Cannot write the trace to " + path + ".");
+  }
+
+  return count;
+}
+
+#ifndef GMWM_STANDALONE
+
+//' @title Start a Trace
+//' @description Starts recording the events of the hot functions of the package.
+//' @param events An \code{unsigned int} giving the number of events kept per thread.
+//' @return Nothing.
+//' @keywords internal
+//' @backref src/gmwm_trace.cpp
+// [[Rcpp::export]]
+void trace_start_cpp(unsigned int events){
+  trace_start(events);
+}
+
+//' @title Stop a Trace
+//' @description Stops recording and writes the events in the Chrome Trace Event format.
+//' @param file A \code{string} giving the path of the JSON file to write.
+//' @return The number of events written.
+//' @keywords internal
+//' @backref src/gmwm_trace.cpp
+// [[Rcpp::export]]
+double trace_stop_cpp(std::string file){
+  trace_stop();
+  return trace_write(file);
+}
+
+#endif
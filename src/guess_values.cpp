@@ -22,6 +22,13 @@
 // for estimator domination
 #include "process_to_wv.h"
 
+// Draws from the RNG of the context
+#include "gmwm_context.h"
+
+// Times the search and counts the draws
+#include "gmwm_profile.h"
+#include "gmwm_trace.h"
+
 
 // ------------- New
 
@@ -57,34 +64,34 @@ double dr_slope(const arma::vec& data){
 
 double draw_rw(double sigma2_total, int N){
   // sigma^2/(N*10^5), sigma^2 / N
-  return R::runif(0.00001*sigma2_total/double(N), sigma2_total/double(N));
+  return rng_unif(0.00001*sigma2_total/double(N), sigma2_total/double(N));
 }
 
 double draw_qn_dom(double sigma2_total){
-  return R::runif(sigma2_total/8.0, sigma2_total/3.0);
+  return rng_unif(sigma2_total/8.0, sigma2_total/3.0);
 }
 
 // sigma^2 /2 * 1/(10^5), sigma^2/2 * 2/100
 double draw_qn_weak(double sigma2_total){
-  return R::runif(sigma2_total*0.000005, sigma2_total/100.0);
+  return rng_unif(sigma2_total*0.000005, sigma2_total/100.0);
 }
 
 double draw_wn_dom(double sigma2_total){
-  return R::runif(sigma2_total/2.0, sigma2_total);
+  return rng_unif(sigma2_total/2.0, sigma2_total);
 }
 
 // sigma^2/10^5
 double draw_wn_weak(double sigma2_total){
-  return R::runif(0.00001*sigma2_total, .1*sigma2_total);
+  return rng_unif(0.00001*sigma2_total, .1*sigma2_total);
 }
 
 double draw_drift(double ranged){
-  return R::runif(ranged/100.0, ranged/2.0);
+  return rng_unif(ranged/100.0, ranged/2.0);
 }
 
 arma::vec draw_ar1(double sigma2_total){
   // Draw from triangle distributions for phi
-  double U = R::runif(0.0, 1.0/3.0);
+  double U = rng_unif(0.0, 1.0/3.0);
   
   arma::vec temp(2);
   
@@ -95,7 +102,7 @@ arma::vec draw_ar1(double sigma2_total){
   double val = (1-square(temp(0)));
   
   // (sigma^2/2 * (1-phi^2)), (sigma^2 * (1-phi^2))
-  temp(1) = R::runif(0.5*sigma2_total*val, sigma2_total*val);
+  temp(1) = rng_unif(0.5*sigma2_total*val, sigma2_total*val);
   
   return temp; 
 }
@@ -104,13 +111,13 @@ arma::vec draw_ar1_memory_add(double sigma2_total, double last_phi){
   arma::vec temp(2);
   
   // Draw for phi
-  temp(0) = R::runif(std::max(0.95,last_phi), 0.999995);
+  temp(0) = rng_unif(std::max(0.95,last_phi), 0.999995);
   
   // 1 - phi^2
   double val = (1-square(temp(0)));
   
   // (sigma^2/ 10^5 * (1-phi^2)), 2*(sigma^2 * (1-phi^2))/100
-  temp(1) = R::runif(0.00001*sigma2_total*val, sigma2_total*val/50.0);
+  temp(1) = rng_unif(0.00001*sigma2_total*val, sigma2_total*val/50.0);
   
   return temp;
 }
@@ -120,13 +127,13 @@ arma::vec draw_ar1_memory(double sigma2_total, double last_phi){
   arma::vec temp(2);
   
   // Draw for phi
-  temp(0) = R::runif(std::max(0.9,last_phi), 0.999995);
+  temp(0) = rng_unif(std::max(0.9,last_phi), 0.999995);
   
   // 1 - phi^2
   double val = (1-square(temp(0)));
   
   // (sigma^2/ 10^5 * (1-phi^2)), 2*(sigma^2 * (1-phi^2))/100
-  temp(1) = R::runif(0.0, 0.01*sigma2_total*val );
+  temp(1) = rng_unif(0.0, 0.01*sigma2_total*val );
     
  //   R::runif(0.00001*sigma2_total*val, sigma2_total*val/50.0);
   
@@ -136,7 +143,7 @@ arma::vec draw_ar1_memory(double sigma2_total, double last_phi){
 
 arma::vec draw_ar1_memory_large(double sigma2_total, double last_phi){
   // Draw from triangle distributions for phi
-  double Y = (1.0 - std::sqrt(1.0-3.0 * R::runif(0.0, 1.0/3.0)));
+  double Y = (1.0 - std::sqrt(1.0-3.0 * rng_unif(0.0, 1.0/3.0)));
   
   arma::vec temp(2);
   
@@ -147,7 +154,7 @@ arma::vec draw_ar1_memory_large(double sigma2_total, double last_phi){
   double val = (1-square(temp(0)));
   
   // (sigma^2/2 * (1-phi^2)), (sigma^2 * (1-phi^2))
-  temp(1) = R::runif(0.0, 0.01*sigma2_total*val );
+  temp(1) = rng_unif(0.0, 0.01*sigma2_total*val );
  // R::runif(0.5*sigma2_total*val, sigma2_total*val);
   
   return temp; 
@@ -175,6 +182,10 @@ arma::vec guess_initial(const std::vector<std::string>& desc, const arma::field<
                         std::string model_type, unsigned int num_param, double expect_diff, unsigned int N,
                         const arma::mat& wv, const arma::vec& tau, double ranged, unsigned int G){
   
+  profile_timer timer(STAGE_GUESS);
+  profile_count(COUNT_GUESS_DRAWS, G);
+  trace_scope trace("guess_initial", "fit");
+  
   // Obtain the sum of variances for sigma^2_total.
   
   arma::vec wv_empirical = wv.col(0);
@@ -221,7 +232,7 @@ arma::vec guess_initial(const std::vector<std::string>& desc, const arma::field<
   for(unsigned int g = 0; g < G; g++){
     unsigned int i_theta = 0;
     double last_phi = 0;
-    int AR1_counter = dom_wn || (dom_qn &&  R::runif(0.0,1.0) < .75 );
+    int AR1_counter = dom_wn || (dom_qn &&  rng_unif(0.0,1.0) < .75 );
     
     // Generate parameters for the model
     for(unsigned int i = 0; i < num_desc; i++){
@@ -348,32 +359,32 @@ arma::vec ar1_draw(unsigned int draw_id, double last_phi, double sigma2_total, s
   if(draw_id == 0){
     if(model_type == "imu"){
       // Draw from triangle distributions for phi
-      double U = R::runif(0.0, 1.0/3.0);
+      double U = rng_unif(0.0, 1.0/3.0);
       
       // Draw for phi
       temp(0) = 1.0/5.0*(1.0-sqrt(1.0-3.0*U));
-      temp(1) = R::runif(0.5*sigma2_total*(1-square(temp(0))), sigma2_total);
+      temp(1) = rng_unif(0.5*sigma2_total*(1-square(temp(0))), sigma2_total);
     }
     else{ // ssm
       // Draw for phi
-      temp(0) = R::runif(-0.9999999999999, 0.9999999999999);
+      temp(0) = rng_unif(-0.9999999999999, 0.9999999999999);
       // Draw for sigma
-      temp(1) = R::runif(0.0000000000001, sigma2_total);
+      temp(1) = rng_unif(0.0000000000001, sigma2_total);
     }
   }
   else{
     
     if(draw_id!=1){
       // Draw for phi on i >= 3
-      temp(0) = R::runif(last_phi,0.9999999); //1.0/40.0*(38.0-sqrt(6.0*U-2.0)) + .05;
+      temp(0) = rng_unif(last_phi,0.9999999); //1.0/40.0*(38.0-sqrt(6.0*U-2.0)) + .05;
     }
     else{
       // Draw for phi on i==1
-      temp(0) = R::runif(0.7,0.9999999); //1.0/40.0*(38.0-sqrt(6.0*U-2.0)) + .05;
+      temp(0) = rng_unif(0.7,0.9999999); //1.0/40.0*(38.0-sqrt(6.0*U-2.0)) + .05;
     }
     
     // Draw for process variance
-    temp(1) = R::runif(0.0, 0.01*sigma2_total*(1-square(temp(0))) ); // VERIFY THIS SHOULD BE PHI VALUE!!
+    temp(1) = rng_unif(0.0, 0.01*sigma2_total*(1-square(temp(0))) ); // VERIFY THIS SHOULD BE PHI VALUE!!
     
   } // end if
   
@@ -424,7 +435,7 @@ arma::vec arma_draws(unsigned int p, unsigned int q, double sigma2_total){
       start = -.99999999, end = .999999999;
       for(i = 0; i < p; i++){
         // Draw point and move starting bounds up
-        start = R::runif(start,end);
+        start = rng_unif(start,end);
         
         // Assign picked point
         ar(i) = start; 
@@ -447,7 +458,7 @@ arma::vec arma_draws(unsigned int p, unsigned int q, double sigma2_total){
   start = -.99999999, end = .999999999;
   
   for(i = 0; i < q; i++){
-    start = R::runif(start,end);
+    start = rng_unif(start,end);
     ma(i) = start;
   }
   
@@ -532,16 +543,16 @@ arma::vec guess_initial_old(const std::vector<std::string>& desc, const arma::fi
         AR1_counter++;
       }
       else if(element_type == "WN"){  // WN
-        temp_theta(i_theta) = R::runif(sigma2_total/2.0, sigma2_total);
+        temp_theta(i_theta) = rng_unif(sigma2_total/2.0, sigma2_total);
       }
       else if(element_type == "DR"){   
         temp_theta(i_theta) = expect_diff;
       }
       else if(element_type == "QN"){
-        temp_theta(i_theta) = R::runif(.0000001, sigma2_total);
+        temp_theta(i_theta) = rng_unif(.0000001, sigma2_total);
       }
       else if(element_type == "RW"){
-        temp_theta(i_theta) = R::runif(sigma2_total/double(N*1000.0), 2.0*sigma2_total/double(N));
+        temp_theta(i_theta) = rng_unif(sigma2_total/double(N*1000.0), 2.0*sigma2_total/double(N));
       }
       else { // Unpackage ARMA model parameter
         arma::vec model_params = objdesc(i);
@@ -39,7 +39,7 @@
 //' av_mat = avar_to_cpp(combined.ts)
 //' @keywords internal
 // [[Rcpp::export]]
-arma::mat hadam_to_cpp(arma::vec x) {
+arma::mat hadam_to_cpp(const arma::vec& x) {
   
   // Length of vector
   unsigned int T = x.n_elem;
@@ -114,7 +114,7 @@ arma::mat hadam_to_cpp(arma::vec x) {
 //' av_mat = avar_mo_cpp(combined.ts)
 //' @keywords internal
 // [[Rcpp::export]]
-arma::mat hadam_mo_cpp(arma::vec x) {
+arma::mat hadam_mo_cpp(const arma::vec& x) {
   
   // Length of vector
   unsigned int T = x.n_elem;
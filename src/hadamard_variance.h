@@ -1,8 +1,8 @@
 #ifndef HADAMARD_VARIANCE
 #define HADAMARD_VARIANCE
 
-arma::mat hadam_to_cpp(arma::vec x);
+arma::mat hadam_to_cpp(const arma::vec& x);
 
-arma::mat hadam_mo_cpp(arma::vec x);
+arma::mat hadam_mo_cpp(const arma::vec& x);
 
 #endif
@@ -12,6 +12,9 @@
 // HAAR FILTER
 #include "wv_filters.h"
 
+// RNG of the context
+#include "gmwm_context.h"
+
 //' @title Indirect Inference for ARMA
 //' @description Option for indirect inference
 //' @param ar A \code{vec} that contains the coefficients of the AR process.
@@ -28,11 +31,8 @@ arma::vec idf_arma(const arma::vec& ar, const arma::vec& ma,
                    const double sigma2,
                    unsigned int N, bool robust, double eff, unsigned int H){
   
-  // Access seed functions
-  Rcpp::Environment baseEnv("package:base");
-  Rcpp::Function setSeed = baseEnv["set.seed"];
-  
-  setSeed(1);
+  // Seed the RNG of the context
+  current_context().rng->seed(1);
   
   unsigned int nb_level = floor(log2(N));
   
@@ -73,11 +73,8 @@ arma::vec idf_arma_total(const arma::vec& ar, const arma::vec& ma,
                     const double sigma2,
                     unsigned int N, bool robust, double eff, unsigned int H){
   
-  // Access seed functions
-  Rcpp::Environment baseEnv("package:base");
-  Rcpp::Function setSeed = baseEnv["set.seed"];
-  
-  setSeed(1);
+  // Seed the RNG of the context
+  current_context().rng->seed(1);
   
   unsigned int n = N*H;
   
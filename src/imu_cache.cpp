@@ -0,0 +1,518 @@
+#include <RcppArmadillo.h>
+#include <stdexcept>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+
+#include "mapped_file.h"
+#include "imu_cache.h"
+
+/* ----------------------- Start IMU Cache Files ------------------------ */
+
+static const char imu_cache_magic[8] = "GMWMIMU";
+static const char wvar_cache_magic[4] = {'W', 'V', 'C', '1'};
+static const uint32_t imu_cache_version = 1;
+static const uint32_t imu_cache_byte_order = 0x01020304;
+
+// Copy a string into a fixed size, zero terminated field
+void copy_field(char* dst, size_t size, const std::string& src){
+  memset(dst, 0, size);
+  strncpy(dst, src.c_str(), size - 1);
+}
+
+// Read a fixed size, possibly unterminated field
+std::string field_string(const char* src, size_t size){
+  return std::string(src, std::find(src, src + size, '\0'));
+}
+
+// Round up to a multiple of 8 bytes so that every column is aligned
+inline uint64_t align8(uint64_t x){
+  return (x + 7) & ~uint64_t(7);
+}
+
+// Write a buffer, failing on a short write
+void write_bytes(FILE* fid, const void* p, size_t size){
+  if(size > 0 && fwrite(p, 1, size, fid) != size){
+    fclose(fid);
+    throw std::runtime_error("Unable to write the cache file.");
+  }
+}
+
+// Pad the file up to offset
+void write_padding(FILE* fid, uint64_t from, uint64_t offset){
+  static const char zeros[8] = {0};
+  write_bytes(fid, zeros, offset - from);
+}
+
+// Counts of quantum in each value of a column, or false if a value is not a whole number of counts.
+// Decoded integer sensors are exactly count * quantum, so storing the counts is lossless.
+bool column_counts(const double* x, arma::uword n, double quantum, std::vector<double>& counts){
+  if(!(quantum > 0) || !std::isfinite(quantum)){
+    return false;
+  }
+  counts.resize(n);
+  for(arma::uword i = 0; i < n; i++){
+    double k = round(x[i]/quantum);
+    if(k*quantum != x[i] || fabs(k) > 4503599627370496.0){
+      return false;
+    }
+    counts[i] = k;
+  }
+  return true;
+}
+
+// Write the columns of data (the time followed by the sensors) and its metadata.
+// Any wavelet variance cached in an existing file is discarded.
+void write_imu_cache(const std::string& file_path, const arma::mat& data, const arma::vec& stats,
+                     unsigned int n_gyros, unsigned int n_accels, const std::vector<std::string>& axis,
+                     const std::string& stype, const std::string& unit, const std::string& encoding){
+
+  arma::uword n = data.n_rows;
+  unsigned int n_cols = data.n_cols;
+
+  if(n_cols != 1 + n_gyros + n_accels || axis.size() != n_gyros + n_accels){
+    throw std::runtime_error("The data must contain the time followed by one column per sensor and axis.");
+  }
+
+  if(n < 2){
+    throw std::runtime_error("The data must contain at least two epochs.");
+  }
+
+  imu_cache_header hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, imu_cache_magic, sizeof(hdr.magic));
+  hdr.version = imu_cache_version;
+  hdr.byte_order = imu_cache_byte_order;
+  hdr.n_rows = n;
+  hdr.n_cols = n_cols;
+  hdr.n_gyros = n_gyros;
+  hdr.n_accels = n_accels;
+  hdr.freq = stats(0);
+  hdr.scale_gyro = stats(1);
+  hdr.scale_acc = stats(2);
+  copy_field(hdr.stype, sizeof(hdr.stype), stype);
+  copy_field(hdr.unit, sizeof(hdr.unit), unit);
+
+  if(encoding == "double"){
+    hdr.encoding = 0;
+  }else if(encoding == "float"){
+    hdr.encoding = 1;
+  }else if(encoding == "delta"){
+    hdr.encoding = 2;
+  }else{
+    throw std::runtime_error("The encoding " + encoding + " is not supported. Use double, float or delta.");
+  }
+
+  // Describe each column. The time is always kept in double precision.
+  std::vector<imu_cache_column> cols(n_cols);
+  std::vector< std::vector<double> > counts(n_cols);
+
+  uint64_t offset = align8(sizeof(imu_cache_header) + n_cols*sizeof(imu_cache_column));
+
+  for(unsigned int j = 0; j < n_cols; j++){
+    imu_cache_column& col = cols[j];
+    memset(&col, 0, sizeof(col));
+    copy_field(col.axis, sizeof(col.axis), j == 0 ? "time" : axis[j-1]);
+
+    col.storage = IMU_CACHE_DOUBLE;
+    if(j > 0 && hdr.encoding == 1){
+      col.storage = IMU_CACHE_FLOAT;
+    }else if(j > 0 && hdr.encoding == 2){
+      // One count is the unit of the raw sensor after scaling by the data rate, as done by read_imu
+      col.quantum = hdr.freq * ((j <= n_gyros) ? hdr.scale_gyro : hdr.scale_acc);
+
+      if(!column_counts(data.colptr(j), n, col.quantum, counts[j])){
+        throw std::runtime_error("The delta encoding requires sensors holding whole multiples of their scale times the frequency. Use double or float.");
+      }
+
+      double max_delta = 0;
+      for(arma::uword i = 1; i < n; i++){
+        max_delta = std::max(max_delta, fabs(counts[j][i] - counts[j][i-1]));
+      }
+
+      if(max_delta <= 32767){
+        col.storage = IMU_CACHE_DELTA16;
+      }else if(max_delta <= 2147483647.0){
+        col.storage = IMU_CACHE_DELTA32;
+      }else{
+        throw std::runtime_error("The changes of a sensor are too large for the delta encoding. Use double or float.");
+      }
+      col.first = counts[j][0];
+    }
+
+    col.offset = offset;
+
+    switch(col.storage){
+    case IMU_CACHE_DOUBLE:
+      offset += n*sizeof(double);
+      break;
+    case IMU_CACHE_FLOAT:
+      offset += n*sizeof(float);
+      break;
+    case IMU_CACHE_DELTA16:
+      offset += (n-1)*sizeof(int16_t);
+      break;
+    default:
+      offset += (n-1)*sizeof(int32_t);
+    }
+    offset = align8(offset);
+  }
+
+  hdr.wv_offset = offset;
+
+  // -- Write
+  FILE* fid = fopen(file_path.c_str(), "wb");
+  if(fid == NULL){
+    throw std::runtime_error("Cannot create the cache file " + file_path);
+  }
+
+  write_bytes(fid, &hdr, sizeof(hdr));
+  write_bytes(fid, &cols[0], n_cols*sizeof(imu_cache_column));
+
+  uint64_t pos = sizeof(hdr) + n_cols*sizeof(imu_cache_column);
+
+  for(unsigned int j = 0; j < n_cols; j++){
+    write_padding(fid, pos, cols[j].offset);
+    pos = cols[j].offset;
+
+    const double* x = data.colptr(j);
+
+    switch(cols[j].storage){
+    case IMU_CACHE_DOUBLE:
+      write_bytes(fid, x, n*sizeof(double));
+      pos += n*sizeof(double);
+      break;
+    case IMU_CACHE_FLOAT:{
+      std::vector<float> v(x, x + n);
+      write_bytes(fid, &v[0], n*sizeof(float));
+      pos += n*sizeof(float);
+      break;
+    }
+    case IMU_CACHE_DELTA16:{
+      std::vector<int16_t> v(n-1);
+      for(arma::uword i = 1; i < n; i++){
+        v[i-1] = int16_t(counts[j][i] - counts[j][i-1]);
+      }
+      write_bytes(fid, &v[0], (n-1)*sizeof(int16_t));
+      pos += (n-1)*sizeof(int16_t);
+      break;
+    }
+    default:{
+      std::vector<int32_t> v(n-1);
+      for(arma::uword i = 1; i < n; i++){
+        v[i-1] = int32_t(counts[j][i] - counts[j][i-1]);
+      }
+      write_bytes(fid, &v[0], (n-1)*sizeof(int32_t));
+      pos += (n-1)*sizeof(int32_t);
+    }
+    }
+  }
+  write_padding(fid, pos, hdr.wv_offset);
+
+  if(fclose(fid) != 0){
+    throw std::runtime_error("Unable to write the cache file.");
+  }
+}
+
+// Check the header of a mapped cache file
+const imu_cache_header& check_imu_cache(const mapped_file& fid){
+
+  if(fid.size() < sizeof(imu_cache_header) || memcmp(fid.data(), imu_cache_magic, sizeof(imu_cache_magic)) != 0){
+    throw std::runtime_error("The file is not an IMU cache file.");
+  }
+
+  const imu_cache_header& hdr = *reinterpret_cast<const imu_cache_header*>(fid.data());
+
+  if(hdr.version != imu_cache_version || hdr.byte_order != imu_cache_byte_order){
+    throw std::runtime_error("The IMU cache file was written by another version or on a machine with a different byte order.");
+  }
+
+  if(hdr.n_cols < 1 || hdr.n_cols != 1 + hdr.n_gyros + hdr.n_accels || hdr.n_rows < 2 ||
+     fid.size() < hdr.wv_offset || fid.size() < sizeof(imu_cache_header) + hdr.n_cols*sizeof(imu_cache_column)){
+    throw std::runtime_error("The IMU cache file is truncated or corrupted.");
+  }
+
+  // Every column must lie before the cached wavelet variances
+  const imu_cache_column* cols = reinterpret_cast<const imu_cache_column*>(fid.data() + sizeof(imu_cache_header));
+  for(uint32_t j = 0; j < hdr.n_cols; j++){
+    uint64_t size = (cols[j].storage == IMU_CACHE_DOUBLE) ? hdr.n_rows*sizeof(double) :
+      (cols[j].storage == IMU_CACHE_FLOAT) ? hdr.n_rows*sizeof(float) :
+      (cols[j].storage == IMU_CACHE_DELTA16) ? (hdr.n_rows-1)*sizeof(int16_t) : (hdr.n_rows-1)*sizeof(int32_t);
+    if(cols[j].storage > IMU_CACHE_DELTA32 || cols[j].offset + size > hdr.wv_offset){
+      throw std::runtime_error("The IMU cache file is truncated or corrupted.");
+    }
+  }
+
+  return hdr;
+}
+
+// Decode column j of a mapped cache file into out
+void decode_cache_column(const char* base, const imu_cache_column& col, arma::uword n, double* out){
+  const char* p = base + col.offset;
+
+  switch(col.storage){
+  case IMU_CACHE_DOUBLE:
+    memcpy(out, p, n*sizeof(double));
+    break;
+  case IMU_CACHE_FLOAT:{
+    const float* v = reinterpret_cast<const float*>(p);
+    for(arma::uword i = 0; i < n; i++){
+      out[i] = v[i];
+    }
+    break;
+  }
+  case IMU_CACHE_DELTA16:{
+    const int16_t* v = reinterpret_cast<const int16_t*>(p);
+    double k = col.first;
+    out[0] = k*col.quantum;
+    for(arma::uword i = 1; i < n; i++){
+      k += v[i-1];
+      out[i] = k*col.quantum;
+    }
+    break;
+  }
+  default:{
+    const int32_t* v = reinterpret_cast<const int32_t*>(p);
+    double k = col.first;
+    out[0] = k*col.quantum;
+    for(arma::uword i = 1; i < n; i++){
+      k += v[i-1];
+      out[i] = k*col.quantum;
+    }
+  }
+  }
+}
+
+//' @title Write an IMU Cache File
+//'
+//' @description
+//' Stores decoded IMU data in a columnar binary file that can be reloaded without decoding the original file.
+//'
+//' @param file_path  A \code{string} that contains the full file path.
+//' @param data       A \code{matrix} with the time in the first column followed by one column per sensor and axis.
+//' @param stats      A \code{vec} with the data rate, the gyroscope scale and the accelerometer scale, as returned by \code{\link{read_imu}}.
+//' @param num_sensor A \code{vector} with the number of gyroscopes and accelerometers.
+//' @param axis       A \code{vector} of \code{string} with the axis of each sensor.
+//' @param stype      A \code{string} that describes the sensor type.
+//' @param unit       A \code{string} that contains the unit expression of the frequency.
+//' @param encoding   A \code{string} that is either \code{"double"}, \code{"float"} or \code{"delta"}.
+//' @details
+//' Each column is stored contiguously. With \code{"float"} the sensors are stored in single precision, halving the
+//' size of the file at the cost of precision. With \code{"delta"} the sensors are stored as the differences of their
+//' raw counts (the value divided by the scale times the data rate) using 16 or 32 bits, which is lossless for sensors
+//' recording integers. The time is always stored in double precision.
+//'
+//' Writing a cache file discards the wavelet variances cached in it.
+//' @keywords internal
+// [[Rcpp::export]]
+void write_imu_cache_cpp(std::string file_path, const arma::mat& data, const arma::vec& stats,
+                         std::vector<unsigned int> num_sensor, std::vector<std::string> axis,
+                         std::string stype, std::string unit, std::string encoding){
+  if(num_sensor.size() != 2 || stats.n_elem != 3){
+    Rcpp::stop("`num_sensor` must contain 2 elements and `stats` 3 elements.");
+  }
+  write_imu_cache(file_path, data, stats, num_sensor[0], num_sensor[1], axis, stype, unit, encoding);
+}
+
+//' @title Read an IMU Cache File
+//'
+//' @description
+//' Reads a file written by \code{\link{write_imu_cache_cpp}}.
+//'
+//' @param file_path A \code{string} that contains the full file path.
+//' @param data      A \code{bool} indicating whether to decode the data (T) or only the metadata (F).
+//' @return A \code{list} with the data \code{matrix} (if requested), the \code{stats} as in \code{\link{read_imu}},
+//' the number of epochs, the number of sensors, their axis, the sensor type, the unit and the encoding.
+//' @details
+//' The file is memory-mapped and the columns are decoded in parallel when OpenMP is available.
+//' @keywords internal
+// [[Rcpp::export]]
+Rcpp::List read_imu_cache_cpp(std::string file_path, bool data = true){
+
+  mapped_file fid(file_path);
+  const imu_cache_header& hdr = check_imu_cache(fid);
+
+  const imu_cache_column* cols = reinterpret_cast<const imu_cache_column*>(fid.data() + sizeof(imu_cache_header));
+
+  arma::uword n = hdr.n_rows;
+  int n_cols = hdr.n_cols;
+
+  std::vector<std::string> axis(n_cols - 1);
+  for(int j = 1; j < n_cols; j++){
+    axis[j-1] = field_string(cols[j].axis, sizeof(cols[j].axis));
+  }
+
+  arma::vec stats(3);
+  stats(0) = hdr.freq;
+  stats(1) = hdr.scale_gyro;
+  stats(2) = hdr.scale_acc;
+
+  const char* encodings[3] = {"double", "float", "delta"};
+
+  arma::mat x;
+
+  if(data){
+    fid.advise_sequential();
+
+    x.set_size(n, n_cols);
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for(int j = 0; j < n_cols; j++){
+      decode_cache_column(fid.data(), cols[j], n, x.colptr(j));
+    }
+  }
+
+  Rcpp::List out = Rcpp::List::create(Rcpp::_["data"] = x,
+                                      Rcpp::_["stats"] = stats,
+                                      Rcpp::_["n"] = double(n),
+                                      Rcpp::_["num.sensor"] = Rcpp::IntegerVector::create(hdr.n_gyros, hdr.n_accels),
+                                      Rcpp::_["axis"] = axis,
+                                      Rcpp::_["stype"] = field_string(hdr.stype, sizeof(hdr.stype)),
+                                      Rcpp::_["unit"] = field_string(hdr.unit, sizeof(hdr.unit)),
+                                      Rcpp::_["encoding"] = encodings[std::min(hdr.encoding, uint32_t(2))]);
+
+  return out;
+}
+
+// Whether a cached wavelet variance matches the requested settings
+bool wvar_cache_match(const wvar_cache_record& rec, const std::string& filter, const std::string& decomp,
+                      unsigned int nlevels, bool robust, double eff, double alpha){
+  return field_string(rec.filter, sizeof(rec.filter)) == filter &&
+    field_string(rec.decomp, sizeof(rec.decomp)) == decomp &&
+    rec.nlevels == nlevels && (rec.robust != 0) == robust &&
+    (!robust || rec.eff == eff) && rec.alpha == alpha;
+}
+
+//' @title Cache a Wavelet Variance in an IMU Cache File
+//'
+//' @description
+//' Appends the wavelet variance of each sensor to a file written by \code{\link{write_imu_cache_cpp}}.
+//'
+//' @param file_path A \code{string} that contains the full file path.
+//' @param wv        A \code{field<mat>} with one matrix per sensor, as returned by \code{\link{batch_modwt_wvar_cpp}}.
+//' @param filter    A \code{string} indicating the wavelet filter used.
+//' @param decomp    A \code{string} indicating the decomposition used.
+//' @param robust    A \code{boolean} indicating whether the robust estimator was used.
+//' @param eff       A \code{double} that indicates the efficiency of the robust estimator.
+//' @param alpha     A \code{double} that indicates the \eqn{\left(1-p\right)*\alpha}{(1-p)*alpha} confidence level
+//' @details
+//' Results are keyed by \code{filter}, \code{decomp}, the number of levels, \code{robust}, \code{eff} (robust only)
+//' and \code{alpha}. Caching a result with the same key again supersedes the previous one.
+//' @keywords internal
+// [[Rcpp::export]]
+void write_wvar_cache_cpp(std::string file_path, const arma::field<arma::mat>& wv,
+                          std::string filter, std::string decomp, bool robust, double eff, double alpha){
+
+  {
+    // Only append to valid cache files
+    mapped_file fid(file_path);
+    check_imu_cache(fid);
+  }
+
+  if(wv.n_elem == 0){
+    Rcpp::stop("`wv` must contain at least one sensor.");
+  }
+
+  unsigned int nlevels = wv(0).n_rows;
+  for(unsigned int i = 0; i < wv.n_elem; i++){
+    if(wv(i).n_rows != nlevels || wv(i).n_cols != 3){
+      Rcpp::stop("Each element of `wv` must be a matrix with 3 columns and the same number of levels.");
+    }
+  }
+
+  wvar_cache_record rec;
+  memset(&rec, 0, sizeof(rec));
+  memcpy(rec.magic, wvar_cache_magic, sizeof(rec.magic));
+  rec.n_channels = wv.n_elem;
+  rec.nlevels = nlevels;
+  rec.robust = robust;
+  rec.eff = eff;
+  rec.alpha = alpha;
+  copy_field(rec.filter, sizeof(rec.filter), filter);
+  copy_field(rec.decomp, sizeof(rec.decomp), decomp);
+  rec.size = uint64_t(wv.n_elem)*nlevels*3*sizeof(double);
+
+  FILE* fid = fopen(file_path.c_str(), "ab");
+  if(fid == NULL){
+    throw std::runtime_error("Cannot open the cache file " + file_path);
+  }
+
+  write_bytes(fid, &rec, sizeof(rec));
+  for(unsigned int i = 0; i < wv.n_elem; i++){
+    write_bytes(fid, wv(i).memptr(), wv(i).n_elem*sizeof(double));
+  }
+
+  if(fclose(fid) != 0){
+    throw std::runtime_error("Unable to write the cache file.");
+  }
+}
+
+//' @title Look up a Wavelet Variance in an IMU Cache File
+//'
+//' @description
+//' Retrieves a wavelet variance stored by \code{\link{write_wvar_cache_cpp}}.
+//'
+//' @param file_path A \code{string} that contains the full file path.
+//' @param filter    A \code{string} indicating the wavelet filter.
+//' @param decomp    A \code{string} indicating the decomposition.
+//' @param nlevels   An \code{integer} indicating the number of decomposition levels.
+//' @param robust    A \code{boolean} indicating whether the robust estimator is used.
+//' @param eff       A \code{double} that indicates the efficiency of the robust estimator.
+//' @param alpha     A \code{double} that indicates the \eqn{\left(1-p\right)*\alpha}{(1-p)*alpha} confidence level
+//' @return A \code{field<mat>} with one matrix per sensor, or an empty \code{field} if no result matches.
+//' @details
+//' Only the small record headers following the data are visited, hence the look up does not depend
+//' on the length of the data.
+//' @keywords internal
+// [[Rcpp::export]]
+arma::field<arma::mat> read_wvar_cache_cpp(std::string file_path, std::string filter, std::string decomp,
+                                           unsigned int nlevels, bool robust, double eff, double alpha){
+
+  mapped_file fid(file_path);
+  const imu_cache_header& hdr = check_imu_cache(fid);
+
+  const char* found = NULL;
+  unsigned int found_channels = 0;
+
+  uint64_t pos = hdr.wv_offset;
+  while(pos <= fid.size() && sizeof(wvar_cache_record) <= fid.size() - pos){
+    wvar_cache_record rec;
+    memcpy(&rec, fid.data() + pos, sizeof(rec));
+
+    // Compared by division so that a corrupted count cannot overflow
+    uint64_t per_channel = uint64_t(rec.nlevels)*3*sizeof(double);
+    bool sized = per_channel == 0 ? rec.size == 0 :
+                 rec.size % per_channel == 0 && rec.size/per_channel == rec.n_channels;
+
+    // Subtracted rather than added since rec.size comes from the file
+    if(memcmp(rec.magic, wvar_cache_magic, sizeof(rec.magic)) != 0 || !sized ||
+       rec.size > fid.size() - pos - sizeof(rec)){
+      // An incomplete or corrupted record, e.g. left by an interrupted write, ends the cache
+      break;
+    }
+
+    // The latest matching record supersedes the earlier ones
+    if(wvar_cache_match(rec, filter, decomp, nlevels, robust, eff, alpha)){
+      found = fid.data() + pos + sizeof(rec);
+      found_channels = rec.n_channels;
+    }
+
+    pos += sizeof(rec) + rec.size;
+  }
+
+  if(found == NULL){
+    return arma::field<arma::mat>(0);
+  }
+
+  arma::field<arma::mat> out(found_channels);
+  const double* p = reinterpret_cast<const double*>(found);
+  for(unsigned int i = 0; i < out.n_elem; i++, p += nlevels*3){
+    out(i) = arma::mat(p, nlevels, 3);
+  }
+
+  return out;
+}
+
+/* --------------------- End IMU Cache Files ---------------------- */
@@ -0,0 +1,70 @@
+#ifndef IMU_CACHE
+#define IMU_CACHE
+
+#include <stdint.h>
+
+// Storage of a column within a cache file
+enum imu_cache_storage { IMU_CACHE_DOUBLE, IMU_CACHE_FLOAT, IMU_CACHE_DELTA16, IMU_CACHE_DELTA32 };
+
+// Fixed header at the start of a cache file, followed by n_cols column descriptors,
+// the columns themselves (each 8-byte aligned) and, from wv_offset, the cached wavelet variances.
+struct imu_cache_header{
+  char magic[8];            // "GMWMIMU"
+  uint32_t version;
+  uint32_t byte_order;      // 0x01020304 as stored by the writer
+  uint64_t n_rows;
+  uint32_t n_cols;          // time + sensors
+  uint32_t n_gyros;
+  uint32_t n_accels;
+  uint32_t encoding;        // 0 double, 1 float, 2 delta
+  double freq;
+  double scale_gyro;
+  double scale_acc;
+  char stype[32];
+  char unit[16];
+  uint64_t wv_offset;
+};
+
+struct imu_cache_column{
+  uint64_t offset;          // from the start of the file
+  uint32_t storage;         // imu_cache_storage
+  uint32_t reserved;
+  double quantum;           // delta: value of one count
+  double first;             // delta: counts of the first observation
+  char axis[8];
+};
+
+// Header of a cached wavelet variance, followed by n_channels matrices of nlevels x 3 doubles
+struct wvar_cache_record{
+  char magic[4];            // "WVC1"
+  uint32_t n_channels;
+  uint32_t nlevels;
+  uint32_t robust;
+  double eff;
+  double alpha;
+  char filter[16];
+  char decomp[16];
+  uint64_t size;            // bytes of the matrices
+};
+
+const imu_cache_header& check_imu_cache(const mapped_file& fid);
+
+void decode_cache_column(const char* base, const imu_cache_column& col, arma::uword n, double* out);
+
+void write_imu_cache(const std::string& file_path, const arma::mat& data, const arma::vec& stats,
+                     unsigned int n_gyros, unsigned int n_accels, const std::vector<std::string>& axis,
+                     const std::string& stype, const std::string& unit, const std::string& encoding);
+
+void write_imu_cache_cpp(std::string file_path, const arma::mat& data, const arma::vec& stats,
+                         std::vector<unsigned int> num_sensor, std::vector<std::string> axis,
+                         std::string stype, std::string unit, std::string encoding);
+
+Rcpp::List read_imu_cache_cpp(std::string file_path, bool data);
+
+void write_wvar_cache_cpp(std::string file_path, const arma::field<arma::mat>& wv,
+                          std::string filter, std::string decomp, bool robust, double eff, double alpha);
+
+arma::field<arma::mat> read_wvar_cache_cpp(std::string file_path, std::string filter, std::string decomp,
+                                           unsigned int nlevels, bool robust, double eff, double alpha);
+
+#endif
@@ -0,0 +1,232 @@
+#include <RcppArmadillo.h>
+#include <stdexcept>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+
+#include "imu_layout.h"
+
+/* ----------------------- Start IMU Record Layouts ------------------------ */
+
+// Storage size in bytes of a field type
+unsigned int imu_field_size(imu_field_type type){
+  switch(type){
+  case IMU_INT16:
+    return 2;
+  case IMU_INT32:
+  case IMU_FLOAT:
+    return 4;
+  default:
+    return 8;
+  }
+}
+
+// Helper function to fill the layout shared by all built-in sensors:
+// a double time stamp followed by 6 fields of data_type, with no header.
+void builtin_layout(imu_layout& imu, std::string name, imu_field_type data_type,
+                    double scale_gyro, double scale_acc){
+  unsigned int data_size = imu_field_size(data_type);
+
+  imu.name        = name;
+  imu.header_size = 0;
+  imu.record_size = 8 + 6*data_size;
+  imu.big_endian  = false;
+
+  imu.channels[0].offset = 0;
+  imu.channels[0].type   = IMU_DOUBLE;
+  for(unsigned int j = 1; j <= 6; j++){
+    imu.channels[j].offset = 8 + (j-1)*data_size;
+    imu.channels[j].type   = data_type;
+  }
+
+  imu.scale_gyro  = scale_gyro;
+  imu.scale_acc   = scale_acc;
+}
+
+// Helper function to create the layout of a supported sensor
+imu_layout get_imu_layout(std::string imu_type){
+
+  // Transform imu_type to capitals
+  transform(imu_type.begin(), imu_type.end(), imu_type.begin(), ::toupper);
+
+  // Create class definition
+  imu_layout imu;
+
+  // opted for if/else vs. map to save in constructing all imu types. so, O(n) instead of O(log(n)) =(
+  if(imu_type == "IMAR"){
+    builtin_layout(imu, "IMAR", IMU_INT32,
+                   0.10000000*M_PI/180.0/3600.0,  // Scale gyro to rad
+                   0.00152588/1000.0);            // scale accel to m/s
+  }else if(imu_type == "LN200"){
+    builtin_layout(imu, "LN200", IMU_INT32,
+                   1.0/2097152.0,                 // Scale gyro to rad
+                   1.0/16384.0);                  // scale accel to m/s
+  }else if(imu_type == "LN200IG"){
+    builtin_layout(imu, "LN200IG", IMU_INT32,
+                   1.0/524288.0,                  // Scale gyro to rad
+                   1.0/16384.0);                  // scale accel to m/s
+  }else if(imu_type == "IXSEA"){
+    builtin_layout(imu, "IXSEA", IMU_DOUBLE,
+                   M_PI/180.0/3600.0,             // Scale gyro to rad
+                   0.001);                        // scale accel to m/s
+  }else if(imu_type == "NAVCHIP_FLT"){
+    builtin_layout(imu, "NAVCHIP_FLT", IMU_DOUBLE,
+                   ((1.0/3600.0)/360.0)*2.0*M_PI, // Scale gyro to rad
+                   0.001);                        // scale accel to m/s
+  }else if(imu_type == "NAVCHIP_INT"){
+    builtin_layout(imu, "NAVCHIP_INT", IMU_INT32,
+                   0.00000625,                    // Scale gyro to rad
+                   0.0000390625);                 // scale accel to m/s
+  }else{
+    throw std::runtime_error("The IMU type "+ imu_type + " is not supported");
+  }
+
+  return imu;
+}
+
+// Helper function to convert a field type name
+imu_field_type imu_field_type_from_string(std::string type){
+  if(type == "int16"){
+    return IMU_INT16;
+  }else if(type == "int32"){
+    return IMU_INT32;
+  }else if(type == "float"){
+    return IMU_FLOAT;
+  }else if(type == "double"){
+    return IMU_DOUBLE;
+  }
+
+  throw std::runtime_error("The field type " + type + " is not supported. Use int16, int32, float or double.");
+}
+
+#ifndef GMWM_STANDALONE
+// Build a layout supplied from R (see imu_layout() in R/imu.R)
+imu_layout imu_layout_from_list(const Rcpp::List& layout){
+
+  imu_layout imu;
+
+  imu.name        = Rcpp::as<std::string>(layout["name"]);
+  imu.header_size = Rcpp::as<unsigned int>(layout["header_size"]);
+  imu.big_endian  = Rcpp::as<std::string>(layout["endian"]) == "big";
+  imu.scale_gyro  = Rcpp::as<double>(layout["scale_gyro"]);
+  imu.scale_acc   = Rcpp::as<double>(layout["scale_acc"]);
+
+  std::vector<unsigned int> offsets = Rcpp::as< std::vector<unsigned int> >(layout["offsets"]);
+  std::vector<std::string> types = Rcpp::as< std::vector<std::string> >(layout["types"]);
+
+  if(offsets.size() != 7 || types.size() != 7){
+    throw std::runtime_error("A layout requires an offset and a type for the time and each of the 6 channels.");
+  }
+
+  // Smallest record that holds every field
+  unsigned int min_size = 0;
+  for(unsigned int j = 0; j < 7; j++){
+    imu.channels[j].offset = offsets[j];
+    imu.channels[j].type   = imu_field_type_from_string(types[j]);
+    min_size = std::max(min_size, offsets[j] + imu_field_size(imu.channels[j].type));
+  }
+
+  imu.record_size = Rcpp::as<unsigned int>(layout["record_size"]);
+
+  if(imu.record_size == 0){
+    imu.record_size = min_size;
+  }else if(imu.record_size < min_size){
+    throw std::runtime_error("The record size of the layout is smaller than its fields.");
+  }
+
+  return imu;
+}
+
+// Layout of either a supported IMU type (string) or a layout supplied from R (list)
+imu_layout resolve_imu_layout(SEXP imu_type){
+  if(Rf_isString(imu_type)){
+    return get_imu_layout(Rcpp::as<std::string>(imu_type));
+  }
+  return imu_layout_from_list(Rcpp::List(imu_type));
+}
+#endif
+
+/* ----------------------- Decoders ------------------------ */
+
+// Whether the host stores numbers big-endian
+inline bool host_big_endian(){
+  const unsigned short one = 1;
+  return *(const unsigned char*)&one == 0;
+}
+
+// Reads a field stored at p, which need not be aligned, optionally reversing its byte order
+template <typename T, bool Swap>
+inline double read_field(const char* p){
+  char buf[sizeof(T)];
+  memcpy(buf, p, sizeof(T));
+  if(Swap){
+    std::reverse(buf, buf + sizeof(T));
+  }
+  T v;
+  memcpy(&v, buf, sizeof(T));
+  return double(v);
+}
+
+// Type-specialized decoder of one channel: no branching on the layout within the loop
+template <typename T, bool Swap>
+void decode_column(const char* records, unsigned int record_size, unsigned int offset,
+                   arma::uword count, double scale, double* out){
+  const char* p = records + offset;
+  for(arma::uword i = 0; i < count; i++, p += record_size){
+    out[i] = read_field<T, Swap>(p) * scale;
+  }
+}
+
+// Pick the decoder of a field type and byte order
+imu_column_decoder select_imu_decoder(imu_field_type type, bool big_endian){
+
+  bool swap = big_endian != host_big_endian();
+
+  switch(type){
+  case IMU_INT16:
+    return swap ? &decode_column<int16_t, true> : &decode_column<int16_t, false>;
+  case IMU_INT32:
+    return swap ? &decode_column<int32_t, true> : &decode_column<int32_t, false>;
+  case IMU_FLOAT:
+    return swap ? &decode_column<float, true> : &decode_column<float, false>;
+  default:
+    return swap ? &decode_column<double, true> : &decode_column<double, false>;
+  }
+}
+
+// Resolve the decoders and the scaling of each channel given the data rate
+imu_decoder make_imu_decoder(const imu_layout& layout, double fIMU){
+
+  imu_decoder dec;
+  dec.record_size = layout.record_size;
+
+  for(unsigned int j = 0; j < 7; j++){
+    dec.column[j] = select_imu_decoder(layout.channels[j].type, layout.big_endian);
+    dec.offset[j] = layout.channels[j].offset;
+  }
+
+  dec.scale[0] = 1.0;
+  for(unsigned int j = 1; j <= 6; j++){
+    dec.scale[j] = fIMU * ((j <= 3) ? layout.scale_gyro : layout.scale_acc);
+  }
+
+  return dec;
+}
+
+// Decode the time stamp of a single record
+double decode_imu_time(const imu_layout& layout, const char* record){
+  double t;
+  select_imu_decoder(layout.channels[0].type, layout.big_endian)(record, layout.record_size,
+                     layout.channels[0].offset, 1, 1.0, &t);
+  return t;
+}
+
+// Decode count records into the 7 columns of out, whose columns are ld elements apart
+void decode_imu_records(const imu_decoder& dec, const char* records, arma::uword count,
+                        double* out, arma::uword ld){
+  for(unsigned int j = 0; j < 7; j++){
+    dec.column[j](records, dec.record_size, dec.offset[j], count, dec.scale[j], out + j*ld);
+  }
+}
+
+/* --------------------- End IMU Record Layouts ---------------------- */
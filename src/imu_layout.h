@@ -0,0 +1,56 @@
+#ifndef IMU_LAYOUT
+#define IMU_LAYOUT
+
+// Storage type of a field within a binary record
+enum imu_field_type { IMU_INT16, IMU_INT32, IMU_FLOAT, IMU_DOUBLE };
+
+// Location of a channel within a binary record
+struct imu_field{
+  unsigned int offset;
+  imu_field_type type;
+};
+
+// Description of a binary IMU file.
+// Channel 0 is the time stamp, followed by the 3 gyroscopes and the 3 accelerometers.
+struct imu_layout{
+  std::string name;
+  unsigned int header_size;
+  unsigned int record_size;
+  bool big_endian;
+  imu_field channels[7];
+  double scale_gyro;
+  double scale_acc;
+};
+
+// Decodes one channel of count consecutive records into out, multiplying by scale
+typedef void (*imu_column_decoder)(const char* records, unsigned int record_size, unsigned int offset,
+                                   arma::uword count, double scale, double* out);
+
+// Decoders for all channels of a layout, resolved once per file
+struct imu_decoder{
+  imu_column_decoder column[7];
+  unsigned int offset[7];
+  double scale[7];
+  unsigned int record_size;
+};
+
+unsigned int imu_field_size(imu_field_type type);
+
+imu_layout get_imu_layout(std::string imu_type);
+
+#ifndef GMWM_STANDALONE
+imu_layout imu_layout_from_list(const Rcpp::List& layout);
+
+imu_layout resolve_imu_layout(SEXP imu_type);
+#endif
+
+imu_column_decoder select_imu_decoder(imu_field_type type, bool big_endian);
+
+imu_decoder make_imu_decoder(const imu_layout& layout, double fIMU);
+
+double decode_imu_time(const imu_layout& layout, const char* record);
+
+void decode_imu_records(const imu_decoder& dec, const char* records, arma::uword count,
+                        double* out, arma::uword ld);
+
+#endif
@@ -0,0 +1,337 @@
+#include <RcppArmadillo.h>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+#include "imu_layout.h"
+#include "imu_stream.h"
+#include "wave_variance.h"
+
+// 64-bit file positioning
+#ifdef _WIN32
+#define imu_fseek _fseeki64
+#define imu_ftell _ftelli64
+#else
+#define imu_fseek fseeko
+#define imu_ftell ftello
+#endif
+
+/* ----------------------- Start Streaming IMU Reader ------------------------ */
+
+// Helper function to open a file for binary reading with an informative error
+FILE* open_binary(const std::string& file_path){
+  // Open data file - need "r" to read, and "b" to indicate binary (o.w. fails on Windows)
+  FILE* fid = fopen(file_path.c_str(), "rb");
+
+  if (fid == NULL){
+    size_t found = file_path.find_last_of("/\\");
+    throw std::runtime_error("Cannot open the " + file_path.substr(found+1) + " at " + file_path.substr(0,found));
+  }
+
+  return fid;
+}
+
+// Count the epochs of a file and obtain its data rate from the first and last time stamp
+imu_file_info open_imu_file(const std::string& file_path, const imu_layout& layout){
+
+  FILE* fid = open_binary(file_path);
+
+  // Set cursor at end of file to obtain its size
+  imu_fseek(fid, 0, SEEK_END);
+  double lsize = imu_ftell(fid);
+
+  // Count epochs and control it
+  double nEpochs = (lsize - layout.header_size)/layout.record_size;
+
+  if(nEpochs < 0 || trunc(nEpochs) != nEpochs){
+    fclose(fid);
+    throw std::runtime_error("The file does not have the expected file size. Check the type of IMU or if the file is corrupted.");
+  }
+
+  if(nEpochs < 2){
+    fclose(fid);
+    throw std::runtime_error("The file must contain at least two epochs to determine the data rate.");
+  }
+
+  imu_file_info info;
+  info.n = nEpochs;
+
+  // Read the first and last record
+  std::vector<char> first(layout.record_size), last(layout.record_size);
+
+  imu_fseek(fid, layout.header_size, SEEK_SET);
+  bool ok = fread(&first[0], layout.record_size, 1, fid) == 1;
+
+  imu_fseek(fid, layout.header_size + (long long)(info.n - 1)*layout.record_size, SEEK_SET);
+  ok = ok && fread(&last[0], layout.record_size, 1, fid) == 1;
+
+  fclose(fid);
+
+  if(!ok){
+    throw std::runtime_error("Unable to read the time stamps of the file.");
+  }
+
+  // Data Rate: the mean of the time differences telescopes to the first and last time stamp
+  double t_first = decode_imu_time(layout, &first[0]);
+  double t_last = decode_imu_time(layout, &last[0]);
+
+  info.fIMU = round((info.n - 1)/(t_last - t_first));
+
+  return info;
+}
+
+imu_block_reader::imu_block_reader(const std::string& file_path, const imu_layout& layout,
+                                   const imu_decoder& dec, arma::uword n, arma::uword block) :
+  fid(open_binary(file_path)), header_size(layout.header_size), dec(dec), n(n), block(block),
+  raw(block*layout.record_size), current(7*block), loading(7*block) {}
+
+imu_block_reader::~imu_block_reader(){
+  // The background read must finish before the file is closed
+  if(pending.valid()){
+    pending.wait();
+  }
+  fclose(fid);
+}
+
+void imu_block_reader::prefetch(long long start){
+  pending = std::async(std::launch::async, &imu_block_reader::load, this, start);
+}
+
+const std::vector<double>& imu_block_reader::next(){
+  // Rethrows any error raised while reading
+  pending.get();
+  current.swap(loading);
+  return current;
+}
+
+// Read and decode the block starting at start into loading
+void imu_block_reader::load(long long start){
+
+  std::fill(loading.begin(), loading.end(), 0.0);
+
+  // Part of the block that lies within the file
+  long long first = std::max(start, 0LL);
+  long long end = std::min(start + (long long)block, (long long)n);
+
+  if(first >= end){
+    return;
+  }
+
+  arma::uword count = end - first;
+
+  imu_fseek(fid, header_size + first*dec.record_size, SEEK_SET);
+
+  if(fread(&raw[0], dec.record_size, count, fid) != count){
+    throw std::runtime_error("Unable to read the file.");
+  }
+
+  decode_imu_records(dec, &raw[0], count, &loading[first - start], block);
+}
+
+/* ----------------------- Streaming Wavelet Variance ------------------------ */
+
+// Helper to check for a power of two
+inline bool is_power_of_2(arma::uword x){
+  return x > 0 && (x & (x - 1)) == 0;
+}
+
+// Adds v to the running sum and the rounding error of the addition to comp (Knuth's two-sum),
+// so that sum + comp stays exact to working precision however many terms go in and out
+inline void compensated_add(double& sum, double& comp, double v){
+  double t = sum + v;
+  double bp = t - sum;
+  comp += (sum - (t - bp)) + (v - bp);
+  sum = t;
+}
+
+// Computes the Haar MODWT wavelet variance of the 6 channels of a file in a single pass.
+//
+// The level j Haar MODWT coefficient is the difference of the moving sums over the last 2^(j-1)
+// observations and the 2^(j-1) observations before them, divided by 2^j. Both moving sums are
+// updated with the observations lagged by 2^(j-1) and 2^j, with compensated additions since the
+// rounding errors would otherwise accumulate over the whole file. Lags up to history come from a ring
+// buffer, larger lags from additional readers trailing behind the main one in the same file.
+// The coefficients that the brick wall removes are exactly the ones needing observations before
+// the start of the file, so the result matches modwt_wvar_cpp with the haar filter.
+arma::field<arma::mat> stream_imu_wvar(const std::string& file_path, const imu_layout& layout,
+                                       unsigned int nlevels, double alpha,
+                                       arma::uword block, arma::uword history){
+
+  if(block == 0 || !is_power_of_2(history)){
+    Rcpp::stop("`block_size` must be positive and `history` must be a power of 2.");
+  }
+
+  imu_file_info info = open_imu_file(file_path, layout);
+  arma::uword n = info.n;
+
+  // Max number of levels by default
+  unsigned int mlevels = floor(log2(double(n)));
+  if(nlevels == 0){
+    nlevels = mlevels;
+  }
+
+  if(nlevels > mlevels){
+    Rcpp::stop("`nlevels` must be less than or equal to the max number of levels.");
+  }
+
+  imu_decoder dec = make_imu_decoder(layout, info.fIMU);
+
+  // Largest lag
+  arma::uword max_lag = arma::uword(1) << nlevels;
+
+  // Ring buffer of the last H observations of each channel
+  arma::uword H = std::min(history, max_lag);
+  std::vector<double> ring(6*H, 0.0);
+
+  // Readers: the main one, then one per lag that does not fit in the ring buffer
+  imu_block_reader reader(file_path, layout, dec, n, block);
+  reader.prefetch(0);
+
+  std::vector<arma::uword> far_lags;
+  for(arma::uword lag = H*2; lag <= max_lag; lag *= 2){
+    far_lags.push_back(lag);
+  }
+
+  std::vector<imu_block_reader*> lagged(far_lags.size(), (imu_block_reader*)NULL);
+
+  // Per level and channel: moving sums and their rounding errors, sum of squared coefficients
+  arma::mat sum_a = arma::zeros<arma::mat>(nlevels, 6);
+  arma::mat sum_b = arma::zeros<arma::mat>(nlevels, 6);
+  arma::mat err_a = arma::zeros<arma::mat>(nlevels, 6);
+  arma::mat err_b = arma::zeros<arma::mat>(nlevels, 6);
+  arma::mat ss = arma::zeros<arma::mat>(nlevels, 6);
+
+  // Observations lagged by 2^k, k = 0, ..., nlevels
+  std::vector<double> xl(nlevels + 1);
+  std::vector<const std::vector<double>*> far(far_lags.size());
+
+  try{
+    for(unsigned int k = 0; k < far_lags.size(); k++){
+      lagged[k] = new imu_block_reader(file_path, layout, dec, n, block);
+      lagged[k]->prefetch(-(long long)far_lags[k]);
+    }
+
+    for(arma::uword s = 0; s < n; s += block){
+
+      const std::vector<double>& cur = reader.next();
+      for(unsigned int k = 0; k < far_lags.size(); k++){
+        far[k] = &lagged[k]->next();
+      }
+
+      // Overlap the I/O of the next block with the computation on this one
+      if(s + block < n){
+        reader.prefetch(s + block);
+        for(unsigned int k = 0; k < far_lags.size(); k++){
+          lagged[k]->prefetch((long long)(s + block) - (long long)far_lags[k]);
+        }
+      }
+
+      arma::uword count = std::min(block, n - s);
+
+      for(unsigned int c = 0; c < 6; c++){
+        const double* x = &cur[(c+1)*block];
+        double* r = &ring[c*H];
+
+        for(arma::uword i = 0; i < count; i++){
+          arma::uword t = s + i;
+
+          // Gather the lagged observations
+          unsigned int k = 0;
+          for(arma::uword lag = 1; lag <= H; lag *= 2, k++){
+            xl[k] = (t >= lag) ? r[(t - lag) & (H - 1)] : 0.0;
+          }
+          for(unsigned int f = 0; f < far_lags.size(); f++, k++){
+            xl[k] = (*far[f])[(c+1)*block + i];
+          }
+
+          // Update each level
+          for(unsigned int j = 0; j < nlevels; j++){
+            compensated_add(sum_a(j,c), err_a(j,c), x[i]);
+            compensated_add(sum_a(j,c), err_a(j,c), -xl[j]);
+            compensated_add(sum_b(j,c), err_b(j,c), xl[j]);
+            compensated_add(sum_b(j,c), err_b(j,c), -xl[j+1]);
+
+            // Brick wall: drop the first 2^(j+1) - 1 coefficients
+            if(t + 1 >= (arma::uword(2) << j)){
+              double w = ((sum_a(j,c) + err_a(j,c)) - (sum_b(j,c) + err_b(j,c)))/double(arma::uword(2) << j);
+              ss(j,c) += w*w;
+            }
+          }
+
+          r[t & (H - 1)] = x[i];
+        }
+      }
+
+      // Allow the user to interrupt long files
+      Rcpp::checkUserInterrupt();
+    }
+  }catch(...){
+    for(unsigned int k = 0; k < lagged.size(); k++){
+      delete lagged[k];
+    }
+    throw;
+  }
+
+  for(unsigned int k = 0; k < lagged.size(); k++){
+    delete lagged[k];
+  }
+
+  // Number of coefficients kept by the brick wall at each level (a single one at the top level when n is a power of 2)
+  arma::vec dims(nlevels);
+  for(unsigned int j = 0; j < nlevels; j++){
+    arma::uword removed = (arma::uword(2) << j) - 1;
+    dims(j) = (removed < n) ? n - removed : 0;
+  }
+
+  arma::field<arma::mat> out(7);
+  for(unsigned int c = 0; c < 6; c++){
+    arma::vec wv = ss.col(c)/dims;
+    out(c) = ci_eta3(wv, dims, alpha/2.0);
+  }
+
+  arma::vec stats(4);
+  stats(0) = info.fIMU;
+  stats(1) = layout.scale_gyro;
+  stats(2) = layout.scale_acc;
+  stats(3) = n;
+  out(6) = stats;
+
+  return out;
+}
+
+//' @title Streaming Wavelet Variance of an IMU Binary File
+//'
+//' @description
+//' Computes the Haar MODWT wavelet variance of the 3 gyroscopes and 3 accelerometers of
+//' a binary IMU file without loading the file into memory.
+//'
+//' @param file_path  A \code{string} that contains the full file path.
+//' @param imu_type   A \code{string} that contains a supported IMU type or a \code{list} created by \code{\link{imu_layout}}.
+//' @param nlevels    An \code{integer} indicating the number of decomposition levels. Use 0 for the max number of levels.
+//' @param alpha      A \code{double} that indicates the \eqn{\left(1-p\right)*\alpha}{(1-p)*alpha} confidence level
+//' @param block_size An \code{integer} giving the number of records read at a time.
+//' @param history    An \code{integer} power of 2 giving the number of past records kept in memory.
+//' @return A \code{field<mat>} with 7 elements. The first 6 have the same structure as \code{\link{modwt_wvar_cpp}}
+//' for each channel. The last one contains the data rate, the gyroscope and accelerometer scales and the number of epochs.
+//' @details
+//' The file is read in blocks of \code{block_size} records. The next block is read and decoded on a background
+//' thread while the current one is processed. Each level of the decomposition is obtained from moving sums that
+//' need the observations lagged by \eqn{2^{j-1}}{2^(j-1)} and \eqn{2^j}{2^j}. Lags up to \code{history} are taken
+//' from memory and larger lags from additional sequential reads of the file. Memory is therefore proportional to
+//' \code{history} and \code{block_size} rather than to the length of the file.
+//'
+//' The result equals the classical wavelet variance obtained with \code{decomp = "modwt"}
+//' and \code{filter = "haar"} on the data returned by \code{\link{read_imu}}.
+//' @examples
+//' \dontrun{
+//' stream_imu_wvar_cpp("F:/Desktop/short_test_data.imu", "IXSEA", nlevels = 10, alpha = 0.05)
+//' }
+//' @keywords internal
+// [[Rcpp::export]]
+arma::field<arma::mat> stream_imu_wvar_cpp(std::string file_path, SEXP imu_type, unsigned int nlevels,
+                                           double alpha = 0.05, unsigned int block_size = 16384,
+                                           unsigned int history = 65536){
+  return stream_imu_wvar(file_path, resolve_imu_layout(imu_type), nlevels, alpha, block_size, history);
+}
+
+/* --------------------- End Streaming IMU Reader ---------------------- */
@@ -0,0 +1,56 @@
+#ifndef IMU_STREAM
+#define IMU_STREAM
+
+#include <cstdio>
+#include <vector>
+#include <future>
+
+// Size and data rate of a binary IMU file
+struct imu_file_info{
+  arma::uword n;
+  double fIMU;
+};
+
+imu_file_info open_imu_file(const std::string& file_path, const imu_layout& layout);
+
+// Reads blocks of decoded records from a binary IMU file.
+// The next block is read and decoded on a background thread while the current block is in use.
+class imu_block_reader{
+public:
+  imu_block_reader(const std::string& file_path, const imu_layout& layout, const imu_decoder& dec,
+                   arma::uword n, arma::uword block);
+  ~imu_block_reader();
+
+  // Queue the block of records starting at start. Records outside of the file are set to zero.
+  void prefetch(long long start);
+
+  // Wait for the queued block. Channel j of record i is at j*block + i.
+  const std::vector<double>& next();
+
+private:
+  // Non-copyable
+  imu_block_reader(const imu_block_reader&);
+  imu_block_reader& operator=(const imu_block_reader&);
+
+  void load(long long start);
+
+  FILE* fid;
+  unsigned int header_size;
+  imu_decoder dec;
+  arma::uword n;
+  arma::uword block;
+
+  std::vector<char> raw;
+  std::vector<double> current;
+  std::vector<double> loading;
+  std::future<void> pending;
+};
+
+arma::field<arma::mat> stream_imu_wvar(const std::string& file_path, const imu_layout& layout,
+                                       unsigned int nlevels, double alpha,
+                                       arma::uword block, arma::uword history);
+
+arma::field<arma::mat> stream_imu_wvar_cpp(std::string file_path, SEXP imu_type, unsigned int nlevels,
+                                           double alpha, unsigned int block_size, unsigned int history);
+
+#endif
@@ -1,5 +1,8 @@
 #include <RcppArmadillo.h>
 
+// Fitted models shared with model selection
+#include "fit_state.h"
+
 #include "inference.h"
 
 #include "bootstrappers.h"
@@ -27,6 +30,13 @@ arma::mat calculate_psi_matrix(const arma::mat& A, const arma::mat& v_hat, const
   return B*v_hat*arma::trans(B);
 }
 
+// Same as above with the A^T * omega of a fit
+arma::mat calculate_psi_matrix(const fit_state& fit, const arma::mat& v_hat){ 
+  arma::mat B = arma::pinv(fit.at_omega*fit.A)*fit.at_omega;
+  
+  return B*v_hat*arma::trans(B);
+}
+
 //' @title Format the Confidence Interval for Estimates
 //' @description Creates hi and lo confidence based on SE and alpha.
 //' @param theta A \code{vec} containing the estimates
@@ -81,6 +91,16 @@ arma::mat theta_ci(const arma::vec& theta,
   return format_ci(theta, se, alpha);
 }
 
+// Asymptotic CI of the estimates of a fit
+arma::mat theta_ci(const fit_state& fit, const arma::mat& v_hat, double alpha){
+
+  arma::mat psi = calculate_psi_matrix(fit, v_hat);
+  
+  arma::vec se = sqrt(diagvec(psi));
+
+  return format_ci(fit.theta, se, alpha);
+}
+
 
 //' @title Compute the GOF Test
 //' @description yaya
@@ -133,6 +153,36 @@ arma::vec gof_test(arma::vec theta,
   return out;
 }
 
+// Goodness of fit test of a fit. When the fit was optimised under the precision matrix v_hat_inv (the
+// inverse of v_hat), its estimates already minimise the statistic, which is then the objective function at
+// them. Otherwise the estimates are optimised again under v_hat, as by the exported gof_test.
+arma::vec gof_test(const fit_state& fit,
+                   const std::vector<std::string>& desc,
+                   const arma::field<arma::vec>& objdesc,
+                   std::string model_type,
+                   const arma::vec& tau,
+                   const arma::mat& v_hat, const arma::mat& v_hat_inv, const arma::vec& wv_empir){
+  
+  if(!arma::approx_equal(fit.omega, v_hat_inv, "reldiff", 1e-12)){
+    return gof_test(fit.theta, desc, objdesc, model_type, tau, v_hat, wv_empir);
+  }
+  
+  arma::vec dif = fit.theo - wv_empir;
+  
+  double test_stat = arma::as_scalar(trans(dif)*v_hat_inv*dif);
+    
+  unsigned int df = fit.theo.n_elem - fit.theta.n_elem;
+  
+  double p_value = 1.0 - R::pchisq(test_stat, df, true, false);
+
+  arma::vec out(3);
+  out(0) = test_stat;
+  out(1) = p_value;
+  out(2) = df;
+
+  return out;
+}
+
 //' @title Compute the Bootstrapped GoF Test
 //' @description Handles the bootstrap computation and the bootstrapped p-value.
 //' @param obj_value A \code{double} that contains the optimized objective function value.
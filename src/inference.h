@@ -3,6 +3,8 @@
 
 arma::mat calculate_psi_matrix(const arma::mat& A, const arma::mat& v_hat, const arma::mat& omega);
 
+arma::mat calculate_psi_matrix(const fit_state& fit, const arma::mat& v_hat);
+
 arma::mat format_ci(const arma::vec& theta,
                     const arma::vec& se,
                     double z);
@@ -11,12 +13,21 @@ arma::mat theta_ci(const arma::vec& theta,
                    const arma::mat& A, 
                    const arma::mat& v_hat, const arma::mat& omega, double alpha);
 
+arma::mat theta_ci(const fit_state& fit, const arma::mat& v_hat, double alpha);
+
 arma::vec gof_test(arma::vec theta, 
                    const std::vector<std::string>& desc,
                    const arma::field<arma::vec>& objdesc,
                    std::string model_type,
                    const arma::vec& tau,
                    const arma::mat& v_hat, const arma::vec& wv_empir);
+
+arma::vec gof_test(const fit_state& fit,
+                   const std::vector<std::string>& desc,
+                   const arma::field<arma::vec>& objdesc,
+                   std::string model_type,
+                   const arma::vec& tau,
+                   const arma::mat& v_hat, const arma::mat& v_hat_inv, const arma::vec& wv_empir);
   
 arma::vec bootstrap_gof_test(double obj_value, arma::vec bs_obj_values, double alpha, bool bs_gof_p_ci);
 #endif
@@ -0,0 +1,398 @@
+#include <RcppArmadillo.h>
+#include <Rversion.h>
+#include <stdexcept>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+
+#include "mapped_file.h"
+#include "imu_layout.h"
+#include "imu_cache.h"
+#include "read_imu.h"
+
+// ALTREP is available from R 3.5.0, but its header can only be used from C++ since R 3.6.0
+#if defined(R_VERSION) && R_VERSION >= R_Version(3, 6, 0)
+#define GMWM_ALTREP
+#include <R_ext/Altrep.h>
+#endif
+
+/* ----------------------- Start Lazy IMU Columns ------------------------ */
+
+// Columns [first, first + k) of a mapped IMU file (raw records) or IMU cache file, decoded on demand
+struct lazy_columns{
+  lazy_columns() : file(NULL), n(0), first(0), k(0), raw(false), fIMU(0), exposed(false) {}
+  ~lazy_columns(){ delete file; }
+
+  std::string file_path;
+  mapped_file* file;
+  arma::uword n;
+  unsigned int first;
+  unsigned int k;
+
+  // Raw records: data rate and decoder of each channel
+  bool raw;
+  imu_layout layout;
+  double fIMU;
+  imu_decoder dec;
+
+  // Cache file: column descriptors and the delta encoded columns decoded so far
+  std::vector<imu_cache_column> cols;
+  std::vector< std::vector<double> > decoded;
+
+  // Whether a writable pointer to the mapping was handed out
+  bool exposed;
+
+  // The exposed columns stored as adjacent doubles in a copy-on-write mapping, or NULL
+  double* contiguous() const{
+    if(raw){
+      return NULL;
+    }
+    for(unsigned int j = first; j < first + k; j++){
+      if(cols[j].storage != IMU_CACHE_DOUBLE ||
+         (j > first && cols[j].offset != cols[j-1].offset + n*sizeof(double))){
+        return NULL;
+      }
+    }
+    return reinterpret_cast<double*>(file->private_data() + cols[first].offset);
+  }
+
+  // Decode rows [start, start + count) of column j (absolute index) into out
+  void decode(unsigned int j, arma::uword start, arma::uword count, double* out){
+    if(raw){
+      const char* base = file->data() + layout.header_size + (size_t)start*layout.record_size;
+      dec.column[j](base, dec.record_size, dec.offset[j], count, dec.scale[j], out);
+      return;
+    }
+
+    const imu_cache_column& col = cols[j];
+    const char* p = file->data() + col.offset;
+
+    if(col.storage == IMU_CACHE_DOUBLE){
+      memcpy(out, p + start*sizeof(double), count*sizeof(double));
+    }else if(col.storage == IMU_CACHE_FLOAT){
+      const float* v = reinterpret_cast<const float*>(p) + start;
+      std::copy(v, v + count, out);
+    }else{
+      // Differences must be summed from the start: decode the whole column once
+      if(decoded[j].empty()){
+        decoded[j].resize(n);
+        decode_cache_column(file->data(), col, n, &decoded[j][0]);
+      }
+      std::copy(decoded[j].begin() + start, decoded[j].begin() + start + count, out);
+    }
+  }
+};
+
+// Open the columns [first, first + k) of a raw IMU file
+lazy_columns* open_lazy_raw(const std::string& file_path, const imu_layout& layout, unsigned int first, unsigned int k){
+  lazy_columns* src = new lazy_columns();
+  try{
+    src->file_path = file_path;
+    src->file = new mapped_file(file_path);
+    src->raw = true;
+    src->layout = layout;
+    src->first = first;
+    src->k = k;
+    src->n = count_imu_epochs(src->file->size(), layout);
+
+    const char* base = src->file->data() + layout.header_size;
+    double t_first = decode_imu_time(layout, base);
+    double t_last = decode_imu_time(layout, base + (size_t)(src->n - 1)*layout.record_size);
+    src->fIMU = round((src->n - 1)/(t_last - t_first));
+
+    src->dec = make_imu_decoder(layout, src->fIMU);
+  }catch(...){
+    delete src;
+    throw;
+  }
+  return src;
+}
+
+// Open the columns [first, first + k) of an IMU cache file.
+// The mapping is copy-on-write so that the columns stored as doubles can be handed out directly.
+lazy_columns* open_lazy_cache(const std::string& file_path, unsigned int first, unsigned int k){
+  lazy_columns* src = new lazy_columns();
+  try{
+    src->file_path = file_path;
+    src->file = new mapped_file(file_path, true);
+
+    const imu_cache_header& hdr = check_imu_cache(*src->file);
+    const imu_cache_column* cols = reinterpret_cast<const imu_cache_column*>(src->file->data() + sizeof(imu_cache_header));
+
+    src->cols.assign(cols, cols + hdr.n_cols);
+    src->decoded.resize(hdr.n_cols);
+    src->n = hdr.n_rows;
+    src->first = first;
+    src->k = k;
+  }catch(...){
+    delete src;
+    throw;
+  }
+  return src;
+}
+
+// Open the same columns again, for a copy of an object that was not modified
+lazy_columns* reopen_lazy_columns(const lazy_columns& src){
+  lazy_columns* out = src.raw ? open_lazy_raw(src.file_path, src.layout, src.first, src.k) :
+    open_lazy_cache(src.file_path, src.first, src.k);
+
+  if(out->n != src.n){
+    delete out;
+    throw std::runtime_error("The file " + src.file_path + " changed since it was read.");
+  }
+  return out;
+}
+
+#ifdef GMWM_ALTREP
+
+static R_altrep_class_t lazy_real_class;
+
+// Called for every element: avoid the bookkeeping of Rcpp::XPtr
+inline lazy_columns* lazy_source(SEXP x){
+  return static_cast<lazy_columns*>(R_ExternalPtrAddr(R_altrep_data1(x)));
+}
+
+// Wrap the columns into an ALTREP numeric vector that owns them
+SEXP make_lazy_vector(lazy_columns* src){
+  Rcpp::XPtr<lazy_columns> ptr(src, true);
+  return R_new_altrep(lazy_real_class, ptr, R_NilValue);
+}
+
+// Copy every column into an ordinary vector kept in data2, used from then on
+SEXP materialize_lazy(SEXP x){
+  SEXP data = R_altrep_data2(x);
+  if(data != R_NilValue){
+    return data;
+  }
+
+  lazy_columns* src = lazy_source(x);
+  data = PROTECT(Rf_allocVector(REALSXP, (R_xlen_t)src->n*src->k));
+
+  double* out = REAL(data);
+  for(unsigned int j = 0; j < src->k; j++){
+    src->decode(src->first + j, 0, src->n, out + (size_t)j*src->n);
+  }
+
+  R_set_altrep_data2(x, data);
+
+  // The decoded columns are no longer needed
+  std::vector< std::vector<double> >(src->decoded.size()).swap(src->decoded);
+
+  UNPROTECT(1);
+  return data;
+}
+
+R_xlen_t lazy_length(SEXP x){
+  lazy_columns* src = lazy_source(x);
+  return (R_xlen_t)src->n*src->k;
+}
+
+Rboolean lazy_inspect(SEXP x, int pre, int deep, int pvec, void (*inspect_subtree)(SEXP, int, int, int)){
+  lazy_columns* src = lazy_source(x);
+  Rprintf(" gmwm lazy IMU columns %u-%u of %s (%s)\n", src->first, src->first + src->k - 1, src->file_path.c_str(),
+          R_altrep_data2(x) != R_NilValue ? "materialized" : (src->contiguous() ? "mapped" : "decoded on access"));
+  return TRUE;
+}
+
+SEXP lazy_duplicate(SEXP x, Rboolean deep){
+  lazy_columns* src = lazy_source(x);
+
+  // The contents may differ from the file: let R copy them
+  if(R_altrep_data2(x) != R_NilValue || src->exposed){
+    return NULL;
+  }
+
+  lazy_columns* copy;
+  try{
+    copy = reopen_lazy_columns(*src);
+  }catch(std::exception& e){
+    return NULL;
+  }
+  return make_lazy_vector(copy);
+}
+
+void* lazy_dataptr(SEXP x, Rboolean writeable){
+  if(R_altrep_data2(x) == R_NilValue){
+    lazy_columns* src = lazy_source(x);
+    double* p = src->contiguous();
+    if(p != NULL){
+      // Writes go to private pages of the mapping, never to the file
+      src->exposed = src->exposed || writeable;
+      return p;
+    }
+  }
+  return REAL(materialize_lazy(x));
+}
+
+const void* lazy_dataptr_or_null(SEXP x){
+  SEXP data = R_altrep_data2(x);
+  if(data != R_NilValue){
+    return REAL(data);
+  }
+  return lazy_source(x)->contiguous();
+}
+
+double lazy_real_elt(SEXP x, R_xlen_t i){
+  const double* p = (const double*)lazy_dataptr_or_null(x);
+  if(p != NULL){
+    return p[i];
+  }
+  lazy_columns* src = lazy_source(x);
+  double v;
+  src->decode(src->first + i/src->n, i % src->n, 1, &v);
+  return v;
+}
+
+R_xlen_t lazy_real_get_region(SEXP x, R_xlen_t i, R_xlen_t n, double* buf){
+  R_xlen_t len = lazy_length(x);
+  n = std::min(n, len - i);
+
+  const double* p = (const double*)lazy_dataptr_or_null(x);
+  if(p != NULL){
+    std::copy(p + i, p + i + n, buf);
+    return n;
+  }
+
+  // Decode the part of each column within the region
+  lazy_columns* src = lazy_source(x);
+  R_xlen_t done = 0;
+  while(done < n){
+    R_xlen_t pos = i + done;
+    arma::uword row = pos % src->n;
+    arma::uword count = std::min((arma::uword)(n - done), src->n - row);
+    src->decode(src->first + pos/src->n, row, count, buf + done);
+    done += count;
+  }
+  return n;
+}
+
+#endif
+
+// Set the time stamps and the matrix of the other columns in out.
+// Rcpp vectors would request the data pointer, i.e. decode everything: only the C API is used.
+void lazy_imu_object(Rcpp::List& out, lazy_columns* time, lazy_columns* data){
+  arma::uword n = data->n;
+  unsigned int k = data->k;
+
+#ifdef GMWM_ALTREP
+  SEXP t = PROTECT(make_lazy_vector(time));
+  SEXP x = PROTECT(make_lazy_vector(data));
+#else
+  // Without ALTREP the columns are decoded right away
+  SEXP t = PROTECT(Rf_allocVector(REALSXP, n));
+  SEXP x = PROTECT(Rf_allocVector(REALSXP, (R_xlen_t)n*k));
+  time->decode(time->first, 0, n, REAL(t));
+  for(unsigned int j = 0; j < k; j++){
+    data->decode(data->first + j, 0, n, REAL(x) + (size_t)j*n);
+  }
+  delete time;
+  delete data;
+#endif
+
+  SEXP dim = PROTECT(Rf_allocVector(INTSXP, 2));
+  INTEGER(dim)[0] = n;
+  INTEGER(dim)[1] = k;
+  Rf_setAttrib(x, R_DimSymbol, dim);
+
+  out["time"] = t;
+  out["data"] = x;
+  UNPROTECT(3);
+}
+
+//' @title Read an IMU Binary File into R Lazily
+//'
+//' @description
+//' Maps a binary IMU file into memory and returns its channels without decoding them.
+//'
+//' @param file_path A \code{string} that contains the full file path.
+//' @param imu_type  A \code{string} that contains a supported IMU type (see \code{\link{read_imu}}) or a \code{list} created by \code{\link{imu_layout}}.
+//' @return A \code{list} with:
+//' \describe{
+//' \item{time}{The time stamps}
+//' \item{data}{A \code{matrix} with dimensions N x 6 of the 3 gyroscopes and 3 accelerometers}
+//' \item{stats}{The data rate, the gyroscope scale and the accelerometer scale as in \code{\link{read_imu}}}
+//' }
+//' @details
+//' The time stamps and the data are ALTREP vectors (R 3.6.0 or later): an element or a range of elements is decoded from
+//' the mapped file when it is accessed, so that inspecting one sensor only reads that sensor. Functions requiring the whole
+//' vector in memory, such as the C++ routines or a modification of the data, decode it once into an ordinary vector.
+//' With earlier versions of R the file is decoded right away.
+//' @keywords internal
+// [[Rcpp::export]]
+Rcpp::List read_imu_lazy(std::string file_path, SEXP imu_type){
+
+  imu_layout layout = resolve_imu_layout(imu_type);
+
+  lazy_columns* time = open_lazy_raw(file_path, layout, 0, 1);
+  lazy_columns* data;
+  try{
+    data = open_lazy_raw(file_path, layout, 1, 6);
+  }catch(...){
+    delete time;
+    throw;
+  }
+
+  arma::vec stats(3);
+  stats(0) = data->fIMU;
+  stats(1) = layout.scale_gyro;
+  stats(2) = layout.scale_acc;
+
+  Rcpp::List out = Rcpp::List::create(Rcpp::_["time"] = R_NilValue, Rcpp::_["data"] = R_NilValue,
+                                      Rcpp::_["stats"] = stats);
+  lazy_imu_object(out, time, data);
+  return out;
+}
+
+//' @title Read an IMU Cache File into R Lazily
+//'
+//' @description
+//' Maps a file written by \code{\link{write_imu_cache_cpp}} and returns its columns without reading them.
+//'
+//' @param file_path A \code{string} that contains the full file path.
+//' @return The same \code{list} as \code{\link{read_imu_cache_cpp}}, where \code{data} only holds the sensors
+//' and the time stamps are in \code{time}.
+//' @details
+//' The time stamps and the data are ALTREP vectors (R 3.6.0 or later). When the sensors are stored as doubles, the data
+//' points directly into a copy-on-write mapping of the file: C++ routines receive it without any copy, and
+//' modifying it from R only copies the modified pages, leaving the file untouched. Other encodings are decoded when
+//' accessed, one sensor at a time. With earlier versions of R the file is decoded right away.
+//' @keywords internal
+// [[Rcpp::export]]
+Rcpp::List read_imu_cache_lazy(std::string file_path){
+
+  Rcpp::List info = read_imu_cache_cpp(file_path, false);
+
+  lazy_columns* time = open_lazy_cache(file_path, 0, 1);
+  lazy_columns* data;
+  try{
+    data = open_lazy_cache(file_path, 1, time->cols.size() - 1);
+  }catch(...){
+    delete time;
+    throw;
+  }
+
+  Rcpp::List out = Rcpp::List::create(Rcpp::_["time"] = R_NilValue, Rcpp::_["data"] = R_NilValue,
+                                      Rcpp::_["stats"] = info["stats"], Rcpp::_["n"] = info["n"],
+                                      Rcpp::_["num.sensor"] = info["num.sensor"], Rcpp::_["axis"] = info["axis"],
+                                      Rcpp::_["stype"] = info["stype"], Rcpp::_["unit"] = info["unit"],
+                                      Rcpp::_["encoding"] = info["encoding"]);
+  lazy_imu_object(out, time, data);
+  return out;
+}
+
+// [[Rcpp::init]]
+void init_lazy_imu(DllInfo* dll){
+#ifdef GMWM_ALTREP
+  lazy_real_class = R_make_altreal_class("lazy_imu_real", "gmwm", dll);
+
+  R_set_altrep_Length_method(lazy_real_class, lazy_length);
+  R_set_altrep_Inspect_method(lazy_real_class, lazy_inspect);
+  R_set_altrep_Duplicate_method(lazy_real_class, lazy_duplicate);
+  R_set_altvec_Dataptr_method(lazy_real_class, lazy_dataptr);
+  R_set_altvec_Dataptr_or_null_method(lazy_real_class, lazy_dataptr_or_null);
+  R_set_altreal_Elt_method(lazy_real_class, lazy_real_elt);
+  R_set_altreal_Get_region_method(lazy_real_class, lazy_real_get_region);
+#endif
+}
+
+/* --------------------- End Lazy IMU Columns ---------------------- */
@@ -0,0 +1,117 @@
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "mapped_file.h"
+
+// Note: This file deliberately avoids the R headers so that it can include the OS headers.
+
+mapped_file::mapped_file(const std::string& file_path, bool copy_on_write) : ptr(NULL), len(0), cow(copy_on_write) {
+  
+  // Split the file name from the path for the error message.
+  size_t found = file_path.find_last_of("/\\");
+  std::string file_loc = file_path.substr(0,found);
+  std::string file_name = file_path.substr(found+1);
+  
+#ifdef _WIN32
+  
+  file_handle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  map_handle = NULL;
+  
+  if(file_handle == INVALID_HANDLE_VALUE){
+    throw std::runtime_error("Cannot open the " + file_name + " at " + file_loc);
+  }
+  
+  LARGE_INTEGER file_size;
+  if(!GetFileSizeEx((HANDLE)file_handle, &file_size)){
+    CloseHandle((HANDLE)file_handle);
+    throw std::runtime_error("Cannot determine the size of " + file_name);
+  }
+  
+  len = (size_t)file_size.QuadPart;
+  
+  // Windows cannot map an empty file
+  if(len == 0){
+    return;
+  }
+  
+  map_handle = CreateFileMappingA((HANDLE)file_handle, NULL, cow ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+  
+  if(map_handle == NULL){
+    CloseHandle((HANDLE)file_handle);
+    throw std::runtime_error("Cannot map " + file_name + " into memory");
+  }
+  
+  ptr = (const char*)MapViewOfFile((HANDLE)map_handle, cow ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+  
+  if(ptr == NULL){
+    CloseHandle((HANDLE)map_handle);
+    CloseHandle((HANDLE)file_handle);
+    throw std::runtime_error("Cannot map " + file_name + " into memory");
+  }
+  
+#else
+  
+  fd = open(file_path.c_str(), O_RDONLY);
+  
+  if(fd < 0){
+    throw std::runtime_error("Cannot open the " + file_name + " at " + file_loc);
+  }
+  
+  struct stat sb;
+  if(fstat(fd, &sb) != 0){
+    close(fd);
+    throw std::runtime_error("Cannot determine the size of " + file_name);
+  }
+  
+  len = (size_t)sb.st_size;
+  
+  // mmap cannot map an empty file
+  if(len == 0){
+    return;
+  }
+  
+  void* addr = mmap(NULL, len, cow ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+  
+  if(addr == MAP_FAILED){
+    close(fd);
+    throw std::runtime_error("Cannot map " + file_name + " into memory");
+  }
+  
+  ptr = (const char*)addr;
+  
+#endif
+}
+
+mapped_file::~mapped_file(){
+#ifdef _WIN32
+  if(ptr != NULL){
+    UnmapViewOfFile(ptr);
+  }
+  if(map_handle != NULL){
+    CloseHandle((HANDLE)map_handle);
+  }
+  CloseHandle((HANDLE)file_handle);
+#else
+  if(ptr != NULL){
+    munmap((void*)ptr, len);
+  }
+  close(fd);
+#endif
+}
+
+void mapped_file::advise_sequential() const{
+#if !defined(_WIN32) && defined(MADV_SEQUENTIAL)
+  if(ptr != NULL){
+    madvise((void*)ptr, len, MADV_SEQUENTIAL);
+  }
+#endif
+}
@@ -0,0 +1,42 @@
+#ifndef MAPPED_FILE
+#define MAPPED_FILE
+
+#include <string>
+#include <cstddef>
+
+// Read-only view of a file mapped into memory.
+// The mapping is released when the object goes out of scope.
+// A copy-on-write mapping may be written to: the modified pages become private to the
+// mapping and the file itself is never changed.
+class mapped_file{
+public:
+  explicit mapped_file(const std::string& file_path, bool copy_on_write = false);
+  ~mapped_file();
+  
+  const char* data() const { return ptr; }
+  size_t size() const { return len; }
+  
+  // Writable pointer to a copy-on-write mapping, NULL otherwise
+  char* private_data() const { return cow ? (char*)ptr : NULL; }
+  
+  // Hint that the file will be read front to back
+  void advise_sequential() const;
+  
+private:
+  // Non-copyable
+  mapped_file(const mapped_file&);
+  mapped_file& operator=(const mapped_file&);
+  
+  const char* ptr;
+  size_t len;
+  bool cow;
+  
+#ifdef _WIN32
+  void* file_handle;
+  void* map_handle;
+#else
+  int fd;
+#endif
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include <RcppArmadillo.h>
 
+#include "fit_state.h"
 #include "model_selection.h"
 
 // Needed for COV bootstrap
@@ -49,20 +50,31 @@ arma::mat B_matrix(const arma::mat& A, const arma::mat& at_omega){
 // [[Rcpp::export]]
 arma::vec model_score(arma::mat A, arma::mat D, arma::mat omega, arma::mat v_hat, double obj_value){
   
-  arma::mat At = arma::trans(A);
-  arma::mat B = B_matrix(A, At*omega);
+  fit_state fit;
+  fit.A = A;
+  fit.omega = omega;
+  fit.at_omega = arma::trans(A)*omega;
+  fit.obj_value = obj_value;
+  
+  return model_score(fit, D, v_hat);
+}
+
+// Model score of a fit, reusing its A and A^T * omega
+arma::vec model_score(const fit_state& fit, const arma::mat& D, const arma::mat& v_hat){
+  
+  arma::mat B = B_matrix(fit.A, fit.at_omega);
   
   arma::mat d_b = D-B;
 
   arma::mat db_t = arma::trans(d_b);
   
-  arma::mat dTheta = -1*arma::pinv(db_t * d_b)*db_t*At*omega;
+  arma::mat dTheta = -1*arma::pinv(db_t * d_b)*db_t*fit.at_omega;
 
   arma::vec score_info(2);
   
-  double optimism = 2.0*arma::as_scalar(arma::trace(A * dTheta * omega * v_hat));
+  double optimism = 2.0*arma::as_scalar(arma::trace(fit.A * dTheta * fit.omega * v_hat));
   
-  score_info(0) = obj_value + optimism;
+  score_info(0) = fit.obj_value + optimism;
   score_info(1) = optimism;
   
   // Return the score
@@ -5,4 +5,6 @@ arma::mat B_matrix(const arma::mat& A, const arma::mat& at_omega);
 
 arma::vec model_score(arma::mat A, arma::mat D, arma::mat omega, arma::mat v_hat, double obj_value);
 
+arma::vec model_score(const fit_state& fit, const arma::mat& D, const arma::mat& v_hat);
+
 #endif
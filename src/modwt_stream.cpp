@@ -0,0 +1,99 @@
+#include <RcppArmadillo.h>
+#include <vector>
+
+#include "modwt_stream.h"
+
+// select_filter
+#include "wv_filters.h"
+
+// ci_eta3
+#include "wave_variance.h"
+
+/* ----------------------- Start Incremental MODWT ------------------------ */
+
+modwt_stream::modwt_stream() : h0(0), h1(0), g0(0), g1(0), n(0) {}
+
+modwt_stream::modwt_stream(unsigned int nlevels) : n(0), history(nlevels), ss(nlevels, 0.0), count(nlevels, 0) {
+  arma::field<arma::vec> filter_info = select_filter("haar");
+
+  // Same transform as modwt_cpp
+  double transform_factor = sqrt(2.0);
+  arma::vec ht = filter_info(1) / transform_factor;
+  arma::vec gt = filter_info(2) / transform_factor;
+
+  h0 = ht(0);
+  h1 = ht(1);
+  g0 = gt(0);
+  g1 = gt(1);
+
+  for(unsigned int j = 0; j < nlevels; j++){
+    history[j].resize(1u << j);
+  }
+}
+
+void modwt_stream::push(const double* x, unsigned int m){
+  unsigned int J = history.size();
+
+  for(unsigned int i = 0; i < m; i++, n++){
+    unsigned int t = n;
+
+    // Scaling coefficient of the previous level at t (the signal at level 1)
+    double v = x[i];
+
+    for(unsigned int j = 0; j < J; j++){
+      std::vector<double>& ring = history[j];
+      unsigned int lag = ring.size();
+
+      // The previous level only has coefficients from t = lag - 1 onwards
+      if(t + 1 < lag){
+        break;
+      }
+
+      // Holds the previous level at t - lag once it exists
+      double& slot = ring[t & (lag - 1)];
+
+      // Brick wall: the first 2^(j+1) - 1 coefficients need data before the start of the series
+      if(t + 1 < 2*lag){
+        slot = v;
+        break;
+      }
+
+      double w = h0*v;
+      w += h1*slot;
+      double vj = g0*v;
+      vj += g1*slot;
+
+      slot = v;
+
+      ss[j] += w*w;
+      count[j]++;
+
+      v = vj;
+    }
+  }
+}
+
+unsigned int modwt_stream::levels() const{
+  return history.size();
+}
+
+unsigned int modwt_stream::size() const{
+  return n;
+}
+
+arma::mat modwt_stream::wvar(double alpha) const{
+  unsigned int J = history.size();
+
+  arma::vec y(J);
+  arma::vec dims(J);
+  for(unsigned int j = 0; j < J; j++){
+    // Same as brick_wall, which also empties a level left with a single coefficient
+    bool empty = count[j] <= 1;
+    dims(j) = empty ? 0 : count[j];
+    y(j) = empty ? arma::datum::nan : ss[j]/count[j];
+  }
+
+  return ci_eta3(y, dims, alpha/2.0);
+}
+
+/* ------------------------ End Incremental MODWT ------------------------- */
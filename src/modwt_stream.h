@@ -0,0 +1,40 @@
+#ifndef MODWT_STREAM
+#define MODWT_STREAM
+
+#include <vector>
+
+// Haar MODWT of a series that grows at its end.
+//
+// Keeps, for each level j, the last 2^(j-1) scaling coefficients of level j-1 (the signal for j = 1)
+// and the sum of the squared wavelet coefficients. Coefficients are produced by the pyramid algorithm
+// of modwt_cpp, only for the times the brick wall keeps. These never wrap around the periodic boundary,
+// so appending samples adds coefficients without changing the previous ones, and the coefficients
+// are the same as those of modwt_cpp on the whole series. The only exception is the single coefficient
+// of level j when the series has exactly 2^j samples: brick_wall removes it, so wvar() leaves that
+// level empty as well, while it is kept to be counted once more samples are appended.
+class modwt_stream{
+public:
+  modwt_stream();
+  explicit modwt_stream(unsigned int nlevels);
+
+  // Append n samples
+  void push(const double* x, unsigned int n);
+
+  unsigned int levels() const;
+
+  // Number of samples pushed
+  unsigned int size() const;
+
+  // Classical wavelet variance with its eta3 interval, laid out as wvar_cpp
+  arma::mat wvar(double alpha) const;
+
+private:
+  double h0, h1, g0, g1;
+
+  unsigned int n;
+  std::vector< std::vector<double> > history;  // Ring buffer of level j-1 scaling coefficients, indexed by t mod 2^(j-1)
+  std::vector<double> ss;                      // Sum of squared wavelet coefficients of each level
+  std::vector<unsigned int> count;             // Number of wavelet coefficients of each level
+};
+
+#endif
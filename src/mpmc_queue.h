@@ -0,0 +1,96 @@
+#ifndef MPMC_QUEUE
+#define MPMC_QUEUE
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+// Bounded lock-free multi-producer multi-consumer queue (D. Vyukov's array queue).
+// Each cell carries a sequence number telling whether it is free for the producer of a given
+// position or holds the element for the consumer of that position, so producers and consumers
+// only contend on their own counter. The capacity is rounded up to a power of 2 of at least 2,
+// so a queue may hold more elements than requested.
+template <typename T>
+class mpmc_queue{
+public:
+  explicit mpmc_queue(size_t capacity) : mask(round_pow2(capacity) - 1), cells(mask + 1) {
+    for(size_t i = 0; i <= mask; i++){
+      cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+  }
+
+  // Returns false when the queue is full
+  bool try_push(const T& value){
+    size_t pos = tail.load(std::memory_order_relaxed);
+    for(;;){
+      cell& c = cells[pos & mask];
+      size_t seq = c.seq.load(std::memory_order_acquire);
+      std::ptrdiff_t dif = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+      if(dif == 0){
+        if(tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+          c.value = value;
+          c.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      }else if(dif < 0){
+        return false;
+      }else{
+        pos = tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Returns false when the queue is empty
+  bool try_pop(T& value){
+    size_t pos = head.load(std::memory_order_relaxed);
+    for(;;){
+      cell& c = cells[pos & mask];
+      size_t seq = c.seq.load(std::memory_order_acquire);
+      std::ptrdiff_t dif = (std::ptrdiff_t)seq - (std::ptrdiff_t)(pos + 1);
+      if(dif == 0){
+        if(head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+          value = c.value;
+          c.seq.store(pos + mask + 1, std::memory_order_release);
+          return true;
+        }
+      }else if(dif < 0){
+        return false;
+      }else{
+        pos = head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  size_t capacity() const { return mask + 1; }
+
+private:
+  // Non-copyable
+  mpmc_queue(const mpmc_queue&);
+  mpmc_queue& operator=(const mpmc_queue&);
+
+  static size_t round_pow2(size_t x){
+    size_t p = 2;
+    while(p < x){
+      p <<= 1;
+    }
+    return p;
+  }
+
+  struct cell{
+    std::atomic<size_t> seq;
+    T value;
+  };
+
+  // Keep the counters on separate cache lines to avoid false sharing
+  const size_t mask;
+  std::vector<cell> cells;
+  char pad0[64];
+  std::atomic<size_t> head;
+  char pad1[64];
+  std::atomic<size_t> tail;
+  char pad2[64];
+};
+
+#endif
@@ -8,6 +8,15 @@
 // Uses the transform / untransform methods
 #include "transform_data.h"
 
+// The optimizer bypasses the process WV cache
+#include "wv_cache.h"
+
+// Minimises through the solver of the context
+#include "gmwm_context.h"
+
+// Times the minimisations and counts the evaluations
+#include "gmwm_profile.h"
+
 
 // Used Yannick's flattening technique on guessed starting values...
 double objFunStarting(const arma::vec& theta, 
@@ -78,45 +87,71 @@ double getObjFun(const arma::vec& theta,
     return objFun(transformed_theta, desc, objdesc, model_type, omega, wv_empir, tau);
 }
 
-/// [[Rcpp::export]]
+// Yannick's objective as a function of the transformed parameters alone
+class starting_objective : public objective_function{
+public:
+  starting_objective(const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, const std::string& model_type,
+                     const arma::vec& wv_empir, const arma::vec& tau)
+    : desc(desc), objdesc(objdesc), model_type(model_type), wv_empir(wv_empir), tau(tau) {}
+
+  double value(const arma::vec& theta){
+    profile_count(COUNT_OBJECTIVE);
+    return objFunStarting(theta, desc, objdesc, model_type, wv_empir, tau);
+  }
+
+private:
+  const std::vector<std::string>& desc;
+  const arma::field<arma::vec>& objdesc;
+  const std::string& model_type;
+  const arma::vec& wv_empir;
+  const arma::vec& tau;
+};
+
+// GMWM objective as a function of the transformed parameters alone
+class gmwm_objective : public objective_function{
+public:
+  gmwm_objective(const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, const std::string& model_type,
+                 const arma::mat& omega, const arma::vec& wv_empir, const arma::vec& tau)
+    : desc(desc), objdesc(objdesc), model_type(model_type), omega(omega), wv_empir(wv_empir), tau(tau) {}
+
+  double value(const arma::vec& theta){
+    profile_count(COUNT_OBJECTIVE);
+    return objFun(theta, desc, objdesc, model_type, omega, wv_empir, tau);
+  }
+
+private:
+  const std::vector<std::string>& desc;
+  const arma::field<arma::vec>& objdesc;
+  const std::string& model_type;
+  const arma::mat& omega;
+  const arma::vec& wv_empir;
+  const arma::vec& tau;
+};
+
+// Minimises Yannick's objective with the solver of the context
 arma::vec Rcpp_OptimStart(const arma::vec&  theta,
                           const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, std::string model_type,
                           const arma::vec& wv_empir, const arma::vec& tau){
-   Rcpp::Environment stats("package:stats"); 
-   Rcpp::Function optim = stats["optim"];    
-
-   Rcpp::List Opt=optim(Rcpp::_["par"] = theta,
-                        Rcpp::_["fn"]  = Rcpp::InternalFunction(&objFunStarting),
-                        Rcpp::_["method"] = "CG",
-                        Rcpp::_["desc"] = desc,
-                        Rcpp::_["objdesc"] = objdesc,
-                        Rcpp::_["model_type"] = model_type,
-                        Rcpp::_["wv_empir"] = wv_empir,
-                        Rcpp::_["tau"] = tau);
+   profile_timer timer(STAGE_OPTIM);
    
-   arma::vec out = Rcpp::as<arma::vec>(Opt[0]);
+   // Objective evaluations are at parameter values that do not recur
+   wv_cache_pause pause;
    
-   return out;
+   starting_objective f(desc, objdesc, model_type, wv_empir, tau);
+   
+   return current_context().solver->minimize(f, theta);
 }
 
-/// [[Rcpp::export]]
+// Minimises the GMWM objective with the solver of the context
 arma::vec Rcpp_Optim(const arma::vec&  theta, 
                      const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, std::string model_type,
                      const arma::mat& omega, const arma::vec& wv_empir, const arma::vec& tau){
-   Rcpp::Environment stats("package:stats"); 
-   Rcpp::Function optim = stats["optim"];    
-
-   Rcpp::List Opt=optim(Rcpp::_["par"] = theta,
-                        Rcpp::_["fn"]  = Rcpp::InternalFunction(&objFun),
-                        Rcpp::_["method"] = "CG",
-                        Rcpp::_["desc"] = desc,
-                        Rcpp::_["objdesc"] = objdesc,
-                        Rcpp::_["model_type"] = model_type,
-                        Rcpp::_["omega"] = omega,
-                        Rcpp::_["wv_empir"] = wv_empir,
-                        Rcpp::_["tau"] = tau);
+   profile_timer timer(STAGE_OPTIM);
+   
+   // Objective evaluations are at parameter values that do not recur
+   wv_cache_pause pause;
    
-   arma::vec out = Rcpp::as<arma::vec>(Opt[0]); 
+   gmwm_objective f(desc, objdesc, model_type, omega, wv_empir, tau);
    
-   return out;
+   return current_context().solver->minimize(f, theta);
 }
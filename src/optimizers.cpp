@@ -0,0 +1,246 @@
+#include <RcppArmadillo.h>
+#include <cfloat>
+#include <stdexcept>
+
+#include "optimizers.h"
+
+// Records the iterations and convergence of each minimisation
+#include "gmwm_profile.h"
+
+/* ----------------------- Start Native Optimizers ------------------------ */
+
+// Central differences with step ndeps, as optim does without a gradient
+void numeric_gradient(objective_function& f, const arma::vec& x, arma::vec& g, double ndeps){
+  arma::vec y = x;
+  for(unsigned int i = 0; i < x.n_elem; i++){
+    y(i) = x(i) + ndeps;
+    double val1 = f.value(y);
+    y(i) = x(i) - ndeps;
+    double val2 = f.value(y);
+    y(i) = x(i);
+
+    g(i) = (val1 - val2)/(2.0*ndeps);
+    if(!arma::is_finite(g(i))){
+      throw std::runtime_error("non-finite finite-difference value");
+    }
+  }
+}
+
+// Fletcher-Reeves conjugate gradients.
+// This is a port of cgmin, the "CG" method of optim, with its default controls. Like optim,
+// it returns the point of the last gradient evaluation. It does not use the R API, so it can
+// run on any thread.
+arma::vec cg_min(objective_function& f, const arma::vec& start,
+                 unsigned int maxit, double reltol, double ndeps){
+
+  const double stepredn = 0.2;
+  const double acctol = 0.0001;
+  const double reltest = 10.0;
+  const double setstep = 1.7;
+
+  unsigned int n = start.n_elem;
+
+  arma::vec B = start;
+  arma::vec X = start;
+  if(n == 0){
+    return X;
+  }
+
+  arma::vec c(n), g(n), t(n);
+
+  unsigned int cyclimit = n;
+  double tol = reltol * n * sqrt(reltol);
+
+  double fval = f.value(B);
+  if(!arma::is_finite(fval)){
+    throw std::runtime_error("Function cannot be evaluated at initial parameters");
+  }
+
+  double fmin = fval;
+  unsigned int gradcount = 0;
+  unsigned int cycle, count;
+  double G1;
+
+  do{
+    t.zeros();
+    c = B;
+
+    cycle = 0;
+    double oldstep = 1.0;
+    count = 0;
+
+    do{
+      cycle++;
+      count++;
+      gradcount++;
+      if(gradcount > maxit){
+        profile_optimizer(maxit, 1);
+        return X;
+      }
+
+      numeric_gradient(f, B, g, ndeps);
+
+      G1 = 0.0;
+      double G2 = 0.0;
+      for(unsigned int i = 0; i < n; i++){
+        X(i) = B(i);
+        G1 += g(i)*g(i);
+        G2 += c(i)*c(i);
+        c(i) = g(i);
+      }
+
+      double steplength = 1.0;
+
+      if(G1 > tol){
+        double G3 = (G2 > 0.0) ? G1/G2 : 1.0;
+
+        double gradproj = 0.0;
+        for(unsigned int i = 0; i < n; i++){
+          t(i) = t(i)*G3 - g(i);
+          gradproj += t(i)*g(i);
+        }
+
+        steplength = oldstep;
+
+        bool accpoint = false;
+        do{
+          count = 0;
+          for(unsigned int i = 0; i < n; i++){
+            B(i) = X(i) + steplength*t(i);
+            if(reltest + X(i) == reltest + B(i)){
+              count++;
+            }
+          }
+
+          if(count < n){
+            fval = f.value(B);
+            accpoint = arma::is_finite(fval) && fval <= fmin + gradproj*steplength*acctol;
+
+            if(!accpoint){
+              steplength *= stepredn;
+            }else{
+              fmin = fval;
+            }
+          }
+        }while(!(count == n || accpoint));
+
+        if(count < n){
+          double newstep = 2*(fval - fmin - gradproj*steplength);
+          if(newstep > 0){
+            newstep = -(gradproj*steplength*steplength/newstep);
+            B = X + newstep*t;
+
+            fmin = fval;
+            fval = f.value(B);
+            if(fval < fmin){
+              fmin = fval;
+            }else{
+              // Back to the best point
+              B = X + steplength*t;
+            }
+          }
+        }
+      }
+
+      oldstep = std::min(setstep*steplength, 1.0);
+    }while(count != n && G1 > tol && cycle != cyclimit);
+
+  }while(cycle != 1 || (count != n && G1 > tol));
+
+  profile_optimizer(gradcount, 0);
+  return X;
+}
+
+// Minimum of a function on an interval by golden section search and parabolic interpolation.
+// This is a port of Brent_fmin, used by optimize, with the same default tolerance.
+double brent_min(scalar_function& f, double lower, double upper, double tol){
+  // Squared inverse of the golden ratio
+  const double c = (3.0 - sqrt(5.0))*0.5;
+
+  double eps = sqrt(DBL_EPSILON);
+
+  double a = lower;
+  double b = upper;
+  double v = a + c*(b - a);
+  double w = v;
+  double x = v;
+
+  double d = 0.0;
+  double e = 0.0;
+  double fx = f.value(x);
+  double fv = fx;
+  double fw = fx;
+  double tol3 = tol/3.0;
+
+  for(;;){
+    double xm = (a + b)*0.5;
+    double tol1 = eps*fabs(x) + tol3;
+    double t2 = tol1*2.0;
+
+    // Stopping criterion
+    if(fabs(x - xm) <= t2 - (b - a)*0.5){
+      break;
+    }
+
+    double p = 0.0, q = 0.0, r = 0.0;
+    if(fabs(e) > tol1){
+      // Fit a parabola
+      r = (x - w)*(fx - fv);
+      q = (x - v)*(fx - fw);
+      p = (x - v)*q - (x - w)*r;
+      q = (q - r)*2.0;
+      if(q > 0.0){
+        p = -p;
+      }else{
+        q = -q;
+      }
+      r = e;
+      e = d;
+    }
+
+    double u;
+    if(fabs(p) >= fabs(q*0.5*r) || p <= q*(a - x) || p >= q*(b - x)){
+      // Golden section step
+      e = (x < xm) ? b - x : a - x;
+      d = c*e;
+    }else{
+      // Parabolic interpolation step
+      d = p/q;
+      u = x + d;
+
+      // f must not be evaluated too close to the bounds
+      if(u - a < t2 || b - u < t2){
+        d = (x >= xm) ? -tol1 : tol1;
+      }
+    }
+
+    // f must not be evaluated too close to x
+    if(fabs(d) >= tol1){
+      u = x + d;
+    }else if(d > 0.0){
+      u = x + tol1;
+    }else{
+      u = x - tol1;
+    }
+
+    double fu = f.value(u);
+
+    if(fu <= fx){
+      if(u < x) b = x; else a = x;
+      v = w; w = x; x = u;
+      fv = fw; fw = fx; fx = fu;
+    }else{
+      if(u < x) a = u; else b = u;
+      if(fu <= fw || w == x){
+        v = w; fv = fw;
+        w = u; fw = fu;
+      }else if(fu <= fv || v == x || v == w){
+        v = u; fv = fu;
+      }
+    }
+  }
+
+  return x;
+}
+
+/* ------------------------ End Native Optimizers ------------------------- */
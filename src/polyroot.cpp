@@ -212,13 +212,14 @@ std::vector< std::complex<double> > do_polyroot_cpp(const std::vector< std::comp
   
 
 // Global Variables (too many!)
+// Thread local so that roots can be found on several threads at once
 
-static int nn;
-static std::vector<double> pr, pi, hr, hi, qpr, qpi, qhr, qhi, shr, shi;
+static thread_local int nn;
+static thread_local std::vector<double> pr, pi, hr, hi, qpr, qpi, qhr, qhi, shr, shi;
 
-static double sr, si;
-static double tr, ti;
-static double pvr, pvi;
+static thread_local double sr, si;
+static thread_local double tr, ti;
+static thread_local double pvr, pvi;
 
 static const double eta =  DBL_EPSILON;
 static const double are = /* eta = */DBL_EPSILON;
@@ -230,9 +231,9 @@ void polyroot_cpp(const std::vector<double> &opr, const std::vector<double> &opi
 {
   static const double smalno = DBL_MIN;
   static const double base = (double)FLT_RADIX;
-  static int d_n, i, i1, i2;
-  static double zi, zr, xx, yy;
-  static double bnd, xxx;
+  static thread_local int d_n, i, i1, i2;
+  static thread_local double zi, zr, xx, yy;
+  static thread_local double bnd, xxx;
   bool conv;
   int d1;
   static const double cosr =/* cos 94 */ -0.06975647374412529990;
@@ -422,9 +423,9 @@ bool fxshft_cpp(const int l2, double &zr, double &zi)
 
   
   bool pasd, bol, test;
-  static double svsi, svsr;
-  static int i, j, n;
-  static double oti, otr;
+  static thread_local double svsi, svsr;
+  static thread_local int i, j, n;
+  static thread_local double oti, otr;
   
   n = nn - 1;
   
@@ -517,9 +518,9 @@ bool vrshft_cpp(const int l3, double &zr, double &zi)
   * Assign and uses  GLOBAL sr, si
   */
   bool bol, b;
-  static int i, j;
-  static double r1, r2, mp, ms, tp, relstp;
-  static double omp;
+  static thread_local int i, j;
+  static thread_local double r1, r2, mp, ms, tp, relstp;
+  static thread_local double omp;
   
   b = false;
   sr = zr;
@@ -791,7 +792,7 @@ double cpoly_scale_cpp(const int n, std::vector<double> &pot,
           sc = 1.0;
       }
       ell = (int) (log(sc) / log(base) + 0.5);
-      return R_pow_di(base, ell);
+      return R_pow_di_cpp(base, ell);
     }
     else return 1.0;
   }
@@ -10,6 +10,9 @@
 // Needed for sarma model support
 #include "sarma.h"
 
+// Memoisation of the per-process WV
+#include "wv_cache.h"
+
 /* ----------------------------- Start Process to WV Functions ------------------------------- */
 
 //' ARMA process to WV
@@ -331,6 +334,61 @@ arma::vec dr_to_wv(double omega, const arma::vec& tau){
 	return square(omega)*arma::square(tau)/16.0;
 }
 
+//' @title Number of Parameters of a Process
+//' @description Number of parameters taken by a process with a fixed number of parameters.
+//' @param type A \code{string} containing the descriptor of the process.
+//' @return An \code{unsigned int} with the number of parameters or 0 for (S)ARMA processes.
+//' @keywords internal
+unsigned int process_param_count(const std::string& type){
+  if(type == "AR1" || type == "GM" || type == "MA1"){
+    return 2;
+  }else if(type == "ARMA11"){
+    return 3;
+  }else if(type == "WN" || type == "DR" || type == "QN" || type == "RW"){
+    return 1;
+  }
+  return 0;
+}
+
+//' @title WV of a Single Process
+//' @description Computes the theoretical WV of a process with a fixed number of parameters.
+//' The result is memoised while a \code{wv_cache_scope} is active.
+//' @param type  A \code{string} containing the descriptor of the process.
+//' @param theta A \code{vec} containing the parameters of the model.
+//' @param start An \code{unsigned int} giving the position of the first parameter of the process.
+//' @template misc/tau
+//' @return A \code{vec} containing the wavelet variance of the process.
+//' @keywords internal
+arma::vec process_wv(const std::string& type, const arma::vec& theta, unsigned int start, const arma::vec& tau){
+  unsigned int n = process_param_count(type);
+  
+  arma::mat cached;
+  if(wv_cache_get(WV_CACHE_WV, type, theta, start, n, tau, cached)){
+    return cached;
+  }
+  
+  arma::vec wv;
+  if(type == "AR1" || type == "GM"){
+    wv = ar1_to_wv(theta(start), theta(start + 1), tau);
+  }else if(type == "MA1"){
+    wv = ma1_to_wv(theta(start), theta(start + 1), tau);
+  }else if(type == "ARMA11"){
+    wv = arma11_to_wv(theta(start), theta(start + 1), theta(start + 2), tau);
+  }else if(type == "WN"){
+    wv = wn_to_wv(theta(start), tau);
+  }else if(type == "DR"){
+    wv = dr_to_wv(theta(start), tau);
+  }else if(type == "QN"){
+    wv = qn_to_wv(theta(start), tau);
+  }else{ // RW
+    wv = rw_to_wv(theta(start), tau);
+  }
+  
+  wv_cache_put(WV_CACHE_WV, type, theta, start, n, tau, wv);
+  
+  return wv;
+}
+
 //' Model Process to WV
 //' 
 //' This function computes the summation of all Processes to WV (haar) in a given model
@@ -357,51 +415,15 @@ arma::vec theoretical_wv(const arma::vec& theta,
   unsigned int i_theta = 0;
   for(unsigned int i = 0; i < num_desc; i++){
   
-    double theta_value = theta(i_theta);
-    
     std::string element_type = desc[i];
+    unsigned int n_params = process_param_count(element_type);
     
-    // AR 1
-    if(element_type == "AR1" || element_type == "GM"){
-
-      ++i_theta;
-      double sig2 = theta(i_theta);
-      
-      // Compute theoretical WV
-      wv_theo += ar1_to_wv(theta_value, sig2, tau);
-    }
-    else if(element_type == "MA1"){
-      ++i_theta;
-      double sig2 = theta(i_theta);
+    // Processes with a fixed number of parameters (AR1, GM, MA1, ARMA11, WN, DR, QN, RW)
+    if(n_params > 0){
+      wv_theo += process_wv(element_type, theta, i_theta, tau);
       
-      // Compute theoretical WV
-      wv_theo += ma1_to_wv(theta_value, sig2, tau);
-    }
-    // WN
-    else if(element_type == "WN"){
-      wv_theo += wn_to_wv(theta_value, tau);
-    }
-    // DR
-    else if(element_type == "DR"){
-      wv_theo += dr_to_wv(theta_value, tau);
-    }
-    // QN
-    else if(element_type == "QN"){
-      wv_theo += qn_to_wv(theta_value, tau);
-    }
-    // RW
-    else if(element_type == "RW"){
-      wv_theo += rw_to_wv(theta_value, tau);
-    }
-    // ARMA11
-    else if(element_type == "ARMA11"){
-      ++i_theta;
-      double th = theta(i_theta);
-      
-      ++i_theta;
-      double sig2 = theta(i_theta);
-      
-      wv_theo += arma11_to_wv(theta_value, th, sig2, tau);
+      // Move to the last parameter of the process
+      i_theta += n_params - 1;
     }
     else { // ARMA
       
@@ -459,54 +481,15 @@ arma::mat decomp_theoretical_wv(const arma::vec& theta,
   unsigned int i_theta = 0;
   for(unsigned int i = 0; i < num_desc; i++){
     
-    // Add ARMA
-  
-    double theta_value = theta(i_theta);
-    
     std::string element_type = desc[i];
+    unsigned int n_params = process_param_count(element_type);
     
-    // AR 1
-    if(element_type == "AR1" || element_type == "GM"){
-
-      ++i_theta;
-      double sig2 = theta(i_theta);
-      
-      // Compute theoretical WV
-      wv_theo.col(i) = ar1_to_wv(theta_value, sig2, tau);
-    }
-    // MA1 
-    else if(element_type == "MA1"){
-      
-      ++i_theta;
-      double sig2 = theta(i_theta);
-      
-      // Compute theoretical WV
-      wv_theo.col(i) = ma1_to_wv(theta_value, sig2, tau);
-    }
-    // WN
-    else if(element_type == "WN"){
-      wv_theo.col(i) = wn_to_wv(theta_value, tau);
-    }// DR
-    else if(element_type == "DR"){
-      wv_theo.col(i) = dr_to_wv(theta_value, tau);
-    }
-    // QN
-    else if(element_type == "QN"){
-      wv_theo.col(i) = qn_to_wv(theta_value, tau);
-    }
-    // RW
-    else if(element_type == "RW"){
-      wv_theo.col(i) = rw_to_wv(theta_value, tau);
-    }
-    // ARMA11
-    else if(element_type == "ARMA11"){
-      ++i_theta;
-      double th = theta(i_theta);
-    
-      ++i_theta;
-      double sig2 = theta(i_theta);
+    // Processes with a fixed number of parameters (AR1, GM, MA1, ARMA11, WN, DR, QN, RW)
+    if(n_params > 0){
+      wv_theo.col(i) = process_wv(element_type, theta, i_theta, tau);
       
-      wv_theo.col(i) = arma11_to_wv(theta_value, th, sig2, tau);
+      // Move to the last parameter of the process
+      i_theta += n_params - 1;
     }
     else { // "SARIMA"
       
@@ -17,6 +17,10 @@ arma::vec rw_to_wv(double gamma2, const arma::vec& tau);
 
 arma::vec dr_to_wv(double omega, const arma::vec& tau);
 
+unsigned int process_param_count(const std::string& type);
+
+arma::vec process_wv(const std::string& type, const arma::vec& theta, unsigned int start, const arma::vec& tau);
+
 arma::vec theoretical_wv(const arma::vec& theta, 
                          const std::vector<std::string>& desc,
                          const arma::field<arma::vec>& objdesc, const arma::vec& tau);
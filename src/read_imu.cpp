@@ -5,76 +5,172 @@
 #include <string.h>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 
-#include "rtoarmadillo.h"
+#include "mapped_file.h"
+#include "imu_layout.h"
+#include "read_imu.h"
 
-// Format for sensor information
-struct imu_info{
-  std::string name;
-  int time_type;
-  int data_type;
-  int header_size;
-  double scale_gyro;
-  double scale_acc;
-};
+// Messages go to the logger of the context
+#include "gmwm_context.h"
 
-// Helper function to create the data structure needed
-imu_info get_imu_info(std::string imu_type){
-  
-  // Transform imu_type to capitals
-  transform(imu_type.begin(), imu_type.end(), imu_type.begin(), ::toupper);
-  
-  // Create class definition
-  imu_info imu;
-  
-  // opted for if/else vs. map to save in constructing all imu types. so, O(n) instead of O(log(n)) =(
-  if(imu_type == "IMAR"){
-    imu.name          = "IMAR";
-    imu.time_type     = 8; // double
-    imu.data_type     = 4; // int
-    imu.header_size   = 0;
-    imu.scale_gyro    = 0.10000000*M_PI/180.0/3600.0; // Scale gyro to rad
-    imu.scale_acc     = 0.00152588/1000.0;            // scale accel to m/s
-  }else if(imu_type == "LN200"){
-    imu.name          = "LN200";
-    imu.time_type     = 8; // double
-    imu.data_type     = 4; // int
-    imu.header_size   = 0;
-    imu.scale_gyro    = 1.0/2097152.0; // Scale gyro to rad
-    imu.scale_acc     = 1.0/16384.0;	 // scale accel to m/s
-  }else if(imu_type == "LN200IG"){
-    imu.name          = "LN200IG";
-    imu.time_type     = 8; // double
-    imu.data_type     = 4; // int
-    imu.header_size   = 0;
-    imu.scale_gyro    = 1.0/524288.0;    // Scale gyro to rad
-    imu.scale_acc     = 1.0/16384.0;		 // scale accel to m/s
-  }else if(imu_type == "IXSEA"){
-    imu.name          = "IXSEA";
-    imu.time_type     = 8; // double
-    imu.data_type     = 8; // double
-    imu.header_size   = 0;
-    imu.scale_gyro    = M_PI/180.0/3600.0; // Scale gyro to rad
-    imu.scale_acc     = 0.001;		      	 // scale accel to m/s
-  }else if(imu_type == "NAVCHIP_FLT"){
-    imu.name          = "NAVCHIP_FLT";
-    imu.time_type     = 8; // double
-    imu.data_type     = 8; // double
-    imu.header_size   = 0;
-    imu.scale_gyro    = ((1.0/3600.0)/360.0)*2.0*M_PI; // Scale gyro to rad
-    imu.scale_acc     = 0.001;			                   // scale accel to m/s
-  }else if(imu_type == "NAVCHIP_INT"){
-    imu.name          = "NAVCHIP_INT";
-    imu.time_type     = 8; // double
-    imu.data_type     = 4; // int
-    imu.header_size   = 0;
-    imu.scale_gyro    = 0.00000625;       // Scale gyro to rad
-    imu.scale_acc     = 0.0000390625;			// scale accel to m/s
+// Blocks of records are traced
+#include "gmwm_trace.h"
+
+// Charges the decoded records
+#include "gmwm_memory.h"
+
+// Number of records of a file of lsize bytes
+arma::uword count_imu_epochs(double lsize, const imu_layout& imu){
+  
+  // Count epochs and control it
+  double nEpochs = (lsize-imu.header_size)/imu.record_size;
+  
+  // Is nEpochs an integer? 
+  if(nEpochs < 0 || trunc(nEpochs) != nEpochs){
+    throw std::runtime_error("The file does not have the expected file size. Check the type of IMU or if the file is corrupted.");
+  } 
+  
+  if(nEpochs < 2){
+    throw std::runtime_error("The file must contain at least two epochs to determine the data rate.");
+  }
+  
+  return nEpochs;
+}
+
+// Decode every record of a mapped IMU file described by layout.
+// With decimate > 1, each run of decimate records is averaged while decoding: only a block of records
+// per thread is held at full rate and a trailing incomplete run is dropped.
+// No R API is used, so this may be called from worker threads (with parallel = false).
+arma::field<arma::mat> decode_imu_file(const mapped_file& fid, const imu_layout& imu, bool parallel,
+                                       unsigned int decimate) {
+  
+  trace_scope trace("decode_imu_file", "read_imu");
+  
+  // BitsPerEpoch
+  unsigned int BitsPerEpoch = imu.record_size;
+  
+  arma::uword n = count_imu_epochs(fid.size(), imu);
+  
+  if(decimate == 0 || decimate > n){
+    throw std::runtime_error("The decimation factor must be between 1 and the number of epochs.");
+  }
+  
+  // Skip header if it exists
+  const char* base = fid.data() + imu.header_size;
+  
+  // Data Rate: the mean of the time differences telescopes to the first and last time stamp
+  double t_first = decode_imu_time(imu, base);
+  double t_last = decode_imu_time(imu, base + (size_t)(n-1)*BitsPerEpoch);
+  
+  double fIMU = (n-1)/(t_last - t_first);
+  
+  fIMU = round(fIMU); 
+  
+  // Resolve the decoder of each channel once for the whole file
+  imu_decoder dec = make_imu_decoder(imu, fIMU);
+  
+  // -- Decode
+  
+  // Initialize data matrix
+  arma::uword n_out = n/decimate;
+  memory_charge records(MEMORY_IMU, memory_doubles(7.0*n_out), "read_imu");
+  arma::mat data(n_out,7);
+  double* out = data.memptr();
+  
+  // Records are decoded in blocks small enough to stay in cache while each column is written contiguously
+  const arma::uword block = 4096;
+  
+  if(decimate == 1){
+    int n_blocks = (n + block - 1)/block;
+    
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if(parallel)
+#endif
+    for(int b = 0; b < n_blocks; b++){
+      trace_scope trace_block("imu_block", "read_imu", b);
+      
+      arma::uword start = b*block;
+      arma::uword count = std::min(block, n - start);
+      
+      decode_imu_records(dec, base + (size_t)start*BitsPerEpoch, count, out + start, n);
+    }
   }else{
-    throw std::runtime_error("The IMU type "+ imu_type + " is not supported");
+    // Output rows per block, so that a block holds about the same number of records as above
+    arma::uword rows = std::max(block/decimate, arma::uword(1));
+    int n_blocks = (n_out + rows - 1)/rows;
+    
+#ifdef _OPENMP
+    #pragma omp parallel if(parallel)
+#endif
+    {
+      std::vector<double> buf(7*rows*decimate);
+      
+#ifdef _OPENMP
+      #pragma omp for schedule(static)
+#endif
+      for(int b = 0; b < n_blocks; b++){
+        trace_scope trace_block("imu_block", "read_imu", b);
+        
+        arma::uword start = b*rows;
+        arma::uword count = std::min(rows, n_out - start);
+        arma::uword ld = count*decimate;
+        
+        decode_imu_records(dec, base + (size_t)start*decimate*BitsPerEpoch, ld, &buf[0], ld);
+        
+        // Block averages of each channel, the time included
+        for(unsigned int j = 0; j < 7; j++){
+          const double* x = &buf[j*ld];
+          double* o = out + j*n_out + start;
+          for(arma::uword i = 0; i < count; i++, x += decimate){
+            double sum = 0;
+            for(unsigned int k = 0; k < decimate; k++){
+              sum += x[k];
+            }
+            o[i] = sum/decimate;
+          }
+        }
+      }
+    }
   }
   
-  return imu;
+  arma::vec stats(3);
+  stats(0) = fIMU/decimate;
+  stats(1) = imu.scale_gyro;
+  stats(2) = imu.scale_acc;
+  
+  arma::field<arma::mat> out_field(2);
+  out_field(0).swap(data);    // No second copy of the records
+  out_field(1) = stats;
+  return out_field;
+}
+
+// Read a binary IMU file described by layout
+arma::field<arma::mat> read_imu_file(const std::string& file_path, const imu_layout& imu, unsigned int decimate) {
+  
+  // -- File Operations
+  
+  // Split the file name from the path.
+  size_t found = file_path.find_last_of("/\\");
+  
+  std::string file_name = file_path.substr(found+1);
+  
+  // Map the file into memory (throws if the file cannot be opened)
+  mapped_file fid(file_path);
+  fid.advise_sequential();
+  
+  arma::uword n = count_imu_epochs(fid.size(), imu);
+  
+  // display info to command window
+  log_line() << file_name <<  " contains " << (long long)n << " epochs ";
+  
+  if(decimate > 1){
+    log_line() << "Reading and averaging every " << decimate << " epochs ...";
+  }else{
+    log_line() << "Reading ...";
+  }
+  
+  return decode_imu_file(fid, imu, true, decimate);
 }
 
 //' @title Read an IMU Binary File into R
@@ -85,6 +181,7 @@ imu_info get_imu_info(std::string imu_type){
 //' 
 //' @param file_path A \code{string} that contains the full file path.
 //' @param imu_type A \code{string} that contains a supported IMU type given below.
+//' @param decimate An \code{integer} giving the number of consecutive epochs averaged into one.
 //' @details
 //' Currently supports the following IMUs:
 //' \itemize{
@@ -97,6 +194,15 @@ imu_info get_imu_info(std::string imu_type){
 //' }
 //' 
 //' We hope to soon be able to support delimited files.
+//'
+//' The file is memory-mapped and decoded in blocks directly into the columns of the result,
+//' with the sensor scaling applied in the same pass. Blocks are decoded in parallel when OpenMP is available.
+//'
+//' When \code{decimate} is greater than 1, each block is averaged as soon as it is decoded, so the full rate data is
+//' never held in memory. The result has \code{floor(N/decimate)} rows, each the mean of \code{decimate} consecutive
+//' epochs (time included), and the returned data rate is divided by \code{decimate}. With the Haar filter this is the
+//' scaling-filter (pyramid) step of the DWT up to a constant when \code{decimate} is a power of 2, so wavelet variances
+//' computed on the result have the scales of the levels beyond \eqn{\log_2}{log2}(\code{decimate}).
 //' @return A matrix with dimensions N x 7, where the columns represent:
 //' \describe{
 //' \item{Col 0}{Time}
@@ -118,115 +224,33 @@ imu_info get_imu_info(std::string imu_type){
 //' }
 //' @keywords internal
 // [[Rcpp::export]]
-arma::field<arma::mat> read_imu(std::string file_path, std::string imu_type) {
-  
-  // -- File Operations
-  
-  // Split the file name from the path.
-  size_t found = file_path.find_last_of("/\\");
-  
-  std::string file_loc = file_path.substr(0,found);
-  std::string file_name = file_path.substr(found+1);
-  
-  // Open data file - need "r" to read, and "b" to indicate binary (o.w. fails on Windows)
-  FILE *fid = fopen((char*)file_path.c_str(),"rb");
-  
-  if (fid == NULL){
-    throw std::runtime_error("Cannot open the " + file_name + " at " + file_loc);
-  }
-  
-  // -- Check IMU Type requested
-  
-  // Get data structure
-  imu_info imu = get_imu_info(imu_type);
-  
-  // BitsPerEpoch
-  unsigned int BitsPerEpoch = imu.time_type + 6*imu.data_type;
-  
-  // Set cursor at end of file
-  fseek(fid, 0, SEEK_END);
-  
-  // ftell returns the file position (end location)
-  double lsize = ftell(fid); // probably could get away with a float here.
-  
-  // Count epochs and control it
-  double nEpochs = (lsize-imu.header_size)/BitsPerEpoch;
-  
-  // Is nEpochs an integer? 
-  if(trunc(nEpochs) != nEpochs){
-    throw std::runtime_error("The file does not have the expected file size. Check the type of IMU or if the file is corrupted.");
-  } 
-  
-  // display info to command window
-  Rcpp::Rcout << file_name <<  " contains " << (int)nEpochs << " epochs " << std::endl << "Reading ..." << std::endl;
-    
-   
-  // -- Read time
-
-  // Initialize data matrix
-  arma::mat data(nEpochs,7);
-  
-  // Set cursor at begining of data (e.g. skip header if it exists)
-  fseek(fid, imu.header_size, SEEK_SET);
-    
-  
-  // Fill the data matrix
-  if(imu.data_type == 8){ // Data is only doubles
-    
-    double data_buffer[7];
-  
-    for(unsigned int i = 0; i < nEpochs; i++){
-      if(!fread(&data_buffer, 8, 7, fid)) // double
-        break; 
-      
-      for(int j = 0; j < 7; j++){
-        data(i,j) = data_buffer[j];
-      }
-    }
-    
-  }else{ // Data is a mix of double then 6 ints
-    
-    double time_buffer[1];
-    int32_t data_buffer[6];
-    
-    for(unsigned int i = 0; i < nEpochs; i++){
-      if(!fread(&time_buffer, 8, 1, fid)) // double
-        break;
-      
-      if(!fread(&data_buffer, 4, 6, fid)) // int
-        break; 
-    
-      data(i,0) = time_buffer[0];
-      
-      for(int j = 1; j <= 6; j++){
-        data(i,j) = data_buffer[j-1];
-      }
-    }
-    
-  } // end if
-  
-  // Close the file connection
-  fclose(fid);
-
-  // Data Rate
-  double fIMU = 1.0/mean_diff(data.col(0));
-    
-  fIMU = round(fIMU); 
-  
-  //printf("(data @ %.2f Hz, sGr %f sAc %f) ...", fIMU, imu.scale_gyro, imu.scale_acc); 
-    
-  // Scale data
-  data.cols(1,3) *= fIMU * imu.scale_gyro;  
-  data.cols(4,6) *= fIMU * imu.scale_acc; 
-  
-  arma::vec stats(3);
-  stats(0) = fIMU;
-  stats(1) = imu.scale_gyro;
-  stats(2) = imu.scale_acc;
-  
-  arma::field<arma::mat> out(2);
-  out(0) = data;
-  out(1) = stats;
-  return out;
+arma::field<arma::mat> read_imu(std::string file_path, std::string imu_type, unsigned int decimate = 1) {
+  return read_imu_file(file_path, get_imu_layout(imu_type), decimate);
 }
 
+#ifndef GMWM_STANDALONE
+//' @title Read a Binary File with a Custom Record Layout into R
+//' 
+//' @description
+//' Reads a binary IMU file whose records are described by a layout instead of a supported IMU type.
+//' 
+//' @param file_path A \code{string} that contains the full file path.
+//' @param layout A \code{list} created by \code{\link{imu_layout}}.
+//' @param decimate An \code{integer} giving the number of consecutive epochs averaged into one (see \code{\link{read_imu}}).
+//' @details
+//' The layout is converted once into a decoder specialized to the type and byte order of each field,
+//' so custom formats are read as fast as the supported IMU types.
+//' @return A \code{field<mat>} with the same structure as \code{\link{read_imu}}.
+//' @examples
+//' \dontrun{
+//' lay = imu_layout(offsets = c(0, 8, 12, 16, 20, 24, 28), 
+//'                  types = c("double", rep("int32", 6)),
+//'                  scale_gyro = 1.0/2097152.0, scale_acc = 1.0/16384.0)
+//' read_imu_layout(file_path = "F:/Desktop/short_test_data.imu", layout = lay)
+//' }
+//' @keywords internal
+// [[Rcpp::export]]
+arma::field<arma::mat> read_imu_layout(std::string file_path, Rcpp::List layout, unsigned int decimate = 1) {
+  return read_imu_file(file_path, imu_layout_from_list(layout), decimate);
+}
+#endif
@@ -0,0 +1,17 @@
+#ifndef READ_IMU
+#define READ_IMU
+
+arma::uword count_imu_epochs(double lsize, const imu_layout& imu);
+
+arma::field<arma::mat> decode_imu_file(const mapped_file& fid, const imu_layout& imu, bool parallel,
+                                       unsigned int decimate = 1);
+
+arma::field<arma::mat> read_imu_file(const std::string& file_path, const imu_layout& imu, unsigned int decimate = 1);
+
+arma::field<arma::mat> read_imu(std::string file_path, std::string imu_type, unsigned int decimate);
+
+#ifndef GMWM_STANDALONE
+arma::field<arma::mat> read_imu_layout(std::string file_path, Rcpp::List layout, unsigned int decimate);
+#endif
+
+#endif
@@ -1,6 +1,9 @@
 #include <RcppArmadillo.h>
 #include "robust_components.h"
 #include "inline_functions.h"
+
+// Minimises through the solver of the context
+#include "gmwm_context.h"
 using namespace Rcpp;
 
 /* -------------------------------- Start ROBUST FUNCTIONS -------------------------- */
@@ -42,6 +45,19 @@ double objFun_find_biwc(double crob, double eff){
   return square((0.5*M*M)/Q - eff);
 }
 
+// objFun_find_biwc at a given efficiency
+class biwc_objective : public scalar_function{
+public:
+  explicit biwc_objective(double eff) : eff(eff) {}
+
+  double value(double crob){
+    return objFun_find_biwc(crob, eff);
+  }
+
+private:
+  double eff;
+};
+
 // @title Obtain Tuning Constant crob.bw
 // @description Objective function that finds tuning constant
 // @usage find_biwc(eff)
@@ -50,17 +66,9 @@ double objFun_find_biwc(double crob, double eff){
 // @examples
 // find_biwc(0.6)
 double find_biwc(double eff = 0.6){
-  Rcpp::Environment stats("package:stats"); 
-  Rcpp::Function optimize = stats["optimize"];    
-
-  Rcpp::List crob_t = optimize(_["f"]  = Rcpp::InternalFunction(&objFun_find_biwc),
-                          _["lower"] = 0,
-                          _["upper"] = 100,
-                          _["eff"] = eff);
-                          
-  double out = as<double>(crob_t[0]);
+  biwc_objective f(eff);
 
-  return out;
+  return current_context().solver->minimize_1d(f, 0, 100);
 }
 
 
@@ -73,8 +81,23 @@ double objFun_sig_rob_bw(double sig2_bw, arma::vec x, double a_of_c, double crob
   return square(arma::mean(arma::square(r)%arma::square(w)) - a_of_c);
 }
 
+// objFun_sig_rob_bw for given coefficients and tuning constant
+class sig_rob_bw_objective : public scalar_function{
+public:
+  sig_rob_bw_objective(const arma::vec& x, double a_of_c, double crob_bw) : x(x), a_of_c(a_of_c), crob_bw(crob_bw) {}
+
+  double value(double sig2_bw){
+    return objFun_sig_rob_bw(sig2_bw, x, a_of_c, crob_bw);
+  }
+
+private:
+  const arma::vec& x;
+  double a_of_c;
+  double crob_bw;
+};
+
 // Robust estimator. Inputs are wavelet coefficients (y) and desired level of efficiency. 
-double sig_rob_bw(arma::vec y, double eff = 0.6){
+double sig_rob_bw(const arma::vec& y, double eff = 0.6){
   double crob_bw = find_biwc(eff);
 
   arma::vec x = y/arma::stddev(y);  
@@ -94,17 +117,9 @@ double sig_rob_bw(arma::vec y, double eff = 0.6){
                   -(4/crob_sq)*(6*norm_prob-2*crob_bw*(3+crob_sq)*norm_density-3)
                   +2*norm_prob-2*crob_bw*norm_density-1;
 
-  Rcpp::Environment stats("package:stats"); 
-  Rcpp::Function optimize = stats["optimize"];    
-
-  Rcpp::List opt_val = optimize(_["f"]  = Rcpp::InternalFunction(&objFun_sig_rob_bw),
-                          _["lower"] = 0,
-                          _["upper"] = 2,
-                          _["x"] = x,
-                          _["a_of_c"] = a_of_c,
-                          _["crob_bw"] = crob_bw);
+  sig_rob_bw_objective f(x, a_of_c, crob_bw);
           
-  double sig2_hat_rob_bw = as<double>(opt_val[0])*var(y);
+  double sig2_hat_rob_bw = current_context().solver->minimize_1d(f, 0, 2)*var(y);
   return sig2_hat_rob_bw;
 }
 
@@ -7,6 +7,6 @@ double find_biwc(double eff);
 
 double objFun_sig_rob_bw(double sig2_bw, arma::vec x, double a_of_c, double crob_bw);
 
-double sig_rob_bw(arma::vec y, double eff);
+double sig_rob_bw(const arma::vec& y, double eff);
 
 #endif
@@ -77,7 +77,7 @@ arma::vec seq_len_cpp(unsigned int n){
 //' quantile_cpp(c(1,2,3,4,5,6,7), c(.25,.5,.75))
 //' quantile(c(1,2,3,4,5,6,7), c(.25,.5,.75))
 // [[Rcpp::export]]
-arma::vec quantile_cpp(arma::vec x, const arma::vec& probs) {
+arma::vec quantile_cpp(const arma::vec& x, const arma::vec& probs) {
   
   unsigned int n = x.n_elem;
   
@@ -86,13 +86,13 @@ arma::vec quantile_cpp(arma::vec x, const arma::vec& probs) {
   arma::uvec hi = ceil(index);
   
   // bad for sorting large data. need partial sort.
-  x = sort(x);
+  arma::vec sorted = sort(x);
   
-  arma::vec qs = x(lo);
+  arma::vec qs = sorted(lo);
   arma::uvec i = index > lo;
   arma::uvec h = (index - lo);
   h = h.elem(i);
-  qs.elem(i) = (1 - h) % qs.elem(i) + h % x.elem(hi.elem(i));
+  qs.elem(i) = (1 - h) % qs.elem(i) + h % sorted.elem(hi.elem(i));
   
   return qs;
 }
@@ -110,18 +110,26 @@ arma::vec quantile_cpp(arma::vec x, const arma::vec& probs) {
 //' x = rnorm(10, 0, 1)
 //' diff_cpp(x,1,1)
 // [[Rcpp::export]]
-arma::vec diff_cpp(arma::vec x, unsigned int lag, unsigned int differences){
+arma::vec diff_cpp(const arma::vec& x, unsigned int lag, unsigned int differences){
   
-  // Difference the series i times
-  for(unsigned int i=0; i < differences; i++){
+  if(differences == 0){
+    return x;
+  }
+  
+  // The first difference is taken from the series itself
+  unsigned int n = x.n_elem;
+  arma::vec d = (x.rows(lag,n-1) - x.rows(0,n-lag-1));
+  
+  // Difference the series the remaining times
+  for(unsigned int i=1; i < differences; i++){
     // Each difference will shorten series length
-    unsigned int n=x.n_elem;
+    n = d.n_elem;
     // Take the difference based on number of lags
-    x = (x.rows(lag,n-1) - x.rows(0,n-lag-1));
+    d = (d.rows(lag,n-1) - d.rows(0,n-lag-1));
   }
   
   // Return differenced series:
-  return x;
+  return d;
 }
 
 //' @title Converting an ARMA Process to an Infinite MA Process
@@ -189,7 +197,7 @@ arma::vec ARMAtoMA_cpp(arma::vec ar, arma::vec ma, int lag_max)
 //' # Using R's function
 //' filter(x, rep(1, 3), sides = 1, circular = TRUE)
 // [[Rcpp::export]]
-arma::vec cfilter(arma::vec x, arma::vec filter, int sides, bool circular)
+arma::vec cfilter(const arma::vec& x, const arma::vec& filter, int sides, bool circular)
 {
   
   int nx = x.n_elem;
@@ -259,7 +267,7 @@ arma::vec cfilter(arma::vec x, arma::vec filter, int sides, bool circular)
 //' # Using R's function
 //' filter(x, rep(1, 3), method="recursive", init=rep(1, 3))
 // [[Rcpp::export]]
-arma::vec rfilter(arma::vec x, arma::vec filter, arma::vec init)
+arma::vec rfilter(const arma::vec& x, const arma::vec& filter, const arma::vec& init)
 {
  
   int nx = x.n_elem, nf = filter.n_elem;
@@ -269,14 +277,11 @@ arma::vec rfilter(arma::vec x, arma::vec filter, arma::vec init)
   // see filter source
   // .Call(C_rfilter, x, filter, c(rev(init[, 1L]), double(n)))[-ind]
   // r is then c(rev(init[, 1L]), double(n))
-  arma::vec rx = x;
-  arma::vec rf = filter;
-  
   for(int i = 0; i < nx; i++) {
-    sum = rx(i);
+    sum = x(i);
     for (int j = 0; j < nf; j++) {
       if(nf + i - j - 1 >= 0){
-        sum += r(nf + i - j - 1) * rf(j);
+        sum += r(nf + i - j - 1) * filter(j);
       }else{
         r[nf + i] = NA_REAL; goto bad3; 
       }
@@ -566,7 +571,7 @@ inline void sweep_col_mean(arma::mat& x){
 //'  (\code{TRUE}) or not (\code{FALSE})
 //' @keywords internal
 // [[Rcpp::export(.acf)]]
-arma::cube acf(arma::mat& x, int lagmax = 0, bool cor = true, bool demean = true){
+arma::cube acf(const arma::mat& x, int lagmax = 0, bool cor = true, bool demean = true){
   
   int nobs = x.n_rows, nsignals = x.n_cols;
   
@@ -576,10 +581,13 @@ arma::cube acf(arma::mat& x, int lagmax = 0, bool cor = true, bool demean = true
   }
   
   
-  // Detrend data
+  // Detrend a copy of the data: the input is the caller's memory
+  arma::mat centered;
   if(demean){
-    sweep_col_mean(x);
+    centered = x;
+    sweep_col_mean(centered);
   }
+  const arma::mat& xc = demean ? centered : x;
   
   // Figure out best max
   lagmax = std::min(lagmax, nobs - 1);
@@ -602,10 +610,10 @@ arma::cube acf(arma::mat& x, int lagmax = 0, bool cor = true, bool demean = true
         
         for(int i = 0; i < nobs-lag; i++){
           
-          if(arma::is_finite(x[i + lag + nobs*u]) &&
-             arma::is_finite(x[i + nobs*v])) {
+          if(arma::is_finite(xc[i + lag + nobs*u]) &&
+             arma::is_finite(xc[i + nobs*v])) {
             nu++;
-            sum += x[i + lag + nobs*u] * x[i + nobs*v];
+            sum += xc[i + lag + nobs*u] * xc[i + nobs*v];
           }
           
         }
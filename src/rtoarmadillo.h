@@ -7,15 +7,15 @@ arma::vec seq_cpp(int a, int b);
 
 arma::vec seq_len_cpp(unsigned int n);
 
-arma::vec quantile_cpp(arma::vec x, const arma::vec& probs);
+arma::vec quantile_cpp(const arma::vec& x, const arma::vec& probs);
 
-arma::vec diff_cpp(arma::vec x, unsigned int lag = 1, unsigned int differences = 1);
+arma::vec diff_cpp(const arma::vec& x, unsigned int lag = 1, unsigned int differences = 1);
 
 arma::vec ARMAtoMA_cpp(arma::vec ar, arma::vec ma, int lag_max);
 
-arma::vec cfilter(arma::vec x, arma::vec filter, int sides = 2, bool circular = false);
+arma::vec cfilter(const arma::vec& x, const arma::vec& filter, int sides = 2, bool circular = false);
 
-arma::vec rfilter(arma::vec x, arma::vec filter, arma::vec init);
+arma::vec rfilter(const arma::vec& x, const arma::vec& filter, const arma::vec& init);
 
 arma::mat expand_grid_red(int nx);
 
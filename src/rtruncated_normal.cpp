@@ -2,6 +2,9 @@
 
 #include "rtruncated_normal.h"
 
+// Draws from the RNG of the context
+#include "gmwm_context.h"
+
 //' Truncated Normal Distribution Sampling Algorithm
 //' 
 //' Enables sampling from a truncated normal
@@ -31,7 +34,7 @@ arma::vec rtruncated_normal(unsigned int n, double mu, double sigma, double a, d
 
 double sim_truncated_normal(double phi_a_cdf, double phi_b_cdf, double mu, double sigma){
   // Generate u ~ U[0,1]
-  double u = R::runif(0.0,1.0);
+  double u = rng_unif(0.0,1.0);
   
   double tnorm_value = phi_a_cdf + u * ( phi_b_cdf - phi_a_cdf );
   
@@ -24,6 +24,12 @@
 #include <RcppArmadillo.h>
 #include "sampler.h"
 
+// Draws from the RNG of the context
+#include "gmwm_context.h"
+
+// Draws from the RNG of the context
+#include "gmwm_context.h"
+
 
 arma::vec rsample(const arma::vec &x, const int size, const bool replace, arma::vec prob_ ) {
   // Templated sample -- should work on any Rcpp Vector
@@ -79,7 +85,7 @@ arma::vec rsample(const arma::vec &x, const int size, const bool replace, arma::
 void RSampleReplace( arma::vec &index, int nOrig, int size) {
   int ii;
   for (ii = 0; ii < size; ii++) {
-    index[ii] = nOrig * unif_rand();
+    index[ii] = nOrig * rng_unif(0.0, 1.0);
   }
 }
 
@@ -90,7 +96,7 @@ void RSampleNoReplace( arma::vec &index, int nOrig, int size) {
     sub[ii] = ii;
   }
   for (ii = 0; ii < size; ii++) {
-    jj = nOrig * unif_rand();
+    jj = nOrig * rng_unif(0.0, 1.0);
     index[ii] = sub[jj];
     // replace sampled element with last, decrement
     sub[jj] = sub[--nOrig];
@@ -109,7 +115,7 @@ void RProbSampleReplace(arma::vec &index, int nOrig, int size, arma::vec &prob){
   prob = arma::cumsum(prob);
   // compute the sample 
   for (ii = 0; ii < size; ii++) {
-    rU = unif_rand();
+    rU = rng_unif(0.0, 1.0);
     for (jj = 0; jj < nOrig_1; jj++) {
       if (rU <= prob[jj])
         break;
@@ -154,7 +160,7 @@ void RWalkerProbSampleReplace(arma::vec &index, int nOrig, int size, arma::vec &
   for (ii = 0; ii < nOrig; ii++)  prob[ii] += ii;
   /* generate sample */
   for (ii = 0; ii < size; ii++) {
-    rU = unif_rand() * nOrig;
+    rU = rng_unif(0.0, 1.0) * nOrig;
     kk = (int) rU;
     index[ii] = (rU < prob[kk]) ? kk : alias_tab[kk];
   }
@@ -169,7 +175,7 @@ void RProbSampleNoReplace(arma::vec &index, int nOrig, int size, arma::vec &prob
   prob = arma::sort(prob, "descend");  // descending sort of prob
   // compute the sample 
   for (ii = 0; ii < size; ii++, nOrig_1--) {
-    rT = totalmass * unif_rand();
+    rT = totalmass * rng_unif(0.0, 1.0);
     mass = 0;
     for (jj = 0; jj < nOrig_1; jj++) {
       mass += prob[jj];
@@ -191,7 +197,7 @@ void RFixProb(arma::vec &prob, const int size, const bool replace) {
   int ii, nPos = 0;
   int nn = prob.size();
   for (ii = 0; ii < nn; ii++) {
-    if (!R_FINITE(prob[ii])) //does this work??
+    if (!std::isfinite(prob[ii]))
       throw std::range_error( "NAs not allowed in probability" ) ;
     if (prob[ii] < 0.0)
       throw std::range_error( "Negative probabilities not allowed" ) ;
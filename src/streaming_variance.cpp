@@ -0,0 +1,237 @@
+#include <RcppArmadillo.h>
+
+#include "streaming_variance.h"
+
+/* ----------------------- Start Streaming Variance Functions ------------------------ */
+
+// Layout of the serialised state:
+// (format, number of levels, number of samples, then STREAM_LEVEL_SIZE entries per level)
+#define STREAM_FORMAT 1
+#define STREAM_HEADER_SIZE 3
+#define STREAM_LEVEL_SIZE 7
+#define STREAM_MAX_LEVELS 62
+
+//' @title Unpack a Streaming Variance State
+//' @description Converts the serialised state into the octave cascade.
+//' @param state A \code{vec} created by \code{avar_stream_init} or \code{avar_stream_update}.
+//' @return A \code{stream_state} containing the octave accumulators.
+//' @keywords internal
+stream_state stream_unpack(const arma::vec& state){
+
+  if(state.n_elem < STREAM_HEADER_SIZE || state(0) != STREAM_FORMAT){
+    Rcpp::stop("The supplied object is not a streaming variance state.");
+  }
+
+  unsigned int L = state(1);
+
+  if(state.n_elem != STREAM_HEADER_SIZE + STREAM_LEVEL_SIZE*L){
+    Rcpp::stop("The streaming variance state is corrupt.");
+  }
+
+  stream_state s;
+  s.n = state(2);
+  s.levels.resize(L);
+
+  for(unsigned int j = 0; j < L; j++){
+    unsigned int i = STREAM_HEADER_SIZE + STREAM_LEVEL_SIZE*j;
+
+    stream_level& lv = s.levels[j];
+    lv.pending = state(i);
+    lv.has_pending = state(i+1) != 0;
+    lv.prev1 = state(i+2);
+    lv.prev2 = state(i+3);
+    lv.n_blocks = state(i+4);
+    lv.sum_d1 = state(i+5);
+    lv.sum_d2 = state(i+6);
+  }
+
+  return s;
+}
+
+//' @title Pack a Streaming Variance State
+//' @description Serialises the octave cascade so that it can be stored or checkpointed from R.
+//' @param s A \code{stream_state} containing the octave accumulators.
+//' @return A \code{vec} holding the state.
+//' @keywords internal
+arma::vec stream_pack(const stream_state& s){
+
+  unsigned int L = s.levels.size();
+
+  arma::vec state(STREAM_HEADER_SIZE + STREAM_LEVEL_SIZE*L);
+  state(0) = STREAM_FORMAT;
+  state(1) = L;
+  state(2) = s.n;
+
+  for(unsigned int j = 0; j < L; j++){
+    unsigned int i = STREAM_HEADER_SIZE + STREAM_LEVEL_SIZE*j;
+
+    const stream_level& lv = s.levels[j];
+    state(i) = lv.pending;
+    state(i+1) = lv.has_pending;
+    state(i+2) = lv.prev1;
+    state(i+3) = lv.prev2;
+    state(i+4) = lv.n_blocks;
+    state(i+5) = lv.sum_d1;
+    state(i+6) = lv.sum_d2;
+  }
+
+  return state;
+}
+
+//' @title Push a Sample into the Streaming Variance Cascade
+//' @description Adds one observation and propagates completed block averages to the coarser octaves.
+//' @param s A \code{stream_state} containing the octave accumulators.
+//' @param x A \code{double} containing the new observation.
+//' @details
+//' Level \eqn{j} receives the non-overlapping block averages of length \eqn{2^j}{2^j}. Two consecutive
+//' averages of level \eqn{j} form one average of level \eqn{j+1}, so each sample costs amortized \eqn{O(1)}{O(1)}.
+//' @keywords internal
+void stream_push(stream_state& s, double x){
+
+  s.n++;
+
+  double value = x;
+
+  for(unsigned int j = 0; j < STREAM_MAX_LEVELS; j++){
+
+    if(j == s.levels.size()){
+      stream_level lv = {0, false, 0, 0, 0, 0, 0};
+      s.levels.push_back(lv);
+    }
+
+    stream_level& lv = s.levels[j];
+
+    // Update the difference sums of the current octave
+    if(lv.n_blocks >= 1){
+      double d1 = value - lv.prev1;
+      lv.sum_d1 += d1*d1;
+    }
+
+    if(lv.n_blocks >= 2){
+      double d2 = value - 2*lv.prev1 + lv.prev2;
+      lv.sum_d2 += d2*d2;
+    }
+
+    lv.prev2 = lv.prev1;
+    lv.prev1 = value;
+    lv.n_blocks++;
+
+    // Decimate into the next octave
+    if(!lv.has_pending){
+      lv.pending = value;
+      lv.has_pending = true;
+      break;
+    }
+
+    value = (lv.pending + value)/2;
+    lv.has_pending = false;
+  }
+}
+
+//' @title Initialize a Streaming Allan Variance State
+//' @description Creates an empty state for the streaming Allan and Hadamard variance estimators.
+//' @return A \code{vec} containing the serialised state.
+//' @details
+//' The state is a plain numeric vector so that it can be saved with \code{saveRDS} and used
+//' to resume the computation at a later time.
+//' @author JJB
+//' @examples
+//' s = avar_stream_init()
+//' s = avar_stream_update(s, rnorm(1000))
+//' avar_stream_query(s)
+//' @keywords internal
+// [[Rcpp::export]]
+arma::vec avar_stream_init(){
+  stream_state s;
+  s.n = 0;
+  return stream_pack(s);
+}
+
+//' @title Update a Streaming Allan Variance State
+//' @description Adds new observations to a streaming Allan and Hadamard variance state.
+//' @param state A \code{vec} created by \code{avar_stream_init} or \code{avar_stream_update}.
+//' @param x A \code{vec} containing the new observations.
+//' @return A \code{vec} containing the updated state.
+//' @details
+//' The estimator keeps a cascade of block-average accumulators, one per octave \eqn{\tau = 2^j}{tau = 2^j}.
+//' Memory is therefore proportional to the number of octaves and each sample costs amortized \eqn{O(1)}{O(1)}.
+//' Feeding a series in several pieces gives the same state as feeding it at once.
+//' @author JJB
+//' @examples
+//' s = avar_stream_init()
+//' s = avar_stream_update(s, rnorm(500))
+//' s = avar_stream_update(s, rnorm(500))
+//' avar_stream_query(s)
+//' @keywords internal
+// [[Rcpp::export]]
+arma::vec avar_stream_update(const arma::vec& state, const arma::vec& x){
+
+  stream_state s = stream_unpack(state);
+
+  for(unsigned int i = 0; i < x.n_elem; i++){
+    stream_push(s, x(i));
+  }
+
+  return stream_pack(s);
+}
+
+//' @title Query a Streaming Allan Variance State
+//' @description Computes the current Allan or Hadamard variance curve from a streaming state.
+//' @param state A \code{vec} created by \code{avar_stream_init} or \code{avar_stream_update}.
+//' @param type A \code{string} containing either \code{"allan"} or \code{"hadamard"}.
+//' @return av A \code{matrix} that contains:
+//' \itemize{
+//'  \item{Col 1}{The size of the cluster}
+//'  \item{Col 2}{The Allan or Hadamard variance}
+//'  \item{Col 3}{The error associated with the variance estimation.}
+//' }
+//' @details
+//' Given the \eqn{M} non-overlapping block averages \eqn{\bar y_k}{ybar_k} of length \eqn{\tau}{tau}, the
+//' Allan variance is estimated by \eqn{\frac{1}{2(M-1)}\sum_{k}(\bar y_{k} - \bar y_{k-1})^2}{1/(2(M-1)) sum (ybar_k - ybar_(k-1))^2}
+//' and the Hadamard variance by \eqn{\frac{1}{6(M-2)}\sum_{k}(\bar y_{k} - 2\bar y_{k-1} + \bar y_{k-2})^2}{1/(6(M-2)) sum (ybar_k - 2 ybar_(k-1) + ybar_(k-2))^2}.
+//' Only the octaves with enough blocks to form a difference are returned.
+//' @author JJB
+//' @examples
+//' s = avar_stream_update(avar_stream_init(), rnorm(1000))
+//' avar_stream_query(s, "allan")
+//' avar_stream_query(s, "hadamard")
+//' @keywords internal
+// [[Rcpp::export]]
+arma::mat avar_stream_query(const arma::vec& state, std::string type = "allan"){
+
+  stream_state s = stream_unpack(state);
+
+  bool allan;
+  if(type == "allan"){
+    allan = true;
+  }else if(type == "hadamard"){
+    allan = false;
+  }else{
+    Rcpp::stop("The type of variance must be either 'allan' or 'hadamard'.");
+  }
+
+  // Minimum number of blocks to form one difference
+  double min_blocks = allan ? 2 : 3;
+
+  unsigned int J = 0;
+  while(J < s.levels.size() && s.levels[J].n_blocks >= min_blocks){
+    J++;
+  }
+
+  arma::mat av = arma::zeros<arma::mat>(J,3);
+
+  for(unsigned int j = 0; j < J; j++){
+    const stream_level& lv = s.levels[j];
+
+    // Cluster size
+    av(j,0) = pow(2.0, double(j));
+    // Compute the variance estimate
+    av(j,1) = allan ? lv.sum_d1/(2*(lv.n_blocks - 1)) : lv.sum_d2/(6*(lv.n_blocks - 2));
+    // Compute Error
+    av(j,2) = 1/sqrt(2*(lv.n_blocks - 1));
+  }
+
+  return av;
+}
+
+/* --------------------- End Streaming Variance Functions ---------------------- */
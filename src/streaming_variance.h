@@ -0,0 +1,33 @@
+#ifndef STREAMING_VARIANCE
+#define STREAMING_VARIANCE
+
+// Accumulator for a single octave (tau = 2^j) of the decimation cascade
+struct stream_level{
+  double pending;      // Block average waiting for its pair to form the next octave
+  bool has_pending;    // Whether pending holds a value
+  double prev1;        // Last block average
+  double prev2;        // Block average before prev1
+  double n_blocks;     // Number of block averages seen
+  double sum_d1;       // Sum of squared first differences (Allan)
+  double sum_d2;       // Sum of squared second differences (Hadamard)
+};
+
+// Cascade of octave accumulators
+struct stream_state{
+  double n;                        // Number of samples pushed
+  std::vector<stream_level> levels;
+};
+
+stream_state stream_unpack(const arma::vec& state);
+
+arma::vec stream_pack(const stream_state& s);
+
+void stream_push(stream_state& s, double x);
+
+arma::vec avar_stream_init();
+
+arma::vec avar_stream_update(const arma::vec& state, const arma::vec& x);
+
+arma::mat avar_stream_query(const arma::vec& state, std::string type);
+
+#endif
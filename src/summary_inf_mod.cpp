@@ -1,6 +1,9 @@
 #include <RcppArmadillo.h>
 
-//#include "summary_inf_mod.h"
+#include "summary_inf_mod.h"
+
+// Shared state of a fitted model
+#include "fit_state.h"
 
 // Inference goodies
 #include "inference.h"
@@ -59,6 +62,9 @@ arma::field<arma::mat> get_summary(arma::vec theta,
 
   arma::vec bs_obj_values;
     
+  // Whether theta no longer matches theo and obj_value
+  bool theta_changed = false;
+  
 
   // Determine the type of bootstrapper needed.
   
@@ -79,6 +85,7 @@ arma::field<arma::mat> get_summary(arma::vec theta,
     
     if(bs_theta_est){
       theta = bs(2);
+      theta_changed = true;
     }
     
     if(bs_ci){
@@ -92,18 +99,22 @@ arma::field<arma::mat> get_summary(arma::vec theta,
 
   // Generate inference information
   if(inference){
+    // The CI and GoF test share the derivatives and theoretical WV of the fit
+    fit_state fit = theta_changed ? make_fit_state(theta, desc, objdesc, omega, wv_empir, scales)
+                                  : make_fit_state(theta, desc, objdesc, omega, scales, theo, obj_value);
+    
     // Obtain a confidence interval for the parameter estimates AND calculate chisq goodness of fit
     if(bs_ci){
       ci = format_ci(theta, sd, alpha);
     }else{
-      arma::mat A = derivative_first_matrix(theta, desc, objdesc, scales);
-      ci = theta_ci(theta, A, V, omega, alpha);
+      ci = theta_ci(fit, V, alpha);
     }
 
     if(bs_gof){
       gof = bootstrap_gof_test(obj_value, bs_obj_values, alpha, bs_gof_p_ci); 
     }else{
-      gof = gof_test(theta, desc, objdesc, model_type, scales, V, wv_empir);
+      // Only optimised again when the fit was not weighted by the inverse of V
+      gof = gof_test(fit, desc, objdesc, model_type, scales, V, arma::inv(V), wv_empir);
     }
 
   }
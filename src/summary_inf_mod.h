@@ -0,0 +1,15 @@
+#ifndef SUMMARY_INF_MOD
+#define SUMMARY_INF_MOD
+
+arma::field<arma::mat> get_summary(arma::vec theta,
+                                   const std::vector<std::string>& desc, const arma::field<arma::vec>& objdesc, 
+                                   std::string model_type, 
+                                   const arma::vec& wv_empir, const arma::vec& theo, const arma::vec& scales,
+                                   arma::mat V, const arma::mat& omega, double obj_value,
+                                   unsigned int N, double alpha,
+                                   bool robust, double eff, 
+                                   bool inference, bool fullV,
+                                   bool bs_gof,  bool bs_gof_p_ci, bool bs_theta_est, bool bs_ci, 
+                                   unsigned int B);
+
+#endif
@@ -9,6 +9,10 @@
 // Uses robust components...
 #include "robust_components.h"
 
+// Times the WV and charges the decompositions it holds
+#include "gmwm_memory.h"
+#include "gmwm_profile.h"
+
 //' @title Generate eta3 confidence interval
 //' @description Computes the eta3 CI
 //' @param y          A \code{vec} that computes the brickwalled modwt dot product of each wavelet coefficient divided by their length.
@@ -227,6 +231,8 @@ arma::vec wave_variance(const arma::field<arma::vec>& signal_modwt_bw, bool robu
 arma::mat wvar_cpp(const arma::field<arma::vec>& signal_modwt_bw, 
                    bool robust, double eff, double alpha, 
                    std::string ci_type) {
+  profile_timer timer(STAGE_WV);
+  
   double alpha_ov_2 = alpha/2.0;
 
   // Wavelet Variance
@@ -271,6 +277,7 @@ arma::mat modwt_wvar_cpp(const arma::vec& signal, unsigned int nlevels, bool rob
   }else{
     signal_modwt_bw = dwt_cpp(signal, strWavelet, nlevels, "periodic", true);
   }
+  memory_charge coefficients(MEMORY_MODWT, decomposition_bytes(signal_modwt_bw));
 
   arma::mat o = wvar_cpp(signal_modwt_bw,robust, eff, alpha, ci_type);
   
@@ -309,7 +316,7 @@ arma::field<arma::mat> batch_modwt_wvar_cpp(const arma::mat& signal, unsigned in
   // signal_modwt
   arma::field<arma::mat> wvars(num);
   for(unsigned int i = 0; i < num; i++){
-    wvars(i) = modwt_wvar_cpp(signal.col(i), nlevels, robust, eff, alpha, 
+    wvars(i) = modwt_wvar_cpp(signal.unsafe_col(i), nlevels, robust, eff, alpha, 
                               ci_type, strWavelet, decomp);
     
   }
@@ -0,0 +1,117 @@
+#include <RcppArmadillo.h>
+#include <map>
+#include <algorithm>
+#include <vector>
+
+#include "wv_cache.h"
+
+// Look ups and hits are counted in the profile
+#include "gmwm_profile.h"
+
+/* ----------------------- Start Process WV Cache ------------------------ */
+
+// Entries kept before the cache is emptied, bounding the memory of long runs
+static const size_t wv_cache_capacity = 20000;
+
+struct wv_cache_key{
+  unsigned int kind;
+  unsigned int scales;
+  std::string type;
+  std::vector<double> theta;
+
+  bool operator<(const wv_cache_key& o) const{
+    if(kind != o.kind) return kind < o.kind;
+    if(scales != o.scales) return scales < o.scales;
+    if(type != o.type) return type < o.type;
+    return theta < o.theta;
+  }
+};
+
+class wv_cache{
+public:
+  wv_cache() {}
+
+  // Index of a scale set; the scales are compared exactly
+  unsigned int scale_id(const arma::vec& tau){
+    for(unsigned int i = 0; i < scale_sets.size(); i++){
+      const arma::vec& s = scale_sets[i];
+      if(s.n_elem == tau.n_elem && std::equal(s.begin(), s.end(), tau.begin())){
+        return i;
+      }
+    }
+    scale_sets.push_back(tau);
+    return scale_sets.size() - 1;
+  }
+
+  wv_cache_key key(wv_cache_kind kind, const std::string& type, const arma::vec& theta,
+                   unsigned int start, unsigned int n, const arma::vec& tau){
+    wv_cache_key k;
+    k.kind = kind;
+    k.scales = scale_id(tau);
+    k.type = type;
+    k.theta.assign(theta.begin() + start, theta.begin() + start + n);
+    return k;
+  }
+
+  std::map<wv_cache_key, arma::mat> entries;
+  std::vector<arma::vec> scale_sets;
+};
+
+// Cache of the innermost wv_cache_scope, NULL when none is active
+// Thread local so that fits on different threads keep their own caches
+static thread_local wv_cache* active_wv_cache = NULL;
+
+wv_cache_scope::wv_cache_scope() : cache(new wv_cache), previous(active_wv_cache) {
+  active_wv_cache = cache;
+}
+
+wv_cache_scope::~wv_cache_scope(){
+  active_wv_cache = previous;
+  delete cache;
+}
+
+wv_cache_pause::wv_cache_pause() : previous(active_wv_cache) {
+  active_wv_cache = NULL;
+}
+
+wv_cache_pause::~wv_cache_pause(){
+  active_wv_cache = previous;
+}
+
+bool wv_cache_get(wv_cache_kind kind, const std::string& type, const arma::vec& theta,
+                  unsigned int start, unsigned int n, const arma::vec& tau, arma::mat& out){
+  wv_cache* cache = active_wv_cache;
+  if(cache == NULL){
+    return false;
+  }
+
+  static const profile_counter lookups[3] = {COUNT_WV_CACHE_LOOKUPS, COUNT_DERIV_CACHE_LOOKUPS, COUNT_DERIV2_CACHE_LOOKUPS};
+  static const profile_counter hits[3] = {COUNT_WV_CACHE_HITS, COUNT_DERIV_CACHE_HITS, COUNT_DERIV2_CACHE_HITS};
+
+  profile_count(lookups[kind]);
+
+  std::map<wv_cache_key, arma::mat>::const_iterator it = cache->entries.find(cache->key(kind, type, theta, start, n, tau));
+  if(it == cache->entries.end()){
+    return false;
+  }
+
+  profile_count(hits[kind]);
+  out = it->second;
+  return true;
+}
+
+void wv_cache_put(wv_cache_kind kind, const std::string& type, const arma::vec& theta,
+                  unsigned int start, unsigned int n, const arma::vec& tau, const arma::mat& value){
+  wv_cache* cache = active_wv_cache;
+  if(cache == NULL){
+    return;
+  }
+
+  if(cache->entries.size() >= wv_cache_capacity){
+    cache->entries.clear();
+  }
+
+  cache->entries[cache->key(kind, type, theta, start, n, tau)] = value;
+}
+
+/* ------------------------ End Process WV Cache ------------------------- */
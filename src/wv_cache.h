@@ -0,0 +1,53 @@
+#ifndef WV_CACHE
+#define WV_CACHE
+
+// Quantities of a single process kept by the cache
+enum wv_cache_kind { WV_CACHE_WV, WV_CACHE_DERIV, WV_CACHE_DERIV2 };
+
+class wv_cache;
+
+// Memoises the theoretical WV and derivatives of each process while the object is in scope.
+// Entries are keyed by the exact parameter values of the process, so the hits are almost all
+// within the fit of one candidate, e.g. the criterion, the derivatives and the goodness of fit
+// evaluated again at its estimates. Another candidate only hits when it evaluates the same
+// values, which the optimizer practically never lands on. Look ups and hits are counted in
+// the profile (see gmwm_profile.h). Scopes nest: the previous cache is restored when the object
+// goes out of scope.
+class wv_cache_scope{
+public:
+  wv_cache_scope();
+  ~wv_cache_scope();
+
+private:
+  // Non-copyable
+  wv_cache_scope(const wv_cache_scope&);
+  wv_cache_scope& operator=(const wv_cache_scope&);
+
+  wv_cache* cache;
+  wv_cache* previous;
+};
+
+// Suspends the active cache, e.g. while an optimizer evaluates the objective at parameter
+// values that are never seen again.
+class wv_cache_pause{
+public:
+  wv_cache_pause();
+  ~wv_cache_pause();
+
+private:
+  wv_cache_pause(const wv_cache_pause&);
+  wv_cache_pause& operator=(const wv_cache_pause&);
+
+  wv_cache* previous;
+};
+
+// Look up the quantity of the process whose n parameters start at theta(start).
+// Returns false on a miss or when no cache is active.
+bool wv_cache_get(wv_cache_kind kind, const std::string& type, const arma::vec& theta,
+                  unsigned int start, unsigned int n, const arma::vec& tau, arma::mat& out);
+
+// Store a quantity; does nothing when no cache is active
+void wv_cache_put(wv_cache_kind kind, const std::string& type, const arma::vec& theta,
+                  unsigned int start, unsigned int n, const arma::vec& tau, const arma::mat& value);
+
+#endif
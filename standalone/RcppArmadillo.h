@@ -0,0 +1,38 @@
+#ifndef GMWM_STANDALONE_RCPPARMADILLO
+#define GMWM_STANDALONE_RCPPARMADILLO
+
+// Stands in for RcppArmadillo.h when the core is built without R (see CMakeLists.txt). It provides the
+// few parts of Rcpp and Rmath the core uses on top of Armadillo.
+
+#include <armadillo>
+#include <climits>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+// Missing values, as R represents them
+#define NA_INTEGER INT_MIN
+#define NA_LOGICAL INT_MIN
+#define NA_REAL std::numeric_limits<double>::quiet_NaN()
+
+namespace Rcpp{
+
+inline void stop(const std::string& message){
+  throw std::runtime_error(message);
+}
+
+}
+
+namespace R{
+
+double dnorm(double x, double mu, double sigma, int give_log);
+double pnorm(double x, double mu, double sigma, int lower_tail, int log_p);
+double qnorm(double p, double mu, double sigma, int lower_tail, int log_p);
+double pchisq(double x, double df, int lower_tail, int log_p);
+double qchisq(double p, double df, int lower_tail, int log_p);
+
+}
+
+#endif
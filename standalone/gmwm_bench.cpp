@@ -0,0 +1,729 @@
+// Benchmarks of the estimation core on series simulated by gen_model.
+//
+//   gmwm_bench [options]
+//
+// Each case times one call of a function of the core: the wavelet decompositions and variances, the
+// theoretical WV and the objective, the guessing of starting values, the optimisation, the bootstrappers,
+// the Allan and Hadamard variances and the decoding of IMU files. The timings are written as JSON and,
+// given a baseline written by an earlier run, compared case by case. See usage() for the options.
+
+#include <RcppArmadillo.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gmwm_context.h"
+#include "json_writer.h"
+
+#include "allan_variance.h"
+#include "bootstrappers.h"
+#include "dwt.h"
+#include "gen_process.h"
+#include "gmwm_logic.h"
+#include "guess_values.h"
+#include "hadamard_variance.h"
+#include "imu_layout.h"
+#include "mapped_file.h"
+#include "objective_functions.h"
+#include "process_to_wv.h"
+#include "read_imu.h"
+#include "rtoarmadillo.h"
+#include "transform_data.h"
+#include "ts_model_cpp.h"
+#include "wave_variance.h"
+
+static void usage(std::ostream& out){
+  out <<
+    "usage: gmwm_bench [options]\n"
+    "\n"
+    "  --list                 Print the names of the cases and exit\n"
+    "  --filter S             Only run the cases whose name contains S (repeatable)\n"
+    "  --min-log2n K          Smallest series length, 2^K (default: 12)\n"
+    "  --max-log2n K          Largest series length, 2^K, at most 28 (default: 20)\n"
+    "  --step-log2n K         Step between series lengths (default: 4)\n"
+    "  --threads 1,2,...      Thread counts of the bootstrappers (default: 1, 2, 4, ... up to the cores)\n"
+    "  --min-time SEC         Time spent sampling each case (default: 0.5)\n"
+    "  --seed N               Seed of the simulated series (default: 1337)\n"
+    "  --output FILE          Write the JSON results to FILE instead of stdout\n"
+    "  --baseline FILE        Compare with the results of an earlier run\n"
+    "  --tolerance X          Relative slowdown reported as a regression (default: 0.1)\n";
+}
+
+/* ------------------------- Options ------------------------- */
+
+struct bench_options{
+  bench_options() : list(false), min_log2n(12), max_log2n(20), step_log2n(4), min_time(0.5), seed(1337),
+                    tolerance(0.1) {}
+
+  bool list;
+  std::vector<std::string> filters;
+  unsigned int min_log2n;
+  unsigned int max_log2n;
+  unsigned int step_log2n;
+  std::vector<unsigned int> threads;
+  double min_time;
+  unsigned int seed;
+  std::string output;
+  std::string baseline;
+  double tolerance;
+};
+
+static unsigned int to_uint(const std::string& s){
+  char* end;
+  unsigned long v = std::strtoul(s.c_str(), &end, 10);
+  if(*end != '\0' || s.empty()){
+    throw std::invalid_argument("Expected a positive integer, got " + s + ".");
+  }
+  return (unsigned int)v;
+}
+
+static double to_double(const std::string& s){
+  char* end;
+  double v = std::strtod(s.c_str(), &end);
+  if(*end != '\0' || s.empty()){
+    throw std::invalid_argument("Expected a number, got " + s + ".");
+  }
+  return v;
+}
+
+static bench_options parse_options(int argc, char** argv){
+  bench_options opt;
+
+  for(int i = 1; i < argc; i++){
+    std::string a = argv[i];
+
+    if(a == "--list"){
+      opt.list = true;
+      continue;
+    }
+
+    if(i + 1 >= argc){
+      throw std::invalid_argument("Missing value of " + a + ".");
+    }
+    std::string v = argv[++i];
+
+    if(a == "--filter"){
+      opt.filters.push_back(v);
+    }else if(a == "--min-log2n"){
+      opt.min_log2n = to_uint(v);
+    }else if(a == "--max-log2n"){
+      opt.max_log2n = to_uint(v);
+    }else if(a == "--step-log2n"){
+      opt.step_log2n = to_uint(v);
+    }else if(a == "--threads"){
+      std::stringstream ss(v);
+      std::string item;
+      while(std::getline(ss, item, ',')){
+        opt.threads.push_back(to_uint(item));
+      }
+    }else if(a == "--min-time"){
+      opt.min_time = to_double(v);
+    }else if(a == "--seed"){
+      opt.seed = to_uint(v);
+    }else if(a == "--output"){
+      opt.output = v;
+    }else if(a == "--baseline"){
+      opt.baseline = v;
+    }else if(a == "--tolerance"){
+      opt.tolerance = to_double(v);
+    }else{
+      throw std::invalid_argument("Unknown option " + a + ".");
+    }
+  }
+
+  if(opt.min_log2n < 4 || opt.max_log2n > 28 || opt.min_log2n > opt.max_log2n || opt.step_log2n == 0){
+    throw std::invalid_argument("Series lengths must satisfy 4 <= min-log2n <= max-log2n <= 28.");
+  }
+
+  if(opt.threads.empty()){
+    unsigned int hw = std::max(1u, std::thread::hardware_concurrency());
+    for(unsigned int t = 1; t < hw; t *= 2){
+      opt.threads.push_back(t);
+    }
+    opt.threads.push_back(hw);
+  }
+  for(unsigned int i = 0; i < opt.threads.size(); i++){
+    if(opt.threads[i] == 0){
+      throw std::invalid_argument("Thread counts must be positive.");
+    }
+  }
+
+  return opt;
+}
+
+/* ------------------------- Cases ------------------------- */
+
+typedef std::function<void()> bench_call;
+
+// A case prepares its inputs in setup(), which returns the call to time. Inputs are only built for the
+// cases that run, and are released before the next case.
+struct bench_case{
+  std::string name;
+  double items;                                   // Work done by one call, e.g. observations
+  std::function<bench_call()> setup;
+};
+
+// Processes simulated by the cases, with their true parameters
+struct bench_model{
+  std::string name;
+  std::vector<std::string> desc;
+  arma::vec theta;
+};
+
+static std::vector<bench_model> bench_models(){
+  std::vector<bench_model> m(8);
+
+  m[0].name = "AR1";    m[0].desc.push_back("AR1");    m[0].theta = {0.9, 1.0};
+  m[1].name = "MA1";    m[1].desc.push_back("MA1");    m[1].theta = {0.5, 1.0};
+  m[2].name = "ARMA11"; m[2].desc.push_back("ARMA11"); m[2].theta = {0.8, 0.3, 1.0};
+  m[3].name = "WN";     m[3].desc.push_back("WN");     m[3].theta = {1.0};
+  m[4].name = "RW";     m[4].desc.push_back("RW");     m[4].theta = {1e-3};
+  m[5].name = "QN";     m[5].desc.push_back("QN");     m[5].theta = {0.5};
+  m[6].name = "DR";     m[6].desc.push_back("DR");     m[6].theta = {1e-4};
+
+  // Typical inertial sensor: two Gauss-Markov processes, white noise and a random walk
+  m[7].name = "2*AR1+WN+RW";
+  m[7].desc = {"AR1", "AR1", "WN", "RW"};
+  m[7].theta = {0.999, 1e-6, 0.9, 1e-4, 1e-3, 1e-8};
+
+  return m;
+}
+
+static arma::vec simulate(const bench_model& m, unsigned int N, unsigned int seed){
+  current_context().rng->seed(seed);
+  return gen_model(N, m.theta, m.desc, model_objdesc(m.desc));
+}
+
+static std::string size_name(unsigned int log2n){
+  return "n=2^" + std::to_string(log2n);
+}
+
+// Writes N epochs of white noise in the layout of an IMU type, sampled at 100 Hz
+static void write_imu_file(const std::string& path, const imu_layout& layout, unsigned int N, unsigned int seed){
+  std::ofstream out(path.c_str(), std::ios::binary);
+  if(!out){
+    throw std::runtime_error("Cannot write " + path + ".");
+  }
+
+  current_context().rng->seed(seed);
+
+  std::vector<char> header(layout.header_size, 0);
+  out.write(header.data(), header.size());
+
+  std::vector<char> record(layout.record_size, 0);
+  for(unsigned int i = 0; i < N; i++){
+    for(unsigned int j = 0; j < 7; j++){
+      double v = (j == 0) ? i/100.0 : rng_norm(0.0, 1000.0);
+      char* p = record.data() + layout.channels[j].offset;
+      switch(layout.channels[j].type){
+      case IMU_INT16: { short s = (short)v; std::memcpy(p, &s, 2); break; }
+      case IMU_INT32: { int s = (int)v; std::memcpy(p, &s, 4); break; }
+      case IMU_FLOAT: { float s = (float)v; std::memcpy(p, &s, 4); break; }
+      case IMU_DOUBLE: std::memcpy(p, &v, 8); break;
+      }
+    }
+    out.write(record.data(), record.size());
+  }
+}
+
+// Runs the replicates of a bootstrapper on n_threads threads, each doing its share of H
+static void split_replicates(unsigned int H, unsigned int n_threads, const std::function<void(unsigned int)>& f){
+  std::vector<std::thread> pool;
+  for(unsigned int t = 0; t < n_threads; t++){
+    unsigned int h = H/n_threads + (t < H % n_threads ? 1 : 0);
+    pool.push_back(std::thread([&f, h](){ f(h); }));
+  }
+  for(unsigned int t = 0; t < pool.size(); t++){
+    pool[t].join();
+  }
+}
+
+static std::vector<bench_case> make_cases(const bench_options& opt){
+  std::vector<bench_case> cases;
+  std::vector<bench_model> models = bench_models();
+  const bench_model& imu = models.back();
+  unsigned int seed = opt.seed;
+
+  std::vector<unsigned int> sizes;
+  for(unsigned int k = opt.min_log2n; k <= opt.max_log2n; k += opt.step_log2n){
+    sizes.push_back(k);
+  }
+
+  // Decompositions, per filter length
+  const char* filters[] = {"haar", "d4", "la8", "la20"};
+  for(unsigned int f = 0; f < 4; f++){
+    std::string filter = filters[f];
+    for(unsigned int s = 0; s < sizes.size(); s++){
+      unsigned int k = sizes[s];
+      unsigned int N = 1u << k;
+      bench_case c_modwt = {"modwt_cpp/" + filter + "/" + size_name(k), double(N), [=]() -> bench_call {
+        arma::vec x = simulate(imu, N, seed);
+        return bench_call([=](){ modwt_cpp(x, filter, k, "periodic", true); });
+      }};
+      cases.push_back(c_modwt);
+      bench_case c_dwt = {"dwt_cpp/" + filter + "/" + size_name(k), double(N), [=]() -> bench_call {
+        arma::vec x = simulate(imu, N, seed);
+        return bench_call([=](){ dwt_cpp(x, filter, k, "periodic", true); });
+      }};
+      cases.push_back(c_dwt);
+    }
+  }
+
+  // Wavelet variance
+  for(unsigned int r = 0; r < 2; r++){
+    bool robust = r == 1;
+    for(unsigned int s = 0; s < sizes.size(); s++){
+      unsigned int k = sizes[s];
+      unsigned int N = 1u << k;
+      bench_case c = {std::string("modwt_wvar_cpp/") + (robust ? "robust" : "classic") + "/" + size_name(k), double(N), [=]() -> bench_call {
+        arma::vec x = simulate(imu, N, seed);
+        return bench_call([=](){ modwt_wvar_cpp(x, k, robust, 0.6, 0.05, "eta3", "haar", "modwt"); });
+      }};
+      cases.push_back(c);
+    }
+  }
+
+  // Theoretical WV and objective, per process, at the 20 scales of a series of 2^20
+  arma::vec tau = scales_cpp(20);
+  for(unsigned int i = 0; i < models.size(); i++){
+    bench_model m = models[i];
+    arma::field<arma::vec> objdesc = model_objdesc(m.desc);
+
+    bench_case c_wv = {"theoretical_wv/" + m.name, 1.0, [=]() -> bench_call {
+      return bench_call([=](){ theoretical_wv(m.theta, m.desc, objdesc, tau); });
+    }};
+    cases.push_back(c_wv);
+
+    const char* types[] = {"imu", "ssm"};
+    for(unsigned int t = 0; t < 2; t++){
+      std::string model_type = types[t];
+      // The IMU transformations need positive autoregressive parameters, which all models have
+      bench_case c_obj = {"objFun/" + m.name + "/" + model_type, 1.0, [=]() -> bench_call {
+        arma::vec wv_empir = theoretical_wv(m.theta, m.desc, objdesc, tau);
+        arma::vec start = transform_values(m.theta*0.9, m.desc, objdesc, model_type);
+        arma::mat omega = arma::diagmat(1.0/arma::square(wv_empir));
+        return bench_call([=](){ objFun(start, m.desc, objdesc, model_type, omega, wv_empir, tau); });
+      }};
+      cases.push_back(c_obj);
+    }
+  }
+
+  // Starting values and optimisation of the IMU model on a series of 2^16
+  {
+    unsigned int N = 1u << 16;
+    arma::field<arma::vec> objdesc = model_objdesc(imu.desc);
+
+    // Inputs of guess_initial and gmwm_engine, as gmwm_master_cpp computes them
+    struct fit_inputs{
+      arma::vec x;
+      arma::mat wv;
+      arma::vec scales;
+      arma::mat omega;
+      double expect_diff;
+      double ranged;
+    };
+    std::function<fit_inputs()> prepare = [=]() -> fit_inputs {
+      fit_inputs in;
+      in.x = simulate(imu, N, seed);
+      unsigned int nlevels = floor(log2(double(N)));
+      arma::field<arma::vec> decomp = modwt_cpp(in.x, "haar", nlevels, "periodic", true);
+      in.wv = wvar_cpp(decomp, false, 0.6, 0.05, "eta3");
+      in.scales = scales_cpp(nlevels);
+      in.omega = arma::inv(arma::diagmat(wv_covariance(decomp, in.wv, "fast", false, 0.6)));
+      in.expect_diff = mean_diff(in.x);
+      in.ranged = dr_slope(in.x);
+      return in;
+    };
+
+    unsigned int guesses[] = {1000, 20000, 100000, 1000000};
+    for(unsigned int g = 0; g < 4; g++){
+      unsigned int G = guesses[g];
+      bench_case c = {"guess_initial/" + imu.name + "/G=" + std::to_string(G), double(G), [=]() -> bench_call {
+        fit_inputs in = prepare();
+        return bench_call([=](){
+          current_context().rng->seed(seed);
+          guess_initial(imu.desc, objdesc, "imu", imu.theta.n_elem, in.expect_diff, N, in.wv, in.scales, in.ranged, G);
+        });
+      }};
+      cases.push_back(c);
+    }
+
+    bench_case c_engine = {"gmwm_engine/" + imu.name, 1.0, [=]() -> bench_call {
+      fit_inputs in = prepare();
+      current_context().rng->seed(seed);
+      arma::vec start = guess_initial(imu.desc, objdesc, "imu", imu.theta.n_elem, in.expect_diff, N,
+                                      in.wv, in.scales, in.ranged, 20000);
+      return bench_call([=](){
+        gmwm_engine(start, imu.desc, objdesc, "imu", in.wv.col(0), in.omega, in.scales, true);
+      });
+    }};
+    cases.push_back(c_engine);
+  }
+
+  // End to end fits, from the series to the estimates
+  for(unsigned int s = 0; s < sizes.size(); s++){
+    unsigned int k = sizes[s];
+    unsigned int N = 1u << k;
+    bench_case c = {"gmwm_master_cpp/" + imu.name + "/" + size_name(k), double(N), [=]() -> bench_call {
+      arma::vec x = simulate(imu, N, seed);
+      arma::field<arma::vec> objdesc = model_objdesc(imu.desc);
+      arma::vec theta = model_theta(imu.desc);
+      return bench_call([=](){
+        current_context().rng->seed(seed);
+        gmwm_master_cpp(x, theta, imu.desc, objdesc, "imu", true, 0.05, "fast", 1, 100, 20000, false, 0.6);
+      });
+    }};
+    cases.push_back(c);
+  }
+
+  // Bootstrappers on series of 2^12, splitting the replicates over threads that each have their own context
+  {
+    unsigned int N = 1u << 12;
+    arma::field<arma::vec> objdesc = model_objdesc(imu.desc);
+    arma::vec scales = scales_cpp(12);
+
+    unsigned int reps[] = {100, 500};
+    for(unsigned int h = 0; h < 2; h++){
+      unsigned int H = reps[h];
+      for(unsigned int t = 0; t < opt.threads.size(); t++){
+        unsigned int n_threads = opt.threads[t];
+        std::string suffix = "/H=" + std::to_string(H) + "/threads=" + std::to_string(n_threads);
+
+        bench_case c_cov = {"cov_bootstrapper" + suffix, double(H), [=]() -> bench_call {
+          return bench_call([=](){
+            split_replicates(H, n_threads, [&](unsigned int h){
+              current_context().rng->seed(seed);
+              cov_bootstrapper(imu.theta, imu.desc, objdesc, N, false, 0.6, h, false);
+            });
+          });
+        }};
+        cases.push_back(c_cov);
+
+        bench_case c_all = {"all_bootstrapper" + suffix, double(H), [=]() -> bench_call {
+          return bench_call([=](){
+            split_replicates(H, n_threads, [&](unsigned int h){
+              current_context().rng->seed(seed);
+              all_bootstrapper(imu.theta, imu.desc, objdesc, scales, "imu", N, false, 0.6, 0.05, h);
+            });
+          });
+        }};
+        cases.push_back(c_all);
+      }
+    }
+  }
+
+  // Allan and Hadamard variances
+  for(unsigned int s = 0; s < sizes.size(); s++){
+    unsigned int k = sizes[s];
+    unsigned int N = 1u << k;
+    bench_case c_avar = {"avar_mo_cpp/" + size_name(k), double(N), [=]() -> bench_call {
+      arma::vec x = simulate(imu, N, seed);
+      return bench_call([=](){ avar_mo_cpp(x); });
+    }};
+    cases.push_back(c_avar);
+    bench_case c_hadam = {"hadam_mo_cpp/" + size_name(k), double(N), [=]() -> bench_call {
+      arma::vec x = simulate(imu, N, seed);
+      return bench_call([=](){ hadam_mo_cpp(x); });
+    }};
+    cases.push_back(c_hadam);
+  }
+
+  // Decoding of IMU files, integer and floating point records
+  const char* imu_types[] = {"IMAR", "IXSEA"};
+  for(unsigned int i = 0; i < 2; i++){
+    std::string type = imu_types[i];
+    for(unsigned int s = 0; s < sizes.size(); s++){
+      unsigned int k = sizes[s];
+      unsigned int N = 1u << k;
+      bench_case c = {"read_imu/" + type + "/" + size_name(k), double(N), [=]() -> bench_call {
+        imu_layout layout = get_imu_layout(type);
+        std::string path = "gmwm_bench_" + type + "_" + std::to_string(k) + ".imu";
+        write_imu_file(path, layout, N, seed);
+        // The file is removed once the timed call is destroyed
+        std::shared_ptr<std::string> file(new std::string(path), [](std::string* p){
+          std::remove(p->c_str());
+          delete p;
+        });
+        return bench_call([=](){ read_imu_file(*file, layout, 1); });
+      }};
+      cases.push_back(c);
+    }
+  }
+
+  return cases;
+}
+
+/* ------------------------- Timing ------------------------- */
+
+struct bench_result{
+  std::string name;
+  unsigned int iterations;  // Calls timed
+  double median;            // Seconds per call
+  double min;
+  double mean;
+  double cpu;               // Processor seconds per call, over all threads
+  double items;
+};
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double seconds_since(bench_clock::time_point start){
+  return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+// Times a call in batches long enough for the clock, until min_time has been spent. A first call that
+// already takes min_time is the only sample, otherwise it is a warm up.
+static bench_result run_case(const bench_case& c, const bench_call& f, double min_time){
+  bench_result res;
+  res.name = c.name;
+  res.items = c.items;
+
+  bench_clock::time_point start = bench_clock::now();
+  std::clock_t cpu_start = std::clock();
+  f();
+  double first = seconds_since(start);
+
+  std::vector<double> samples;
+  double cpu = 0.0;
+  unsigned int iterations = 0;
+
+  if(first >= min_time){
+    samples.push_back(first);
+    cpu = double(std::clock() - cpu_start)/CLOCKS_PER_SEC;
+    iterations = 1;
+  }else{
+    // Calls per sample, so that a sample lasts about a millisecond
+    unsigned int batch = std::max(1.0, std::min(1e6, 1e-3/std::max(first, 1e-9)));
+
+    bench_clock::time_point begin = bench_clock::now();
+    cpu_start = std::clock();
+    while(seconds_since(begin) < min_time || samples.size() < 3){
+      bench_clock::time_point s = bench_clock::now();
+      for(unsigned int b = 0; b < batch; b++){
+        f();
+      }
+      samples.push_back(seconds_since(s)/batch);
+      iterations += batch;
+    }
+    cpu = double(std::clock() - cpu_start)/CLOCKS_PER_SEC;
+  }
+
+  std::vector<double> sorted = samples;
+  std::sort(sorted.begin(), sorted.end());
+  unsigned int n = sorted.size();
+
+  res.iterations = iterations;
+  res.median = (n % 2) ? sorted[n/2] : 0.5*(sorted[n/2 - 1] + sorted[n/2]);
+  res.min = sorted.front();
+  double total = 0.0;
+  for(unsigned int i = 0; i < n; i++){
+    total += samples[i];
+  }
+  res.mean = total/n;
+  res.cpu = cpu/iterations;
+  return res;
+}
+
+/* ------------------------- Baseline ------------------------- */
+
+// Median of each case of a document written by this program. Only that format is understood.
+static std::map<std::string, double> read_baseline(const std::string& path){
+  std::ifstream in(path.c_str());
+  if(!in){
+    throw std::runtime_error("Cannot read " + path + ".");
+  }
+  std::stringstream ss;
+  ss << in.rdbuf();
+  std::string doc = ss.str();
+
+  std::map<std::string, double> out;
+  const std::string name_key = "\"name\":\"";
+  const std::string median_key = "\"median_s\":";
+
+  size_t pos = 0;
+  while((pos = doc.find(name_key, pos)) != std::string::npos){
+    pos += name_key.size();
+    size_t end = doc.find('"', pos);
+    size_t med = doc.find(median_key, end);
+    if(end == std::string::npos || med == std::string::npos){
+      throw std::runtime_error(path + " is not a result of gmwm_bench.");
+    }
+    std::string name = doc.substr(pos, end - pos);
+    double median = std::strtod(doc.c_str() + med + median_key.size(), NULL);
+    out[name] = median;
+    pos = end;
+  }
+
+  if(out.empty()){
+    throw std::runtime_error(path + " does not contain any benchmark.");
+  }
+  return out;
+}
+
+// Prints the change of each case against the baseline and returns the number of regressions
+static unsigned int compare(const std::vector<bench_result>& results, const std::map<std::string, double>& baseline,
+                            double tolerance){
+  unsigned int regressions = 0;
+
+  std::cerr << std::endl << std::left << std::setw(56) << "case" << std::right
+            << std::setw(14) << "baseline" << std::setw(14) << "current" << std::setw(10) << "change" << std::endl;
+
+  for(unsigned int i = 0; i < results.size(); i++){
+    std::map<std::string, double>::const_iterator it = baseline.find(results[i].name);
+    if(it == baseline.end()){
+      continue;
+    }
+    double change = results[i].median/it->second - 1.0;
+    const char* flag = "";
+    if(change > tolerance){
+      flag = "  slower";
+      regressions++;
+    }else if(change < -tolerance){
+      flag = "  faster";
+    }
+
+    std::ostringstream pct;
+    pct << std::showpos << std::fixed << std::setprecision(1) << 100.0*change << "%";
+
+    std::cerr << std::left << std::setw(56) << results[i].name << std::right
+              << std::setw(14) << std::scientific << std::setprecision(3) << it->second
+              << std::setw(14) << results[i].median
+              << std::setw(10) << pct.str() << flag << std::endl;
+  }
+
+  std::cerr << std::endl << regressions << " case(s) slower than the baseline by more than "
+            << 100.0*tolerance << "%." << std::endl;
+  return regressions;
+}
+
+/* ------------------------- Main ------------------------- */
+
+static bool selected(const bench_options& opt, const std::string& name){
+  if(opt.filters.empty()){
+    return true;
+  }
+  for(unsigned int i = 0; i < opt.filters.size(); i++){
+    if(name.find(opt.filters[i]) != std::string::npos){
+      return true;
+    }
+  }
+  return false;
+}
+
+static void write_results(std::ostream& out, const bench_options& opt, const std::vector<bench_result>& results){
+  char date[32];
+  std::time_t now = std::time(NULL);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+  json_writer json(out);
+  json.begin_object();
+
+  json.key("context");
+  json.begin_object();
+  json.field("date", std::string(date));
+  json.field("hardware_threads", std::thread::hardware_concurrency());
+#ifdef __VERSION__
+  json.field("compiler", std::string(__VERSION__));
+#endif
+#ifdef NDEBUG
+  json.field("assertions", false);
+#else
+  json.field("assertions", true);
+#endif
+  json.field("min_time_s", opt.min_time);
+  json.field("seed", opt.seed);
+  json.end_object();
+
+  json.key("benchmarks");
+  json.begin_array();
+  for(unsigned int i = 0; i < results.size(); i++){
+    const bench_result& r = results[i];
+    json.begin_object();
+    json.field("name", r.name);
+    json.field("iterations", r.iterations);
+    json.field("median_s", r.median);
+    json.field("min_s", r.min);
+    json.field("mean_s", r.mean);
+    json.field("cpu_s", r.cpu);
+    json.field("items_per_s", r.items/r.median);
+    json.end_object();
+  }
+  json.end_array();
+
+  json.end_object();
+  out << std::endl;
+}
+
+int main(int argc, char** argv){
+  if(argc >= 2 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h")){
+    usage(std::cout);
+    return 0;
+  }
+
+  try{
+    bench_options opt = parse_options(argc, argv);
+
+    // Read first, so that a bad baseline does not waste a run
+    std::map<std::string, double> baseline;
+    if(!opt.baseline.empty()){
+      baseline = read_baseline(opt.baseline);
+    }
+
+    std::vector<bench_case> cases = make_cases(opt);
+
+    if(opt.list){
+      for(unsigned int i = 0; i < cases.size(); i++){
+        if(selected(opt, cases[i].name)){
+          std::cout << cases[i].name << std::endl;
+        }
+      }
+      return 0;
+    }
+
+    std::vector<bench_result> results;
+    for(unsigned int i = 0; i < cases.size(); i++){
+      if(!selected(opt, cases[i].name)){
+        continue;
+      }
+      bench_result r = run_case(cases[i], cases[i].setup(), opt.min_time);
+      std::cerr << std::left << std::setw(56) << r.name << std::right << std::scientific << std::setprecision(3)
+                << std::setw(12) << r.median << " s" << std::setw(12) << r.items/r.median << " items/s" << std::endl;
+      results.push_back(r);
+    }
+
+    std::ofstream file;
+    if(!opt.output.empty()){
+      file.open(opt.output.c_str());
+      if(!file){
+        throw std::runtime_error("Cannot write " + opt.output + ".");
+      }
+    }
+    write_results(opt.output.empty() ? std::cout : file, opt, results);
+
+    if(!baseline.empty() && compare(results, baseline, opt.tolerance) > 0){
+      return 1;
+    }
+    return 0;
+  }catch(std::invalid_argument& e){
+    std::cerr << "gmwm_bench: " << e.what() << std::endl << std::endl;
+    usage(std::cerr);
+    return 2;
+  }catch(std::exception& e){
+    std::cerr << "gmwm_bench: " << e.what() << std::endl;
+    return 2;
+  }
+}
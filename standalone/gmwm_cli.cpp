@@ -0,0 +1,504 @@
+// Command line interface to the estimation core, for batch jobs that do not need an R session.
+//
+//   gmwm <command> [options] <file>...
+//
+// Each series of each input file is a job. Jobs run on all cores and the results are written as one JSON
+// document, in the order of the files and series. See usage() for the commands and options, which
+// follow the arguments of the R functions of the same name.
+
+#include <armadillo>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gmwm.h"
+#include "json_writer.h"
+
+static void usage(std::ostream& out){
+  out <<
+    "usage: gmwm <command> [options] <file>...\n"
+    "\n"
+    "commands:\n"
+    "  wvar     Haar MODWT wavelet variance\n"
+    "  avar     Allan variance\n"
+    "  hadam    Hadamard variance\n"
+    "  fit      GMWM estimates of --model\n"
+    "  select   Model selection over the sub-models of --model\n"
+    "\n"
+    "input:\n"
+    "  --format f64|text|imu  Raw little-endian doubles, whitespace separated text or a binary IMU file\n"
+    "                         (default: imu with --imu-type, f64 otherwise)\n"
+    "  --imu-type TYPE        IMU type of read.imu() (IMAR, LN200, LN200IG, IXSEA, NAVCHIP_FLT, NAVCHIP_INT)\n"
+    "  --decimate N           Average every N epochs of an IMU file\n"
+    "  --columns 1,2,...      IMU channels to process, 1 to 6 (default: all)\n"
+    "\n"
+    "wvar:\n"
+    "  --nlevels N --robust --eff E --alpha A\n"
+    "avar, hadam:\n"
+    "  --type mo|to           Maximal or tau overlap (default: mo)\n"
+    "fit, select:\n"
+    "  --model AR1,WN,RW      Processes of the model (select: of the full model)\n"
+    "  --model-type imu|ssm --compute-v fast|diag|full|bootstrap --robust --eff E --alpha A\n"
+    "  --G N --K N --H N --seed N\n"
+    "select:\n"
+    "  --search exhaustive|backward|forward|bnb --no-warm-start --bootstrap\n"
+    "\n"
+    "  --profile              Add the time, counts and memory peaks of each stage of the estimation\n"
+    "                         (wvar, fit, select)\n"
+    "  --memory-budget B      Refuse the jobs whose data would take the memory held beyond B bytes\n"
+    "                         (suffixes K, M and G allowed, e.g. 4G)\n"
+    "  --trace FILE           Write a timeline of the hot functions on each thread (Chrome trace JSON)\n"
+    "  --threads N            Worker threads (default: all cores)\n"
+    "  --output FILE          Write the results to FILE instead of the standard output\n";
+}
+
+/* ------------------------- Options ------------------------- */
+
+struct cli_options{
+  cli_options() : format(""), decimate(1), overlap(true), search("exhaustive"), warm_start(true),
+                  bootstrap(false), profile(false), memory_budget(0), threads(0) {}
+
+  std::string command;
+  std::vector<std::string> files;
+
+  std::string format;
+  std::string imu_type;
+  unsigned int decimate;
+  std::vector<unsigned int> columns;
+
+  gmwm::wv_options wv;
+  bool overlap;
+
+  std::vector<std::string> model;
+  gmwm::fit_options fit;
+  std::string search;
+  bool warm_start;
+  bool bootstrap;
+
+  bool profile;
+  double memory_budget;
+  std::string trace;
+  unsigned int threads;
+  std::string output;
+};
+
+static std::vector<std::string> split(const std::string& s, char sep){
+  std::vector<std::string> out;
+  std::stringstream ss(s);
+  std::string item;
+  while(std::getline(ss, item, sep)){
+    if(!item.empty()){
+      out.push_back(item);
+    }
+  }
+  return out;
+}
+
+static unsigned int to_uint(const std::string& s){
+  char* end;
+  unsigned long v = std::strtoul(s.c_str(), &end, 10);
+  if(*end != '\0' || s.empty()){
+    throw std::invalid_argument("Expected a positive integer, got " + s + ".");
+  }
+  return (unsigned int)v;
+}
+
+static double to_double(const std::string& s){
+  char* end;
+  double v = std::strtod(s.c_str(), &end);
+  if(*end != '\0' || s.empty()){
+    throw std::invalid_argument("Expected a number, got " + s + ".");
+  }
+  return v;
+}
+
+// Bytes, with an optional K, M or G suffix
+static double to_bytes(const std::string& s){
+  double unit = 1;
+  std::string digits = s;
+  if(!s.empty()){
+    switch(s[s.size() - 1]){
+      case 'K': unit = 1024.0; break;
+      case 'M': unit = 1024.0*1024.0; break;
+      case 'G': unit = 1024.0*1024.0*1024.0; break;
+    }
+    if(unit > 1){
+      digits = s.substr(0, s.size() - 1);
+    }
+  }
+  double v = to_double(digits);
+  if(v < 0){
+    throw std::invalid_argument("Expected a number of bytes, got " + s + ".");
+  }
+  return v*unit;
+}
+
+static cli_options parse_options(int argc, char** argv){
+  cli_options opt;
+
+  if(argc < 2){
+    throw std::invalid_argument("No command given.");
+  }
+  opt.command = argv[1];
+  if(opt.command != "wvar" && opt.command != "avar" && opt.command != "hadam" &&
+     opt.command != "fit" && opt.command != "select"){
+    throw std::invalid_argument("Unknown command " + opt.command + ".");
+  }
+
+  for(int i = 2; i < argc; i++){
+    std::string a = argv[i];
+
+    if(a.compare(0, 2, "--") != 0){
+      opt.files.push_back(a);
+      continue;
+    }
+
+    // Flags without a value
+    if(a == "--robust"){
+      opt.wv.robust = opt.fit.robust = true;
+      continue;
+    }else if(a == "--no-warm-start"){
+      opt.warm_start = false;
+      continue;
+    }else if(a == "--bootstrap"){
+      opt.bootstrap = true;
+      continue;
+    }else if(a == "--profile"){
+      opt.profile = true;
+      continue;
+    }
+
+    if(i + 1 >= argc){
+      throw std::invalid_argument("Missing value of " + a + ".");
+    }
+    std::string v = argv[++i];
+
+    if(a == "--format") opt.format = v;
+    else if(a == "--imu-type") opt.imu_type = v;
+    else if(a == "--decimate") opt.decimate = to_uint(v);
+    else if(a == "--columns"){
+      std::vector<std::string> cols = split(v, ',');
+      for(unsigned int j = 0; j < cols.size(); j++){
+        unsigned int c = to_uint(cols[j]);
+        if(c < 1 || c > 6){
+          throw std::invalid_argument("IMU channels are numbered 1 to 6.");
+        }
+        opt.columns.push_back(c);
+      }
+    }
+    else if(a == "--nlevels") opt.wv.nlevels = to_uint(v);
+    else if(a == "--eff") opt.wv.eff = opt.fit.eff = to_double(v);
+    else if(a == "--alpha") opt.wv.alpha = opt.fit.alpha = to_double(v);
+    else if(a == "--type"){
+      if(v != "mo" && v != "to"){
+        throw std::invalid_argument("--type must be mo or to.");
+      }
+      opt.overlap = (v == "mo");
+    }
+    else if(a == "--model") opt.model = split(v, ',');
+    else if(a == "--model-type") opt.fit.model_type = v;
+    else if(a == "--compute-v") opt.fit.compute_v = v;
+    else if(a == "--G") opt.fit.G = to_uint(v);
+    else if(a == "--K") opt.fit.K = to_uint(v);
+    else if(a == "--H") opt.fit.H = to_uint(v);
+    else if(a == "--seed") opt.fit.seed = to_uint(v);
+    else if(a == "--search") opt.search = v;
+    else if(a == "--memory-budget") opt.memory_budget = to_bytes(v);
+    else if(a == "--trace") opt.trace = v;
+    else if(a == "--threads") opt.threads = to_uint(v);
+    else if(a == "--output") opt.output = v;
+    else throw std::invalid_argument("Unknown option " + a + ".");
+  }
+
+  if(opt.files.empty()){
+    throw std::invalid_argument("No input file given.");
+  }
+  if(opt.format.empty()){
+    opt.format = opt.imu_type.empty() ? "f64" : "imu";
+  }
+  if(opt.format != "f64" && opt.format != "text" && opt.format != "imu"){
+    throw std::invalid_argument("--format must be f64, text or imu.");
+  }
+  if(opt.format == "imu" && opt.imu_type.empty()){
+    throw std::invalid_argument("An IMU file requires --imu-type.");
+  }
+  if((opt.command == "fit" || opt.command == "select") && opt.model.empty()){
+    throw std::invalid_argument("The " + opt.command + " command requires --model.");
+  }
+  if(opt.columns.empty()){
+    for(unsigned int c = 1; c <= 6; c++){
+      opt.columns.push_back(c);
+    }
+  }
+
+  return opt;
+}
+
+/* ------------------------- Input ------------------------- */
+
+// A series to process
+struct cli_job{
+  std::string file;
+  unsigned int column;    // IMU channel, 0 for a file holding a single series
+  double freq;
+  arma::vec x;
+  std::string result;     // JSON of the result
+  bool failed;
+};
+
+static arma::vec read_f64(const std::string& file){
+  std::ifstream in(file.c_str(), std::ios::binary | std::ios::ate);
+  if(!in){
+    throw std::runtime_error("Cannot open " + file + ".");
+  }
+  std::streamsize bytes = in.tellg();
+  if(bytes % sizeof(double) != 0){
+    throw std::runtime_error(file + " does not hold a whole number of doubles.");
+  }
+  in.seekg(0);
+  arma::vec x(bytes/sizeof(double));
+  in.read((char*)x.memptr(), bytes);
+  return x;
+}
+
+static arma::vec read_text(const std::string& file){
+  std::ifstream in(file.c_str());
+  if(!in){
+    throw std::runtime_error("Cannot open " + file + ".");
+  }
+  std::vector<double> v;
+  double d;
+  while(in >> d){
+    v.push_back(d);
+  }
+  if(!in.eof()){
+    throw std::runtime_error(file + " contains a value that is not a number.");
+  }
+  return arma::vec(v);
+}
+
+static std::vector<cli_job> read_jobs(const cli_options& opt){
+  std::vector<cli_job> jobs;
+
+  for(unsigned int f = 0; f < opt.files.size(); f++){
+    cli_job job;
+    job.file = opt.files[f];
+    job.column = 0;
+    job.freq = 1.0;
+    job.failed = false;
+
+    if(opt.format == "imu"){
+      gmwm::imu_data imu = gmwm::read_imu(job.file, opt.imu_type, opt.decimate);
+      job.freq = imu.freq;
+      for(unsigned int c = 0; c < opt.columns.size(); c++){
+        job.column = opt.columns[c];
+        job.x = imu.data.col(job.column);
+        jobs.push_back(job);
+      }
+    }else{
+      job.x = opt.format == "f64" ? read_f64(job.file) : read_text(job.file);
+      jobs.push_back(job);
+    }
+  }
+
+  return jobs;
+}
+
+/* ------------------------- Commands ------------------------- */
+
+static void write_fit(json_writer& json, const gmwm::fit_result& fit){
+  json.begin_object();
+  json.field("model", fit.model);
+  json.field("theta", fit.theta);
+  json.field("starting", fit.starting);
+  json.field("objective", fit.objective);
+  json.field("wv_empir", fit.wv_empir);
+  json.field("wv_theo", fit.wv_theo);
+  json.field("ci_low", fit.ci_low);
+  json.field("ci_high", fit.ci_high);
+  json.end_object();
+}
+
+static void write_profile(json_writer& json, const gmwm_profile& profile){
+  json.begin_object();
+  for(unsigned int i = 0; i < PROFILE_STAGES; i++){
+    json.key(profile_stage_name(profile_stage(i)));
+    json.begin_object();
+    json.field("seconds", profile.seconds[i]);
+    json.field("calls", (unsigned int)profile.calls[i]);
+    json.field("peak_bytes", profile.stage_peak_bytes[i]);
+    json.end_object();
+  }
+  for(unsigned int i = 0; i < PROFILE_COUNTERS; i++){
+    json.field(profile_counter_name(profile_counter(i)), (unsigned int)profile.counts[i]);
+  }
+  json.field("convergence", (unsigned int)profile.convergence);
+  json.key("peak_bytes");
+  json.begin_object();
+  for(unsigned int i = 0; i < MEMORY_STRUCTURES; i++){
+    json.field(memory_structure_name(memory_structure(i)), profile.peak_bytes[i]);
+  }
+  json.field("total", profile.peak_total_bytes);
+  json.end_object();
+  json.end_object();
+}
+
+static void write_cluster(json_writer& json, const gmwm::cluster_variance& cv){
+  json.field("tau", cv.tau);
+  json.field("variance", cv.variance);
+  json.field("error", cv.error);
+}
+
+static void run_job(const cli_options& opt, cli_job& job){
+  std::ostringstream out;
+  json_writer json(out);
+
+  json.begin_object();
+  json.field("file", job.file);
+  if(job.column > 0){
+    json.field("column", job.column);
+    json.field("freq", job.freq);
+  }
+  json.field("n", (unsigned int)job.x.n_elem);
+
+  try{
+    if(opt.command == "wvar"){
+      gmwm::wv_result wv = gmwm::wvar(job.x, opt.wv);
+      json.field("scales", wv.scales);
+      json.field("variance", wv.variance);
+      json.field("ci_low", wv.ci_low);
+      json.field("ci_high", wv.ci_high);
+      if(opt.profile){
+        json.key("profile");
+        write_profile(json, wv.profile);
+      }
+    }else if(opt.command == "avar"){
+      write_cluster(json, gmwm::avar(job.x, opt.overlap));
+    }else if(opt.command == "hadam"){
+      write_cluster(json, gmwm::hadamard(job.x, opt.overlap));
+    }else if(opt.command == "fit"){
+      gmwm::fit_result fit = gmwm::fit(job.x, opt.model, opt.fit);
+      json.key("fit");
+      write_fit(json, fit);
+      if(opt.profile){
+        json.key("profile");
+        write_profile(json, fit.profile);
+      }
+    }else{
+      gmwm::selection_result sel = gmwm::select_model(job.x, opt.model, std::vector< std::vector<std::string> >(),
+                                                      opt.fit, opt.search, opt.warm_start, opt.bootstrap);
+      json.key("ranking");
+      json.begin_array();
+      for(unsigned int i = 0; i < sel.models.size(); i++){
+        json.begin_object();
+        json.field("model", sel.models[i]);
+        json.field("objective", sel.scores(i, 0));
+        json.field("optimism", sel.scores(i, 1));
+        json.field("criterion", sel.scores(i, 2));
+        json.field("gof_p_value", sel.scores(i, 3));
+        json.end_object();
+      }
+      json.end_array();
+      json.key("best");
+      write_fit(json, sel.best);
+      if(opt.profile){
+        json.key("profile");
+        write_profile(json, sel.profile);
+      }
+    }
+  }catch(std::exception& e){
+    json.field("error", e.what());
+    job.failed = true;
+  }
+
+  json.end_object();
+  job.result = out.str();
+}
+
+// Runs the jobs on a pool of threads, each taking the next job left
+static void run_jobs(const cli_options& opt, std::vector<cli_job>& jobs){
+  unsigned int n_threads = opt.threads ? opt.threads : std::thread::hardware_concurrency();
+  n_threads = std::max(1u, std::min(n_threads, (unsigned int)jobs.size()));
+
+  std::atomic<unsigned int> next(0);
+
+  std::vector<std::thread> pool;
+  for(unsigned int t = 0; t < n_threads; t++){
+    pool.push_back(std::thread([&](){
+      for(unsigned int i = next++; i < jobs.size(); i = next++){
+        run_job(opt, jobs[i]);
+      }
+    }));
+  }
+  for(unsigned int t = 0; t < pool.size(); t++){
+    pool[t].join();
+  }
+}
+
+int main(int argc, char** argv){
+  if(argc >= 2 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h")){
+    usage(std::cout);
+    return 0;
+  }
+
+  try{
+    cli_options opt = parse_options(argc, argv);
+
+    memory_set_budget(opt.memory_budget);
+
+    if(!opt.trace.empty()){
+      trace_start();
+    }
+
+    std::vector<cli_job> jobs = read_jobs(opt);
+    run_jobs(opt, jobs);
+
+    if(!opt.trace.empty()){
+      trace_stop();
+      trace_write(opt.trace);
+    }
+
+    std::ofstream file;
+    if(!opt.output.empty()){
+      file.open(opt.output.c_str());
+      if(!file){
+        throw std::runtime_error("Cannot write " + opt.output + ".");
+      }
+    }
+    std::ostream& out = opt.output.empty() ? std::cout : file;
+
+    json_writer json(out);
+    json.begin_object();
+    json.field("command", opt.command);
+    json.key("results");
+    json.begin_array();
+    for(unsigned int i = 0; i < jobs.size(); i++){
+      json.raw(jobs[i].result);
+    }
+    json.end_array();
+    json.end_object();
+    out << std::endl;
+
+    // Results of the other jobs are still written when one fails
+    for(unsigned int i = 0; i < jobs.size(); i++){
+      if(jobs[i].failed){
+        return 1;
+      }
+    }
+    return 0;
+  }catch(std::invalid_argument& e){
+    std::cerr << "gmwm: " << e.what() << std::endl << std::endl;
+    usage(std::cerr);
+    return 2;
+  }catch(std::exception& e){
+    std::cerr << "gmwm: " << e.what() << std::endl;
+    return 2;
+  }
+}
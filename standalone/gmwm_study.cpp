@@ -0,0 +1,478 @@
+// Monte Carlo study of the accuracy and cost of GMWM fits under the settings of the estimator.
+//
+//   gmwm_study --model AR1,WN --theta 0.9,1,0.5 [--model ... --theta ...] [grid options]
+//
+// For every true model and sample size, replicates are simulated with gen_model. Each one is fitted under
+// every combination of G, H, K and compute_v, and optionally ranked by model selection. The replicates run
+// on all cores and every setting sees the same simulated series, so settings are compared on common random
+// numbers. Per setting the study reports the bias and RMSE of each parameter, how often the selection
+// picks the true model and how stable its choice is, and the wall clock and processor seconds per fit.
+// Settings on the Pareto front of processor time against relative RMSE are marked.
+
+#include <RcppArmadillo.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+#include "gmwm.h"
+#include "json_writer.h"
+
+#include "ts_model_cpp.h"
+
+static void usage(std::ostream& out){
+  out <<
+    "usage: gmwm_study --model A,B,... --theta x,y,... [options]\n"
+    "\n"
+    "true models:\n"
+    "  --model AR1,WN,RW      Processes of a true model, each followed by --theta (repeatable)\n"
+    "  --theta 0.9,1,...      Its parameters, in the order of model()\n"
+    "\n"
+    "grid (comma separated values, every combination is a setting):\n"
+    "  --n 1000,10000         Sample sizes (default: 10000)\n"
+    "  --G 1000,20000         Starting value draws (default: the default of gmwm())\n"
+    "  --H 100                Bootstrap replicates (default: 100)\n"
+    "  --K 1                  Updates of V (default: 1)\n"
+    "  --compute-v fast       fast, diag, full or bootstrap (default: fast)\n"
+    "\n"
+    "  --reps N               Replicates per true model and sample size (default: 100)\n"
+    "  --select A,B,...       Also rank the sub-models of this full model on each replicate\n"
+    "  --model-type imu|ssm --robust --eff E --alpha A\n"
+    "  --seed N               Seed of the first replicate (default: 1337)\n"
+    "  --threads N            Worker threads (default: all cores)\n"
+    "  --output FILE          Write the results to FILE instead of the standard output\n";
+}
+
+/* ------------------------- Options ------------------------- */
+
+struct study_model{
+  std::vector<std::string> desc;
+  arma::vec theta;
+};
+
+struct study_options{
+  study_options() : n(1, 10000), G(1, 0), H(1, 100), K(1, 1), compute_v(1, "fast"), reps(100), seed(1337),
+                    threads(0) {}
+
+  std::vector<study_model> models;
+  std::vector<unsigned int> n;
+  std::vector<unsigned int> G;
+  std::vector<unsigned int> H;
+  std::vector<unsigned int> K;
+  std::vector<std::string> compute_v;
+
+  unsigned int reps;
+  std::vector<std::string> select;
+  gmwm::fit_options fit;      // Model type, robustness and alpha, shared by all settings
+  unsigned int seed;
+  unsigned int threads;
+  std::string output;
+};
+
+static std::vector<std::string> split(const std::string& s, char sep){
+  std::vector<std::string> out;
+  std::stringstream ss(s);
+  std::string item;
+  while(std::getline(ss, item, sep)){
+    if(!item.empty()){
+      out.push_back(item);
+    }
+  }
+  return out;
+}
+
+static unsigned int to_uint(const std::string& s){
+  char* end;
+  unsigned long v = std::strtoul(s.c_str(), &end, 10);
+  if(*end != '\0' || s.empty()){
+    throw std::invalid_argument("Expected a positive integer, got " + s + ".");
+  }
+  return (unsigned int)v;
+}
+
+static double to_double(const std::string& s){
+  char* end;
+  double v = std::strtod(s.c_str(), &end);
+  if(*end != '\0' || s.empty()){
+    throw std::invalid_argument("Expected a number, got " + s + ".");
+  }
+  return v;
+}
+
+static std::vector<unsigned int> to_uints(const std::string& s){
+  std::vector<std::string> items = split(s, ',');
+  std::vector<unsigned int> out;
+  for(unsigned int i = 0; i < items.size(); i++){
+    out.push_back(to_uint(items[i]));
+  }
+  if(out.empty()){
+    throw std::invalid_argument("Expected a list of integers, got " + s + ".");
+  }
+  return out;
+}
+
+static study_options parse_options(int argc, char** argv){
+  study_options opt;
+
+  for(int i = 1; i < argc; i++){
+    std::string a = argv[i];
+
+    if(a == "--robust"){
+      opt.fit.robust = true;
+      continue;
+    }
+
+    if(i + 1 >= argc){
+      throw std::invalid_argument("Missing value of " + a + ".");
+    }
+    std::string v = argv[++i];
+
+    if(a == "--model"){
+      study_model m;
+      m.desc = split(v, ',');
+      opt.models.push_back(m);
+    }
+    else if(a == "--theta"){
+      if(opt.models.empty() || opt.models.back().theta.n_elem > 0){
+        throw std::invalid_argument("Each --theta must follow its --model.");
+      }
+      std::vector<std::string> items = split(v, ',');
+      arma::vec theta(items.size());
+      for(unsigned int j = 0; j < items.size(); j++){
+        theta(j) = to_double(items[j]);
+      }
+      opt.models.back().theta = theta;
+    }
+    else if(a == "--n") opt.n = to_uints(v);
+    else if(a == "--G") opt.G = to_uints(v);
+    else if(a == "--H") opt.H = to_uints(v);
+    else if(a == "--K") opt.K = to_uints(v);
+    else if(a == "--compute-v") opt.compute_v = split(v, ',');
+    else if(a == "--reps") opt.reps = to_uint(v);
+    else if(a == "--select") opt.select = split(v, ',');
+    else if(a == "--model-type") opt.fit.model_type = v;
+    else if(a == "--eff") opt.fit.eff = to_double(v);
+    else if(a == "--alpha") opt.fit.alpha = to_double(v);
+    else if(a == "--seed") opt.seed = to_uint(v);
+    else if(a == "--threads") opt.threads = to_uint(v);
+    else if(a == "--output") opt.output = v;
+    else throw std::invalid_argument("Unknown option " + a + ".");
+  }
+
+  if(opt.models.empty()){
+    throw std::invalid_argument("No true model given.");
+  }
+  for(unsigned int i = 0; i < opt.models.size(); i++){
+    const study_model& m = opt.models[i];
+    if(m.theta.n_elem != model_theta(m.desc).n_elem){
+      throw std::invalid_argument("The --theta of each --model must hold one value per parameter.");
+    }
+  }
+  if(opt.reps == 0){
+    throw std::invalid_argument("--reps must be positive.");
+  }
+
+  return opt;
+}
+
+/* ------------------------- Replicates ------------------------- */
+
+// Settings of the estimator compared by the study
+struct study_setting{
+  unsigned int G;
+  unsigned int H;
+  unsigned int K;
+  std::string compute_v;
+};
+
+// Outcome of one replicate under one setting
+struct study_fit{
+  study_fit() : failed(false), wall(0.0), cpu(0.0) {}
+
+  bool failed;
+  arma::vec theta;
+  std::string selected;   // Best model of the selection, processes joined by +
+  double wall;            // Seconds spent fitting and selecting
+  double cpu;
+};
+
+typedef std::chrono::steady_clock study_clock;
+
+// Processor time of the calling thread, or the wall clock where it is not available
+static double thread_cpu_seconds(){
+#ifdef CLOCK_THREAD_CPUTIME_ID
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + 1e-9*ts.tv_nsec;
+#else
+  return std::chrono::duration<double>(study_clock::now().time_since_epoch()).count();
+#endif
+}
+
+static std::string join(const std::vector<std::string>& v){
+  std::string out;
+  for(unsigned int i = 0; i < v.size(); i++){
+    out += (i ? "+" : "") + v[i];
+  }
+  return out;
+}
+
+// Same processes, whatever their order
+static std::string canonical(std::vector<std::string> v){
+  std::sort(v.begin(), v.end());
+  return join(v);
+}
+
+// Fits replicate r of a true model under every setting. The series is simulated once from seed + r.
+static void run_replicate(const study_options& opt, const study_model& truth, unsigned int N, unsigned int r,
+                          const std::vector<study_setting>& settings, std::vector< std::vector<study_fit> >& out){
+  current_context().rng->seed(opt.seed + r);
+  arma::vec x = gmwm::simulate(N, truth.theta, truth.desc);
+
+  for(unsigned int s = 0; s < settings.size(); s++){
+    gmwm::fit_options fo = opt.fit;
+    fo.G = settings[s].G;
+    fo.H = settings[s].H;
+    fo.K = settings[s].K;
+    fo.compute_v = settings[s].compute_v;
+    fo.seed = opt.seed + r;
+
+    study_fit& res = out[s][r];
+    study_clock::time_point start = study_clock::now();
+    double cpu_start = thread_cpu_seconds();
+
+    try{
+      res.theta = gmwm::fit(x, truth.desc, fo).theta;
+      if(!opt.select.empty()){
+        gmwm::selection_result sel = gmwm::select_model(x, opt.select, std::vector< std::vector<std::string> >(), fo);
+        res.selected = canonical(sel.models.front());
+      }
+    }catch(std::exception&){
+      res.failed = true;
+    }
+
+    res.wall = std::chrono::duration<double>(study_clock::now() - start).count();
+    res.cpu = thread_cpu_seconds() - cpu_start;
+  }
+}
+
+/* ------------------------- Summaries ------------------------- */
+
+struct study_summary{
+  study_setting setting;
+  unsigned int fitted;
+  unsigned int failed;
+  arma::vec bias;
+  arma::vec rmse;
+  double rel_rmse;                            // Mean over the parameters of RMSE / |true value|
+  std::map<std::string, unsigned int> picks;  // Times each model was selected
+  double true_rate;                           // Share of the fits selecting the true model
+  double modal_rate;                          // Share of the fits selecting the most frequent model
+  double wall;                                // Mean seconds per replicate
+  double cpu;
+  bool pareto;
+};
+
+static study_summary summarise(const study_setting& setting, const study_model& truth,
+                               const std::vector<study_fit>& fits){
+  study_summary sum;
+  sum.setting = setting;
+  sum.fitted = 0;
+  sum.failed = 0;
+  sum.bias = arma::zeros<arma::vec>(truth.theta.n_elem);
+  sum.rmse = arma::zeros<arma::vec>(truth.theta.n_elem);
+  sum.wall = 0.0;
+  sum.cpu = 0.0;
+  sum.pareto = false;
+
+  std::string true_model = canonical(truth.desc);
+  unsigned int true_picks = 0;
+
+  for(unsigned int r = 0; r < fits.size(); r++){
+    sum.wall += fits[r].wall;
+    sum.cpu += fits[r].cpu;
+    if(fits[r].failed){
+      sum.failed++;
+      continue;
+    }
+    sum.fitted++;
+    arma::vec err = fits[r].theta - truth.theta;
+    sum.bias += err;
+    sum.rmse += arma::square(err);
+    if(!fits[r].selected.empty()){
+      sum.picks[fits[r].selected]++;
+      true_picks += (fits[r].selected == true_model);
+    }
+  }
+
+  sum.wall /= fits.size();
+  sum.cpu /= fits.size();
+
+  double k = std::max(1u, sum.fitted);
+  sum.bias /= k;
+  sum.rmse = arma::sqrt(sum.rmse/k);
+  sum.rel_rmse = sum.fitted ? arma::mean(sum.rmse/arma::abs(truth.theta)) : arma::datum::nan;
+
+  unsigned int modal = 0;
+  for(std::map<std::string, unsigned int>::const_iterator it = sum.picks.begin(); it != sum.picks.end(); ++it){
+    modal = std::max(modal, it->second);
+  }
+  sum.true_rate = sum.picks.empty() ? arma::datum::nan : double(true_picks)/k;
+  sum.modal_rate = sum.picks.empty() ? arma::datum::nan : double(modal)/k;
+
+  return sum;
+}
+
+// Marks the settings that no other setting beats on both processor time and relative RMSE
+static void mark_pareto(std::vector<study_summary>& sums){
+  for(unsigned int i = 0; i < sums.size(); i++){
+    if(!std::isfinite(sums[i].rel_rmse)){
+      continue;
+    }
+    bool dominated = false;
+    for(unsigned int j = 0; j < sums.size() && !dominated; j++){
+      dominated = j != i && std::isfinite(sums[j].rel_rmse) &&
+        sums[j].cpu <= sums[i].cpu && sums[j].rel_rmse <= sums[i].rel_rmse &&
+        (sums[j].cpu < sums[i].cpu || sums[j].rel_rmse < sums[i].rel_rmse);
+    }
+    sums[i].pareto = !dominated;
+  }
+}
+
+static void write_summary(json_writer& json, const study_summary& sum){
+  json.begin_object();
+  json.field("G", sum.setting.G);
+  json.field("H", sum.setting.H);
+  json.field("K", sum.setting.K);
+  json.field("compute_v", sum.setting.compute_v);
+  json.field("fitted", sum.fitted);
+  json.field("failed", sum.failed);
+  json.field("bias", sum.bias);
+  json.field("rmse", sum.rmse);
+  json.field("relative_rmse", sum.rel_rmse);
+  if(!sum.picks.empty()){
+    json.key("selection");
+    json.begin_object();
+    json.field("true_model_rate", sum.true_rate);
+    json.field("modal_model_rate", sum.modal_rate);
+    json.key("picks");
+    json.begin_object();
+    for(std::map<std::string, unsigned int>::const_iterator it = sum.picks.begin(); it != sum.picks.end(); ++it){
+      json.field(it->first, it->second);
+    }
+    json.end_object();
+    json.end_object();
+  }
+  json.field("wall_s_per_rep", sum.wall);
+  json.field("cpu_s_per_rep", sum.cpu);
+  json.field("pareto", sum.pareto);
+  json.end_object();
+}
+
+/* ------------------------- Main ------------------------- */
+
+int main(int argc, char** argv){
+  if(argc >= 2 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h")){
+    usage(std::cout);
+    return 0;
+  }
+
+  try{
+    study_options opt = parse_options(argc, argv);
+
+    std::vector<study_setting> settings;
+    for(unsigned int g = 0; g < opt.G.size(); g++)
+      for(unsigned int h = 0; h < opt.H.size(); h++)
+        for(unsigned int k = 0; k < opt.K.size(); k++)
+          for(unsigned int v = 0; v < opt.compute_v.size(); v++){
+            study_setting s = {opt.G[g], opt.H[h], opt.K[k], opt.compute_v[v]};
+            settings.push_back(s);
+          }
+
+    std::ofstream file;
+    if(!opt.output.empty()){
+      file.open(opt.output.c_str());
+      if(!file){
+        throw std::runtime_error("Cannot write " + opt.output + ".");
+      }
+    }
+    std::ostream& out = opt.output.empty() ? std::cout : file;
+
+    unsigned int n_threads = opt.threads ? opt.threads : std::thread::hardware_concurrency();
+    n_threads = std::max(1u, std::min(n_threads, opt.reps));
+
+    json_writer json(out);
+    json.begin_object();
+    json.field("replicates", opt.reps);
+    json.field("seed", opt.seed);
+    json.field("threads", n_threads);
+    json.key("studies");
+    json.begin_array();
+
+    for(unsigned int m = 0; m < opt.models.size(); m++){
+      const study_model& truth = opt.models[m];
+
+      for(unsigned int i = 0; i < opt.n.size(); i++){
+        unsigned int N = opt.n[i];
+        std::cerr << "gmwm_study: " << join(truth.desc) << ", n = " << N << ", "
+                  << opt.reps << " replicates of " << settings.size() << " setting(s)" << std::endl;
+
+        // Replicates on a pool of threads, each with its own context
+        std::vector< std::vector<study_fit> > fits(settings.size(), std::vector<study_fit>(opt.reps));
+        std::atomic<unsigned int> next(0);
+        std::vector<std::thread> pool;
+        for(unsigned int t = 0; t < n_threads; t++){
+          pool.push_back(std::thread([&](){
+            for(unsigned int r = next++; r < opt.reps; r = next++){
+              run_replicate(opt, truth, N, r, settings, fits);
+            }
+          }));
+        }
+        for(unsigned int t = 0; t < pool.size(); t++){
+          pool[t].join();
+        }
+
+        std::vector<study_summary> sums;
+        for(unsigned int s = 0; s < settings.size(); s++){
+          sums.push_back(summarise(settings[s], truth, fits[s]));
+        }
+        mark_pareto(sums);
+
+        json.begin_object();
+        json.field("model", truth.desc);
+        json.field("theta", truth.theta);
+        json.field("n", N);
+        json.key("settings");
+        json.begin_array();
+        for(unsigned int s = 0; s < sums.size(); s++){
+          write_summary(json, sums[s]);
+        }
+        json.end_array();
+        json.end_object();
+      }
+    }
+
+    json.end_array();
+    json.end_object();
+    out << std::endl;
+    return 0;
+  }catch(std::invalid_argument& e){
+    std::cerr << "gmwm_study: " << e.what() << std::endl << std::endl;
+    usage(std::cerr);
+    return 2;
+  }catch(std::exception& e){
+    std::cerr << "gmwm_study: " << e.what() << std::endl;
+    return 2;
+  }
+}
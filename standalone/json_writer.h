@@ -0,0 +1,156 @@
+#ifndef GMWM_JSON_WRITER
+#define GMWM_JSON_WRITER
+
+#include <armadillo>
+#include <cmath>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Streams JSON, placing the separators itself. Non finite numbers are written as null.
+class json_writer{
+public:
+  explicit json_writer(std::ostream& out) : out(out), after_key(false) {}
+
+  void begin_object(){ open('{'); }
+  void end_object(){ close('}'); }
+  void begin_array(){ open('['); }
+  void end_array(){ close(']'); }
+
+  void key(const std::string& k){
+    separate();
+    write_string(k);
+    out << ':';
+    after_key = true;
+  }
+
+  void value(double v){
+    separate();
+    write_number(v);
+  }
+
+  void value(unsigned int v){
+    separate();
+    out << v;
+  }
+
+  void value(bool v){
+    separate();
+    out << (v ? "true" : "false");
+  }
+
+  void value(const std::string& v){
+    separate();
+    write_string(v);
+  }
+
+  void value(const char* v){
+    value(std::string(v));
+  }
+
+  void value(const std::vector<std::string>& v){
+    begin_array();
+    for(unsigned int i = 0; i < v.size(); i++){
+      value(v[i]);
+    }
+    end_array();
+  }
+
+  void value(const arma::vec& v){
+    begin_array();
+    for(unsigned int i = 0; i < v.n_elem; i++){
+      value(v(i));
+    }
+    end_array();
+  }
+
+  // Row major, as an array of rows
+  void value(const arma::mat& m){
+    begin_array();
+    for(unsigned int i = 0; i < m.n_rows; i++){
+      begin_array();
+      for(unsigned int j = 0; j < m.n_cols; j++){
+        value(m(i, j));
+      }
+      end_array();
+    }
+    end_array();
+  }
+
+  // Already serialised JSON
+  void raw(const std::string& json){
+    separate();
+    out << json;
+  }
+
+  template <typename T>
+  void field(const std::string& k, const T& v){
+    key(k);
+    value(v);
+  }
+
+private:
+  std::ostream& out;
+  std::vector<bool> first;   // Whether the open container is still empty
+  bool after_key;
+
+  void separate(){
+    if(after_key){
+      after_key = false;
+      return;
+    }
+    if(!first.empty()){
+      if(!first.back()){
+        out << ',';
+      }
+      first.back() = false;
+    }
+  }
+
+  void open(char c){
+    separate();
+    out << c;
+    first.push_back(true);
+  }
+
+  void close(char c){
+    first.pop_back();
+    out << c;
+  }
+
+  void write_number(double v){
+    if(!std::isfinite(v)){
+      out << "null";
+      return;
+    }
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.17g", v);
+    out << buf;
+  }
+
+  void write_string(const std::string& s){
+    out << '"';
+    for(unsigned int i = 0; i < s.size(); i++){
+      char c = s[i];
+      switch(c){
+      case '"': out << "\\\""; break;
+      case '\\': out << "\\\\"; break;
+      case '\n': out << "\\n"; break;
+      case '\r': out << "\\r"; break;
+      case '\t': out << "\\t"; break;
+      default:
+        if((unsigned char)c < 0x20){
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned int)(unsigned char)c);
+          out << buf;
+        }else{
+          out << c;
+        }
+      }
+    }
+    out << '"';
+  }
+};
+
+#endif
@@ -0,0 +1,191 @@
+#include <RcppArmadillo.h>
+#include <cfloat>
+#include <limits>
+
+// The distribution functions of Rmath used by the core, for builds without R. The normal quantile is
+// Wichura's AS 241, as in R. The chi-squared functions use the regularised incomplete gamma function.
+
+namespace R{
+
+// Tail and log scale of a probability
+static double finish(double p, int lower_tail, int log_p){
+  if(!lower_tail){
+    p = 1.0 - p;
+  }
+  return log_p ? std::log(p) : p;
+}
+
+// Lower tail probability of a tail and log scale probability
+static double lower_prob(double p, int lower_tail, int log_p){
+  if(log_p){
+    p = std::exp(p);
+  }
+  return lower_tail ? p : 1.0 - p;
+}
+
+double dnorm(double x, double mu, double sigma, int give_log){
+  double z = (x - mu)/sigma;
+  double d = -0.5*z*z - std::log(sigma) - 0.918938533204672741780329736406; // log(sqrt(2*pi))
+  return give_log ? d : std::exp(d);
+}
+
+double pnorm(double x, double mu, double sigma, int lower_tail, int log_p){
+  double z = (x - mu)/sigma;
+
+  // Upper tail directly, to keep its precision
+  double p = lower_tail ? 0.5*std::erfc(-z*M_SQRT1_2) : 0.5*std::erfc(z*M_SQRT1_2);
+  return log_p ? std::log(p) : p;
+}
+
+double qnorm(double p, double mu, double sigma, int lower_tail, int log_p){
+  p = lower_prob(p, lower_tail, log_p);
+
+  if(p <= 0.0){
+    return -std::numeric_limits<double>::infinity();
+  }
+  if(p >= 1.0){
+    return std::numeric_limits<double>::infinity();
+  }
+
+  double q = p - 0.5;
+  double r, val;
+
+  if(std::fabs(q) <= 0.425){
+    r = 0.180625 - q*q;
+    val = q*(((((((r*2509.0809287301226727 +
+                   33430.575583588128105)*r + 67265.770927008700853)*r +
+                 45921.953931549871457)*r + 13731.693765509461125)*r +
+               1971.5909503065514427)*r + 133.14166789178437745)*r +
+             3.387132872796366608)
+          / (((((((r*5226.495278852545925 +
+                   28729.085735721942674)*r + 39307.89580009271061)*r +
+                 21213.794301586595867)*r + 5394.1960214247511077)*r +
+               687.1870074920579083)*r + 42.313330701600911252)*r + 1.0);
+    return mu + sigma*val;
+  }
+
+  r = std::sqrt(-std::log(q < 0 ? p : 1.0 - p));
+
+  if(r <= 5.0){
+    r -= 1.6;
+    val = (((((((r*7.7454501427834140764e-4 +
+                 0.0227238449892691845833)*r + 0.24178072517745061177)*r +
+               1.27045825245236838258)*r + 3.64784832476320460504)*r +
+             5.7694972214606914055)*r + 4.6303378461565452959)*r +
+           1.42343711074968357734)
+        / (((((((r*1.05075007164441684324e-9 + 5.475938084995344946e-4)*r +
+                 0.0151986665636164571966)*r + 0.14810397642748007459)*r +
+               0.68976733498510000455)*r + 1.6763848301838038494)*r +
+             2.05319162663775882187)*r + 1.0);
+  }else{
+    r -= 5.0;
+    val = (((((((r*2.01033439929228813265e-7 +
+                 2.71155556874348757815e-5)*r + 0.0012426609473880784386)*r +
+               0.026532189526576123093)*r + 0.29656057182850489123)*r +
+             1.7848265399172913358)*r + 5.4637849111641143699)*r +
+           6.6579046435011037772)
+        / (((((((r*2.04426310338993978564e-15 + 1.4215117583164458887e-7)*r +
+                 1.8463183175100546818e-5)*r + 7.868691311456132591e-4)*r +
+               0.0148753612908506148525)*r + 0.13692988092273580531)*r +
+             0.59983220655588793769)*r + 1.0);
+  }
+
+  if(q < 0.0){
+    val = -val;
+  }
+
+  return mu + sigma*val;
+}
+
+// Regularised lower incomplete gamma function P(a, x)
+static double gamma_p(double a, double x){
+  if(x <= 0.0){
+    return 0.0;
+  }
+
+  double lead = a*std::log(x) - x - std::lgamma(a);
+
+  if(x < a + 1.0){
+    // Series
+    double ap = a;
+    double del = 1.0/a;
+    double sum = del;
+    for(unsigned int n = 0; n < 1000; n++){
+      ap += 1.0;
+      del *= x/ap;
+      sum += del;
+      if(std::fabs(del) < std::fabs(sum)*DBL_EPSILON){
+        break;
+      }
+    }
+    return sum*std::exp(lead);
+  }
+
+  // Continued fraction of Q(a, x), by the modified Lentz method
+  double tiny = DBL_MIN/DBL_EPSILON;
+  double b = x + 1.0 - a;
+  double c = 1.0/tiny;
+  double d = 1.0/b;
+  double h = d;
+  for(unsigned int i = 1; i < 1000; i++){
+    double an = -(i*(i - a));
+    b += 2.0;
+    d = an*d + b;
+    if(std::fabs(d) < tiny) d = tiny;
+    c = b + an/c;
+    if(std::fabs(c) < tiny) c = tiny;
+    d = 1.0/d;
+    double del = d*c;
+    h *= del;
+    if(std::fabs(del - 1.0) < DBL_EPSILON){
+      break;
+    }
+  }
+  return 1.0 - std::exp(lead)*h;
+}
+
+double pchisq(double x, double df, int lower_tail, int log_p){
+  return finish(gamma_p(0.5*df, 0.5*x), lower_tail, log_p);
+}
+
+double qchisq(double p, double df, int lower_tail, int log_p){
+  p = lower_prob(p, lower_tail, log_p);
+
+  if(p <= 0.0){
+    return 0.0;
+  }
+  if(p >= 1.0){
+    return std::numeric_limits<double>::infinity();
+  }
+
+  // Wilson-Hilferty start, then Newton steps kept inside a bracket of the root
+  double z = qnorm(p, 0.0, 1.0, 1, 0);
+  double h = 2.0/(9.0*df);
+  double x = df*std::pow(std::max(1.0 - h + z*std::sqrt(h), 0.01), 3.0);
+
+  double lo = 0.0;
+  double hi = std::numeric_limits<double>::infinity();
+  double k = 0.5*df;
+  double lnorm = k*M_LN2 + std::lgamma(k);
+
+  for(unsigned int i = 0; i < 200; i++){
+    double f = gamma_p(k, 0.5*x) - p;
+    if(f < 0.0) lo = x; else hi = x;
+
+    double dens = std::exp((k - 1.0)*std::log(x) - 0.5*x - lnorm);
+    double next = x - f/dens;
+
+    if(!(next > lo && next < hi)){
+      next = std::isfinite(hi) ? 0.5*(lo + hi) : 2.0*x;
+    }
+
+    if(std::fabs(next - x) <= 4.0*DBL_EPSILON*x){
+      return next;
+    }
+    x = next;
+  }
+
+  return x;
+}
+
+}
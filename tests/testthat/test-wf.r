@@ -21,4 +21,25 @@ test_that("Haar filter is accurate", {
   expect_equal(haar_filter(), wf.haar, check.attributes = FALSE)
   
   expect_equal(select_filter(filter_name = "haar"), wf.haar, check.attributes = FALSE)
-})
\ No newline at end of file
+})
+
+test_that("Decompositions read their input in place without modifying it", {
+  set.seed(999)
+  x = rnorm(2^6)
+  x0 = x + 0
+  
+  # Reflection extends a copy of the signal
+  a = modwt_cpp(x, filter_name = "haar", nlevels = 3, boundary = "reflection", brickwall = FALSE)
+  b = modwt_cpp(c(x, rev(x)), filter_name = "haar", nlevels = 3, boundary = "periodic", brickwall = FALSE)
+  expect_equal(a, b)
+  
+  d = dwt_cpp(x, filter_name = "haar", nlevels = 3, boundary = "reflection", brickwall = TRUE)
+  expect_equal(length(d), 3)
+  
+  m = cbind(x, x^2)
+  m0 = m + 0
+  ACF(m)
+  
+  expect_identical(x, x0)
+  expect_identical(m, m0)
+})